@@ -0,0 +1,440 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// AllocBench.cc -- Multiprocessor allocator benchmarks for the uC++ heap: producer-consumer cross-task frees,
+//     larson-style churn, size-class sweep, and realloc growth, reporting throughput and resident storage at
+//     1..N processors.
+//
+// Author           : agent
+// Created On       : Mon Oct 19 01:06:42 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 01:06:42 2026
+// Update Count     : 1
+//
+
+#include <iostream>
+using std::cout;
+using std::cerr;
+using std::osacquire;
+using std::endl;
+#include <iomanip>
+using std::setw;
+using std::left;
+using std::right;
+#include <cstdio>					// sscanf
+#include <cstdlib>					// malloc, free, realloc, atoi
+#include <fcntl.h>					// open
+#include <unistd.h>					// read, close, sysconf
+#include <sys/time.h>
+#include <sys/resource.h>				// getrusage
+
+unsigned int uDefaultPreemption() {			// allow churning tasks to interleave on a processor
+    return 10;
+} // uDefaultPreemption
+
+
+//=======================================
+// measurement support
+//=======================================
+
+static double WallTime() {				// elapsed (not CPU) time, as tasks run on many processors
+    timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec + ts.tv_nsec / 1.0E9;
+} // WallTime
+
+static long int ResidentKB() {				// current resident set size
+    char buf[128];
+    int fd = open( "/proc/self/statm", O_RDONLY );
+    if ( fd == -1 ) return 0;
+    int len = read( fd, buf, sizeof(buf) - 1 );
+    close( fd );
+    if ( len <= 0 ) return 0;
+    buf[len] = '\0';
+    long int size, resident;
+    if ( sscanf( buf, "%ld %ld", &size, &resident ) != 2 ) return 0;
+    return resident * ( sysconf( _SC_PAGESIZE ) / 1024 );
+} // ResidentKB
+
+static long int MaxResidentKB() {			// process lifetime peak, from the kernel
+    rusage usage;
+    getrusage( RUSAGE_SELF, &usage );
+    return usage.ru_maxrss;
+} // MaxResidentKB
+
+static inline unsigned int Random( unsigned int &seed ) { // xorshift, one state per task to avoid sharing
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+} // Random
+
+static inline void *Alloc( size_t size ) {		// touch the storage so it is resident
+    char *p = (char *)malloc( size );
+    p[0] = p[size - 1] = 1;
+    return p;
+} // Alloc
+
+// ru_maxrss never decreases, so the peak for each test is found by sampling the resident size while the test
+// runs; the samples also give the RSS-over-time profile printed for the realloc test.
+
+_Task Sampler {
+    enum { MaxSamples = 4096 };
+    long int samples[MaxSamples];
+    unsigned int count;
+    long int &peak;
+
+    void sample() {
+	long int rss = ResidentKB();
+	if ( rss > peak ) peak = rss;
+	if ( count < MaxSamples ) {
+	    samples[count] = rss;
+	    count += 1;
+	} // if
+    } // Sampler::sample
+
+    void main() {
+	sample();
+	for ( ;; ) {
+	    _Accept( ~Sampler ) {
+		break;
+	    } or _Accept( profile ) {
+	    } or _Timeout( uDuration( 0, 10000000 ) ) {	// 10 ms
+		sample();
+	    } // _Accept
+	} // for
+	sample();
+    } // Sampler::main
+  public:
+    Sampler( long int &peak ) : count( 0 ), peak( peak ) { peak = 0; }
+
+    void profile() {
+	const unsigned int Points = 16;
+	unsigned int step = count < Points ? 1 : count / Points;
+	osacquire( cout ) << "    rss(KB) every " << step * 10 << "ms:";
+	for ( unsigned int i = 0; i < count; i += step ) {
+	    osacquire( cout ) << " " << samples[i];
+	} // for
+	osacquire( cout ) << endl;
+    } // Sampler::profile
+}; // Sampler
+
+static void Report( const char *test, unsigned int procs, double ops, double elapsed, long int peak ) {
+    osacquire( cout ) << left << setw( 18 ) << test << right
+		      << setw( 6 ) << procs
+		      << setw( 14 ) << (long int)( ops / elapsed )
+		      << setw( 14 ) << peak
+		      << setw( 14 ) << ResidentKB()	// all test storage freed, so this is steady-state retention
+		      << setw( 14 ) << MaxResidentKB()
+		      << endl;
+} // Report
+
+
+//=======================================
+// producer-consumer: every free is done by a task other than the allocator, usually on another processor
+//=======================================
+
+enum { BatchSize = 64 };
+
+struct Batch {
+    unsigned int count;					// 0 => producer finished
+    void *ptrs[BatchSize];
+}; // Batch
+
+_Monitor Buffer {					// batches amortize the synchronization over many allocations
+    enum { Size = 16 };
+    Batch elems[Size];
+    unsigned int front, back, count;
+    uCondition full, empty;
+  public:
+    Buffer() : front( 0 ), back( 0 ), count( 0 ) {}
+
+    void insert( Batch &batch ) {
+	if ( count == Size ) empty.wait();
+	elems[back] = batch;
+	back = ( back + 1 ) % Size;
+	count += 1;
+	full.signal();
+    } // Buffer::insert
+
+    void remove( Batch &batch ) {
+	if ( count == 0 ) full.wait();
+	batch = elems[front];
+	front = ( front + 1 ) % Size;
+	count -= 1;
+	empty.signal();
+    } // Buffer::remove
+}; // Buffer
+
+_Task Producer {
+    Buffer &buffer;
+    unsigned int N, seed;
+
+    void main() {
+	Batch batch;
+	for ( unsigned int i = 0; i < N; i += BatchSize ) {
+	    for ( batch.count = 0; batch.count < BatchSize; batch.count += 1 ) {
+		batch.ptrs[batch.count] = Alloc( 16 + Random( seed ) % 496 );
+	    } // for
+	    buffer.insert( batch );
+	} // for
+	batch.count = 0;
+	buffer.insert( batch );
+    } // Producer::main
+  public:
+    Producer( Buffer &buffer, unsigned int N, unsigned int seed ) : buffer( buffer ), N( N ), seed( seed ) {}
+}; // Producer
+
+_Task Consumer {
+    Buffer &buffer;
+
+    void main() {
+	Batch batch;
+	for ( ;; ) {
+	    buffer.remove( batch );
+	  if ( batch.count == 0 ) break;
+	    for ( unsigned int i = 0; i < batch.count; i += 1 ) {
+		free( batch.ptrs[i] );
+	    } // for
+	} // for
+    } // Consumer::main
+  public:
+    Consumer( Buffer &buffer ) : buffer( buffer ) {}
+}; // Consumer
+
+static void ProducerConsumer( unsigned int procs, unsigned int N ) {
+    long int peak;
+    Sampler *sampler = new Sampler( peak );
+    Buffer *buffers = new Buffer[procs];
+    Consumer **consumers = new Consumer *[procs];
+    Producer **producers = new Producer *[procs];
+    unsigned int per = N / procs / BatchSize * BatchSize;
+
+    double start = WallTime();
+    for ( unsigned int i = 0; i < procs; i += 1 ) {
+	consumers[i] = new Consumer( buffers[i] );
+	producers[i] = new Producer( buffers[i], per, i * 7919 + 1 );
+    } // for
+    for ( unsigned int i = 0; i < procs; i += 1 ) {
+	delete producers[i];
+	delete consumers[i];
+    } // for
+    double elapsed = WallTime() - start;
+
+    delete sampler;
+    delete [] producers;
+    delete [] consumers;
+    delete [] buffers;
+    Report( "producer-consumer", procs, 2.0 * per * procs, elapsed, peak );
+} // ProducerConsumer
+
+
+//=======================================
+// larson: random-size churn over a working set that is handed to a new task each round, so blocks are freed
+// by tasks (and processors) other than the ones that allocated them
+//=======================================
+
+enum { Slots = 1000, MinSize = 10, MaxSize = 500 };
+
+_Task Larson {
+    void **slots;
+    unsigned int N, seed;
+
+    void main() {
+	for ( unsigned int i = 0; i < N; i += 1 ) {
+	    unsigned int victim = Random( seed ) % Slots;
+	    free( slots[victim] );
+	    slots[victim] = Alloc( MinSize + Random( seed ) % ( MaxSize - MinSize ) );
+	} // for
+    } // Larson::main
+  public:
+    Larson( void **slots, unsigned int N, unsigned int seed ) : slots( slots ), N( N ), seed( seed ) {}
+}; // Larson
+
+static void LarsonChurn( unsigned int procs, unsigned int N ) {
+    const unsigned int Rounds = 8;
+    long int peak;
+    Sampler *sampler = new Sampler( peak );
+    void ***sets = new void **[procs];
+    Larson **tasks = new Larson *[procs];
+    unsigned int per = N / procs / Rounds, seed = 1;
+
+    for ( unsigned int i = 0; i < procs; i += 1 ) {
+	sets[i] = new void *[Slots];
+	for ( unsigned int s = 0; s < Slots; s += 1 ) {
+	    sets[i][s] = Alloc( MinSize + Random( seed ) % ( MaxSize - MinSize ) );
+	} // for
+    } // for
+
+    double start = WallTime();
+    for ( unsigned int r = 0; r < Rounds; r += 1 ) {
+	for ( unsigned int i = 0; i < procs; i += 1 ) {	// rotate working sets among the new tasks
+	    tasks[i] = new Larson( sets[( i + r ) % procs], per, r * procs + i + 1 );
+	} // for
+	for ( unsigned int i = 0; i < procs; i += 1 ) {
+	    delete tasks[i];
+	} // for
+    } // for
+    double elapsed = WallTime() - start;
+
+    for ( unsigned int i = 0; i < procs; i += 1 ) {
+	for ( unsigned int s = 0; s < Slots; s += 1 ) {
+	    free( sets[i][s] );
+	} // for
+	delete [] sets[i];
+    } // for
+    delete sampler;
+    delete [] tasks;
+    delete [] sets;
+    Report( "larson", procs, 2.0 * per * procs * Rounds, elapsed, peak );
+} // LarsonChurn
+
+
+//=======================================
+// size-class sweep: allocate and free batches of one size, from the smallest bucket into the mmap range
+//=======================================
+
+_Task Sweep {
+    size_t size;
+    unsigned int N;
+
+    void main() {
+	void *ptrs[BatchSize];
+	for ( unsigned int i = 0; i < N; i += BatchSize ) {
+	    for ( unsigned int b = 0; b < BatchSize; b += 1 ) {
+		ptrs[b] = Alloc( size );
+	    } // for
+	    for ( unsigned int b = 0; b < BatchSize; b += 1 ) {
+		free( ptrs[b] );
+	    } // for
+	} // for
+    } // Sweep::main
+  public:
+    Sweep( size_t size, unsigned int N ) : size( size ), N( N ) {}
+}; // Sweep
+
+static void SizeSweep( unsigned int procs, unsigned int N ) {
+    Sweep **tasks = new Sweep *[procs];
+    char name[32];
+
+    for ( size_t size = 16; size <= 1024 * 1024; size *= 4 ) {
+	unsigned int per = N / procs / ( size < 4096 ? 1 : size / 4096 ); // fewer iterations for large sizes
+	if ( per < BatchSize ) per = BatchSize;
+	per = per / BatchSize * BatchSize;
+	long int peak;
+	Sampler *sampler = new Sampler( peak );
+	double start = WallTime();
+	for ( unsigned int i = 0; i < procs; i += 1 ) {
+	    tasks[i] = new Sweep( size, per );
+	} // for
+	for ( unsigned int i = 0; i < procs; i += 1 ) {
+	    delete tasks[i];
+	} // for
+	double elapsed = WallTime() - start;
+	delete sampler;
+	snprintf( name, sizeof(name), "size %zu", size );
+	Report( name, procs, 2.0 * per * procs, elapsed, peak );
+    } // for
+    delete [] tasks;
+} // SizeSweep
+
+
+//=======================================
+// realloc growth: grow a block geometrically until it moves into the mmap range, then free it
+//=======================================
+
+_Task Grow {
+    unsigned int N;
+    unsigned long int &ops;
+
+    void main() {
+	const size_t Limit = 8 * 1024 * 1024;
+	unsigned long int count = 0;
+	for ( unsigned int i = 0; i < N; i += 1 ) {
+	    char *p = (char *)Alloc( 16 );
+	    for ( size_t size = 16; size < Limit; size += size / 4 + 16 ) {
+		p = (char *)realloc( p, size );
+		p[size - 1] = 1;
+		count += 1;
+	    } // for
+	    free( p );
+	    count += 2;
+	} // for
+	ops = count;
+    } // Grow::main
+  public:
+    Grow( unsigned int N, unsigned long int &ops ) : N( N ), ops( ops ) {}
+}; // Grow
+
+static void ReallocGrowth( unsigned int procs, unsigned int N ) {
+    long int peak;
+    Sampler *sampler = new Sampler( peak );
+    Grow **tasks = new Grow *[procs];
+    unsigned long int *ops = new unsigned long int[procs];
+    unsigned int per = N / procs / 50000 + 1;	// each growth copies tens of megabytes
+
+    double start = WallTime();
+    for ( unsigned int i = 0; i < procs; i += 1 ) {
+	tasks[i] = new Grow( per, ops[i] );
+    } // for
+    for ( unsigned int i = 0; i < procs; i += 1 ) {
+	delete tasks[i];
+    } // for
+    double elapsed = WallTime() - start;
+
+    double total = 0;
+    for ( unsigned int i = 0; i < procs; i += 1 ) total += ops[i];
+    sampler->profile();
+    delete sampler;
+    delete [] ops;
+    delete [] tasks;
+    Report( "realloc-growth", procs, total, elapsed, peak );
+} // ReallocGrowth
+
+
+void uMain::main() {
+    unsigned int MaxProcs = 8, N = 2000000;
+
+    switch ( argc ) {
+      case 3:
+	N = atoi( argv[2] );
+      case 2:
+	MaxProcs = atoi( argv[1] );
+      case 1:
+	break;
+      default:
+	uAbort( "Usage: %s [ maximum-processors (> 0) [ operations (> 0) ] ]", argv[0] );
+    } // switch
+    if ( MaxProcs == 0 || N == 0 ) {
+	uAbort( "Usage: %s [ maximum-processors (> 0) [ operations (> 0) ] ]", argv[0] );
+    } // if
+
+    osacquire( cout ) << left << setw( 18 ) << "test" << right << setw( 6 ) << "procs" << setw( 14 ) << "ops/sec"
+		      << setw( 14 ) << "peak RSS KB" << setw( 14 ) << "steady RSS KB" << setw( 14 ) << "max RSS KB"
+		      << endl;
+
+    for ( unsigned int procs = 1;; procs = procs * 2 > MaxProcs ? MaxProcs : procs * 2 ) { // 1, 2, 4, ..., MaxProcs
+	uProcessor **processor = new uProcessor *[procs];
+	for ( unsigned int i = 0; i < procs - 1; i += 1 ) {	// uMain's processor is already present
+	    processor[i] = new uProcessor;
+	} // for
+
+	ProducerConsumer( procs, N );
+	LarsonChurn( procs, N );
+	SizeSweep( procs, N );
+	ReallocGrowth( procs, N );
+
+	for ( unsigned int i = 0; i < procs - 1; i += 1 ) {
+	    delete processor[i];
+	} // for
+	delete [] processor;
+      if ( procs == MaxProcs ) break;
+    } // for
+
+    malloc_stats();
+} // uMain
+
+// Local Variables: //
+// compile-command: "../../bin/u++ -multi -O2 -nodebug AllocBench.cc" //
+// End: //
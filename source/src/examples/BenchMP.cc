@@ -0,0 +1,442 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// BenchMP.cc -- Multiprocessor scalability benchmarks for the basic features in uC++: ready-queue throughput,
+//     ping-pong, contended monitor entry, broadcast storms, lock and semaphore contention, and task spawn rate at
+//     1..N processors, with text, CSV or JSON output for tracking regressions across versions.
+//
+// Author           : agent
+// Created On       : Mon Oct 19 02:10:58 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 02:10:58 2026
+// Update Count     : 1
+//
+
+#include <iostream>
+using std::cout;
+using std::osacquire;
+using std::endl;
+#include <iomanip>
+using std::setw;
+using std::left;
+using std::right;
+#include <uSemaphore.h>
+#include <cstdio>					// snprintf
+#include <cstdlib>					// atoi
+#include <cstring>					// strcmp
+#include <unistd.h>					// sysconf
+#include <time.h>					// clock_gettime
+
+unsigned int uDefaultPreemption() {			// as for Bench.cc, no time slicing to perturb the timings
+    return 0;
+} // uDefaultPreemption
+
+//=======================================
+// measurement support
+//=======================================
+
+static double WallTime() {				// elapsed (not CPU) time, as tasks run on many processors
+    timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec + ts.tv_nsec / 1.0E9;
+} // WallTime
+
+enum Format { Text, CSV, JSON };
+static Format format = Text;
+static char version[32];
+static bool first = true;				// JSON comma separation
+
+static void Report( const char *test, unsigned int procs, unsigned int tasks, double ops, double elapsed ) {
+    char buf[256];
+
+    switch ( format ) {
+      case Text:
+	osacquire( cout ) << left << setw( 12 ) << test << right
+			  << setw( 6 ) << procs << setw( 8 ) << tasks
+			  << setw( 14 ) << (long int)( ops / elapsed )
+			  << setw( 12 ) << (long int)( elapsed * 1.0E9 / ops ) << endl;
+	break;
+      case CSV:
+	snprintf( buf, sizeof(buf), "%s,%s,%u,%u,%.0f,%.6f,%.0f,%.1f", version, test, procs, tasks, ops, elapsed,
+		  ops / elapsed, elapsed * 1.0E9 / ops );
+	osacquire( cout ) << buf << endl;
+	break;
+      case JSON:
+	snprintf( buf, sizeof(buf), "%s    { \"test\": \"%s\", \"procs\": %u, \"tasks\": %u, \"ops\": %.0f, \"seconds\": %.6f, "
+		  "\"ops_per_sec\": %.0f, \"nsecs_per_op\": %.1f }", first ? "" : ",\n", test, procs, tasks, ops, elapsed,
+		  ops / elapsed, elapsed * 1.0E9 / ops );
+	osacquire( cout ) << buf;
+	first = false;
+	break;
+    } // switch
+} // Report
+
+//=======================================
+// ready queue: more tasks than processors, each yielding, so every operation is a cluster ready-queue
+// insertion and removal
+//=======================================
+
+_Task Yielder {
+    unsigned int N;
+
+    void main() {
+	for ( unsigned int i = 0; i < N; i += 1 ) {
+	    yield();
+	} // for
+    } // Yielder::main
+  public:
+    Yielder( unsigned int N ) : N( N ) {}
+}; // Yielder
+
+static void ReadyQueue( unsigned int procs, unsigned int N ) {
+    unsigned int tasks = 2 * procs, per = N / tasks;
+    Yielder **yielders = new Yielder *[tasks];
+
+    double start = WallTime();
+    for ( unsigned int i = 0; i < tasks; i += 1 ) {
+	yielders[i] = new Yielder( per );
+    } // for
+    for ( unsigned int i = 0; i < tasks; i += 1 ) {
+	delete yielders[i];
+    } // for
+    double elapsed = WallTime() - start;
+    delete [] yielders;
+    Report( "yield", procs, tasks, (double)per * tasks, elapsed );
+} // ReadyQueue
+
+//=======================================
+// ping-pong: pairs of tasks alternating through a monitor condition, so each round trip is two blocks and two
+// wakeups, usually on different processors
+//=======================================
+
+_Monitor PingPong {
+    uCondition partner;
+  public:
+    void play( unsigned int N ) {
+	for ( unsigned int i = 1;; i += 1 ) {
+	    partner.signal();
+	  if ( i > N ) break;
+	    partner.wait();
+	} // for
+    } // PingPong::play
+}; // PingPong
+
+_Task Player {
+    PingPong &table;
+    unsigned int N;
+
+    void main() {
+	table.play( N );
+    } // Player::main
+  public:
+    Player( PingPong &table, unsigned int N ) : table( table ), N( N ) {}
+}; // Player
+
+static void PingPongPairs( unsigned int procs, unsigned int N ) {
+    unsigned int pairs = procs, per = N / pairs;
+    PingPong *tables = new PingPong[pairs];
+    Player **players = new Player *[2 * pairs];
+
+    double start = WallTime();
+    for ( unsigned int i = 0; i < 2 * pairs; i += 1 ) {
+	players[i] = new Player( tables[i / 2], per );
+    } // for
+    for ( unsigned int i = 0; i < 2 * pairs; i += 1 ) {
+	delete players[i];
+    } // for
+    double elapsed = WallTime() - start;
+    delete [] players;
+    delete [] tables;
+    Report( "ping-pong", procs, 2 * pairs, (double)per * pairs, elapsed ); // round trips
+} // PingPongPairs
+
+//=======================================
+// contention: one task per processor hammering a single monitor, owner lock or semaphore
+//=======================================
+
+_Monitor Counter {
+    unsigned long int count;
+  public:
+    Counter() : count( 0 ) {}
+    void increment() { count += 1; }
+}; // Counter
+
+_Task MonitorEntry {
+    Counter &counter;
+    unsigned int N;
+
+    void main() {
+	for ( unsigned int i = 0; i < N; i += 1 ) {
+	    counter.increment();
+	} // for
+    } // MonitorEntry::main
+  public:
+    MonitorEntry( Counter &counter, unsigned int N ) : counter( counter ), N( N ) {}
+}; // MonitorEntry
+
+struct Locked {						// protected by lock or semaphore
+    uOwnerLock lock;
+    uSemaphore sem;
+    volatile unsigned long int count;
+    Locked() : sem( 1 ), count( 0 ) {}
+}; // Locked
+
+_Task OwnerLockEntry {
+    Locked &locked;
+    unsigned int N;
+
+    void main() {
+	for ( unsigned int i = 0; i < N; i += 1 ) {
+	    locked.lock.acquire();
+	    locked.count += 1;
+	    locked.lock.release();
+	} // for
+    } // OwnerLockEntry::main
+  public:
+    OwnerLockEntry( Locked &locked, unsigned int N ) : locked( locked ), N( N ) {}
+}; // OwnerLockEntry
+
+_Task SemaphoreEntry {
+    Locked &locked;
+    unsigned int N;
+
+    void main() {
+	for ( unsigned int i = 0; i < N; i += 1 ) {
+	    locked.sem.P();
+	    locked.count += 1;
+	    locked.sem.V();
+	} // for
+    } // SemaphoreEntry::main
+  public:
+    SemaphoreEntry( Locked &locked, unsigned int N ) : locked( locked ), N( N ) {}
+}; // SemaphoreEntry
+
+static void MonitorContention( unsigned int procs, unsigned int N ) {
+    unsigned int per = N / procs;
+    Counter counter;
+    MonitorEntry **tasks = new MonitorEntry *[procs];
+
+    double start = WallTime();
+    for ( unsigned int i = 0; i < procs; i += 1 ) {
+	tasks[i] = new MonitorEntry( counter, per );
+    } // for
+    for ( unsigned int i = 0; i < procs; i += 1 ) {
+	delete tasks[i];
+    } // for
+    double elapsed = WallTime() - start;
+    delete [] tasks;
+    Report( "monitor", procs, procs, (double)per * procs, elapsed );
+} // MonitorContention
+
+static void OwnerLockContention( unsigned int procs, unsigned int N ) {
+    unsigned int per = N / procs;
+    Locked locked;
+    OwnerLockEntry **tasks = new OwnerLockEntry *[procs];
+
+    double start = WallTime();
+    for ( unsigned int i = 0; i < procs; i += 1 ) {
+	tasks[i] = new OwnerLockEntry( locked, per );
+    } // for
+    for ( unsigned int i = 0; i < procs; i += 1 ) {
+	delete tasks[i];
+    } // for
+    double elapsed = WallTime() - start;
+    delete [] tasks;
+    Report( "uOwnerLock", procs, procs, (double)per * procs, elapsed );
+} // OwnerLockContention
+
+static void SemaphoreContention( unsigned int procs, unsigned int N ) {
+    unsigned int per = N / procs;
+    Locked locked;
+    SemaphoreEntry **tasks = new SemaphoreEntry *[procs];
+
+    double start = WallTime();
+    for ( unsigned int i = 0; i < procs; i += 1 ) {
+	tasks[i] = new SemaphoreEntry( locked, per );
+    } // for
+    for ( unsigned int i = 0; i < procs; i += 1 ) {
+	delete tasks[i];
+    } // for
+    double elapsed = WallTime() - start;
+    delete [] tasks;
+    Report( "uSemaphore", procs, procs, (double)per * procs, elapsed );
+} // SemaphoreContention
+
+//=======================================
+// broadcast storm: a barrier where the last arrival wakes all the others with one broadcast, so each round
+// readies every waiting task at once
+//=======================================
+
+class Barrier {
+    uOwnerLock lock;
+    uCondLock waiters;
+    unsigned int total, arrived, generation;
+  public:
+    Barrier( unsigned int total ) : total( total ), arrived( 0 ), generation( 0 ) {}
+
+    void block() {
+	lock.acquire();
+	unsigned int gen = generation;
+	arrived += 1;
+	if ( arrived == total ) {			// last arrival ?
+	    arrived = 0;
+	    generation += 1;
+	    waiters.broadcast();
+	} else {
+	    while ( gen == generation ) waiters.wait( lock ); // ignore spurious wakeup
+	} // if
+	lock.release();
+    } // Barrier::block
+}; // Barrier
+
+_Task Arriver {
+    Barrier &barrier;
+    unsigned int rounds;
+
+    void main() {
+	for ( unsigned int i = 0; i < rounds; i += 1 ) {
+	    barrier.block();
+	} // for
+    } // Arriver::main
+  public:
+    Arriver( Barrier &barrier, unsigned int rounds ) : barrier( barrier ), rounds( rounds ) {}
+}; // Arriver
+
+static void BroadcastStorm( unsigned int procs, unsigned int N ) {
+    unsigned int tasks = 4 * procs, rounds = N / 16 / tasks;
+    Barrier barrier( tasks );
+    Arriver **arrivers = new Arriver *[tasks];
+
+    double start = WallTime();
+    for ( unsigned int i = 0; i < tasks; i += 1 ) {
+	arrivers[i] = new Arriver( barrier, rounds );
+    } // for
+    for ( unsigned int i = 0; i < tasks; i += 1 ) {
+	delete arrivers[i];
+    } // for
+    double elapsed = WallTime() - start;
+    delete [] arrivers;
+    Report( "broadcast", procs, tasks, (double)rounds * tasks, elapsed ); // barrier arrivals
+} // BroadcastStorm
+
+//=======================================
+// spawn: one task per processor repeatedly creating and deleting a task, so creation, first dispatch and
+// termination are spread over the processors
+//=======================================
+
+_Task TaskDummy {
+    void main() {
+    } // TaskDummy::main
+}; // TaskDummy
+
+_Task Spawner {
+    unsigned int N;
+
+    void main() {
+	for ( unsigned int i = 0; i < N; i += 1 ) {
+	    TaskDummy dummy;
+	} // for
+    } // Spawner::main
+  public:
+    Spawner( unsigned int N ) : N( N ) {}
+}; // Spawner
+
+static void SpawnRate( unsigned int procs, unsigned int N ) {
+    unsigned int per = N / 64 / procs;
+    Spawner **spawners = new Spawner *[procs];
+
+    double start = WallTime();
+    for ( unsigned int i = 0; i < procs; i += 1 ) {
+	spawners[i] = new Spawner( per );
+    } // for
+    for ( unsigned int i = 0; i < procs; i += 1 ) {
+	delete spawners[i];
+    } // for
+    double elapsed = WallTime() - start;
+    delete [] spawners;
+    Report( "spawn", procs, procs, (double)per * procs, elapsed );
+} // SpawnRate
+
+//=======================================
+// benchmark driver
+//=======================================
+
+void uMain::main() {
+    const char *usage = "Usage: %s [ maximum-processors (> 0) [ operations (> 0) [ text | csv | json ] ] ]";
+    unsigned int MaxProcs = sysconf( _SC_NPROCESSORS_ONLN ), N =
+#if defined( __U_DEBUG__ )				// takes longer so run fewer iterations
+	1000000;
+#else
+	10000000;
+#endif // __U_DEBUG__
+
+    switch ( argc ) {
+      case 4:
+	if ( strcmp( argv[3], "text" ) == 0 ) format = Text;
+	else if ( strcmp( argv[3], "csv" ) == 0 ) format = CSV;
+	else if ( strcmp( argv[3], "json" ) == 0 ) format = JSON;
+	else uAbort( usage, argv[0] );
+      case 3:
+	N = atoi( argv[2] );
+      case 2:
+	MaxProcs = atoi( argv[1] );
+      case 1:
+	break;
+      default:
+	uAbort( usage, argv[0] );
+    } // switch
+    if ( MaxProcs == 0 || N == 0 ) {
+	uAbort( usage, argv[0] );
+    } // if
+
+    snprintf( version, sizeof(version), "%d.%d.%d%s", __U_CPLUSPLUS__, __U_CPLUSPLUS_MINOR__, __U_CPLUSPLUS_PATCH__,
+#if defined( __U_DEBUG__ )
+	      "-debug"
+#else
+	      ""
+#endif // __U_DEBUG__
+	);
+
+    switch ( format ) {
+      case Text:
+	osacquire( cout ) << "uC++ " << version << ", " << N << " operations" << endl;
+	osacquire( cout ) << left << setw( 12 ) << "test" << right << setw( 6 ) << "procs" << setw( 8 ) << "tasks"
+			  << setw( 14 ) << "ops/sec" << setw( 12 ) << "nsecs/op" << endl;
+	break;
+      case CSV:
+	osacquire( cout ) << "version,test,procs,tasks,ops,seconds,ops_per_sec,nsecs_per_op" << endl;
+	break;
+      case JSON:
+	osacquire( cout ) << "{ \"benchmark\": \"BenchMP\", \"version\": \"" << version << "\", \"cpus\": "
+			  << sysconf( _SC_NPROCESSORS_ONLN ) << ", \"operations\": " << N << ", \"results\": [" << endl;
+	break;
+    } // switch
+
+    for ( unsigned int procs = 1;; procs = procs * 2 > MaxProcs ? MaxProcs : procs * 2 ) { // 1, 2, 4, ..., MaxProcs
+	uProcessor **processor = new uProcessor *[procs];
+	for ( unsigned int i = 0; i < procs - 1; i += 1 ) {	// uMain's processor is already present
+	    processor[i] = new uProcessor;
+	} // for
+
+	ReadyQueue( procs, N );
+	PingPongPairs( procs, N / 4 );
+	MonitorContention( procs, N );
+	BroadcastStorm( procs, N );
+	OwnerLockContention( procs, N );
+	SemaphoreContention( procs, N );
+	SpawnRate( procs, N );
+
+	for ( unsigned int i = 0; i < procs - 1; i += 1 ) {
+	    delete processor[i];
+	} // for
+	delete [] processor;
+      if ( procs == MaxProcs ) break;
+    } // for
+
+    if ( format == JSON ) osacquire( cout ) << endl << "  ] }" << endl;
+} // uMain
+
+// Local Variables: //
+// compile-command: "../../bin/u++ -multi -O2 -nodebug BenchMP.cc" //
+// End: //
@@ -0,0 +1,107 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// CommitBench.cc -- Commits per second for 1..N tasks appending small records to one file, each record made durable
+//     with its own fsync (uFile::FileAccess::fsync) or with a shared group commit (uFile::FileAccess::commit).
+//
+// Author           : agent
+// Created On       : Mon Oct 19 01:39:58 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 01:39:58 2026
+// Update Count     : 1
+//
+
+#include <uFile.h>
+#include <iostream>
+using std::cout;
+using std::cerr;
+using std::endl;
+#include <iomanip>
+using std::setw;
+#include <cstdio>										// snprintf
+#include <cstdlib>										// atoi
+#include <fcntl.h>										// O_WRONLY
+#include <time.h>										// clock_gettime
+#include <unistd.h>										// unlink
+
+unsigned int Commits = 200;								// per task
+
+static double WallTime() {
+	timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return ts.tv_sec + ts.tv_nsec / 1.0E9;
+} // WallTime
+
+_Task Committer {
+	uFile::FileAccess &file;
+	unsigned int id;
+	bool group;
+
+	void main() {
+		char buf[64];
+		for ( unsigned int i = 0; i < Commits; i += 1 ) {
+			int len = snprintf( buf, sizeof(buf), "task %u commit %u\n", id, i );
+			file.write( buf, len );
+			if ( group ) {
+				file.commit();
+			} else {
+				file.fsync();
+			} // if
+		} // for
+	} // Committer::main
+  public:
+	Committer( uFile::FileAccess &file, unsigned int id, bool group ) : file( file ), id( id ), group( group ) {}
+}; // Committer
+
+double Run( uFile &file, unsigned int tasks, bool group ) {
+	uFile::FileAccess output( file, O_WRONLY | O_CREAT | O_TRUNC );
+	double start = WallTime();
+	{
+		Committer **committers = new Committer *[tasks];
+		for ( unsigned int i = 0; i < tasks; i += 1 ) committers[i] = new Committer( output, i, group );
+		for ( unsigned int i = 0; i < tasks; i += 1 ) delete committers[i];
+		delete [] committers;
+	}
+	return (double)tasks * Commits / ( WallTime() - start );
+} // Run
+
+void uMain::main() {
+	const char *name = "CommitBench.data";
+	unsigned int MaxTasks = 128;
+
+	switch ( argc ) {
+	  case 4:
+		name = argv[3];
+	  case 3:
+		Commits = atoi( argv[2] );
+	  case 2:
+		MaxTasks = atoi( argv[1] );
+	  case 1:
+		break;
+	  default:
+		cerr << "Usage: " << argv[0] << " [ maximum-tasks (> 0) [ commits (> 0) [ data-file ] ] ]" << endl;
+		exit( EXIT_FAILURE );
+	} // switch
+	if ( MaxTasks == 0 || Commits == 0 ) {
+		cerr << "Usage: " << argv[0] << " [ maximum-tasks (> 0) [ commits (> 0) [ data-file ] ] ]" << endl;
+		exit( EXIT_FAILURE );
+	} // if
+
+	uFile file( name );
+	uProcessor processors[3];							// committing tasks run in parallel
+
+	cout << setw(8) << "tasks" << setw(16) << "fsync/sec" << setw(16) << "commit/sec" << endl;
+	for ( unsigned int tasks = 1;; tasks = tasks * 2 > MaxTasks ? MaxTasks : tasks * 2 ) { // 1, 2, 4, ..., MaxTasks
+		double single = Run( file, tasks, false );
+		double group = Run( file, tasks, true );
+		cout << setw(8) << tasks << setw(16) << (long int)single << setw(16) << (long int)group << endl;
+	  if ( tasks == MaxTasks ) break;
+	} // for
+	unlink( name );
+} // uMain
+
+// Local Variables: //
+// tab-width: 4 //
+// compile-command: "u++-work -O2 -multi -nodebug CommitBench.cc" //
+// End: //
@@ -0,0 +1,173 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// DGRAMBatch.cc -- Throughput of INET/datagram sockets over loopback, comparing one datagram per system call
+//     (sendto/recvfrom) with batches of datagrams per system call (sendmmsg/recvmmsg).
+//
+// Author           : agent
+// Created On       : Mon Oct 19 01:17:44 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 01:17:44 2026
+// Update Count     : 1
+//
+
+#include <uSemaphore.h>
+#include <uSocket.h>
+#include <iostream>
+using std::cout;
+using std::cerr;
+using std::endl;
+#include <iomanip>
+using std::setw;
+#include <cstdlib>										// atoi
+#include <cstring>										// memset
+#include <time.h>										// clock_gettime
+
+enum { MaxBatch = 64, MaxSize = 1024 };
+unsigned int Messages = 1000000, Batch = 32, Size = 64;
+
+// Datagram sockets are lossy. A window semaphore bounds the datagrams in flight so the loopback receive buffer does not
+// overflow; the receiver returns window slots as datagrams arrive. Should datagrams still be dropped, the receiver times
+// out, counts the outstanding datagrams as lost, and returns their slots so the sender can finish.
+
+enum { Window = 4 * MaxBatch };
+uSemaphore window( Window );
+volatile unsigned int sent, received, lost;
+
+static double WallTime() {
+	timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return ts.tv_sec + ts.tv_nsec / 1.0E9;
+} // WallTime
+
+_Task Receiver {
+	uSocketServer &server;
+	bool batched;
+
+	void main() {
+		uDuration timeout( 1, 0 );						// idle time before datagrams are declared lost
+		static char bufs[MaxBatch][MaxSize];
+		struct iovec iov[MaxBatch];
+		struct mmsghdr msgs[MaxBatch];
+
+		for ( unsigned int i = 0; i < Batch; i += 1 ) {
+			iov[i].iov_base = bufs[i];
+			iov[i].iov_len = Size;
+		} // for
+
+		while ( received + lost < Messages ) {
+			try {
+				unsigned int cnt;
+				if ( batched ) {
+					memset( msgs, 0, sizeof(msgs) );
+					for ( unsigned int i = 0; i < Batch; i += 1 ) {
+						msgs[i].msg_hdr.msg_iov = &iov[i];
+						msgs[i].msg_hdr.msg_iovlen = 1;
+					} // for
+					cnt = server.recvmmsg( msgs, Batch, 0, &timeout );
+				} else {
+					server.recvfrom( bufs[0], Size, 0, &timeout );
+					cnt = 1;
+				} // if
+				received += cnt;
+				window.V( cnt );
+			} catch( uSocketServer::ReadTimeout ) {
+				unsigned int missing = sent - received - lost;
+				lost += missing;
+				window.V( missing );
+			} // try
+		} // while
+	} // Receiver::main
+  public:
+	Receiver( uSocketServer &server, bool batched ) : server( server ), batched( batched ) {
+	} // Receiver::Receiver
+}; // Receiver
+
+_Task Sender {
+	uSocketClient &client;
+	bool batched;
+
+	void main() {
+		static char bufs[MaxBatch][MaxSize];
+		struct iovec iov[MaxBatch];
+		struct mmsghdr msgs[MaxBatch];
+		struct sockaddr *to = (struct sockaddr *)client.getsockaddr();
+
+		memset( bufs, 'x', sizeof(bufs) );
+		for ( unsigned int i = 0; i < Batch; i += 1 ) {
+			iov[i].iov_base = bufs[i];
+			iov[i].iov_len = Size;
+		} // for
+
+		for ( unsigned int remaining = Messages; remaining > 0; ) {
+			unsigned int n = batched ? ( remaining < Batch ? remaining : Batch ) : 1;
+			for ( unsigned int i = 0; i < n; i += 1 ) window.P();
+			if ( batched ) {
+				memset( msgs, 0, sizeof(msgs) );
+				for ( unsigned int i = 0; i < n; i += 1 ) {
+					msgs[i].msg_hdr.msg_name = to;
+					msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+					msgs[i].msg_hdr.msg_iov = &iov[i];
+					msgs[i].msg_hdr.msg_iovlen = 1;
+				} // for
+				for ( unsigned int done = 0; done < n; ) {	// sendmmsg may transfer a prefix of the vector
+					done += client.sendmmsg( msgs + done, n - done );
+				} // for
+			} else {
+				client.sendto( bufs[0], Size );
+			} // if
+			sent += n;
+			remaining -= n;
+		} // for
+	} // Sender::main
+  public:
+	Sender( uSocketClient &client, bool batched ) : client( client ), batched( batched ) {
+	} // Sender::Sender
+}; // Sender
+
+void run( const char *name, bool batched ) {
+	unsigned short port;
+	uSocketServer server( &port, SOCK_DGRAM );			// bind a server socket to a free port
+	uSocketClient client( port, SOCK_DGRAM );
+
+	sent = received = lost = 0;
+	double start = WallTime();
+	{
+		Receiver receiver( server, batched );
+		Sender sender( client, batched );
+	}
+	double elapsed = WallTime() - start;
+
+	cout << setw(10) << name << setw(8) << ( batched ? Batch : 1 ) << setw(12) << received
+		 << setw(10) << lost << setw(14) << (long int)(received / elapsed) << endl;
+} // run
+
+void uMain::main() {
+	switch ( argc ) {
+	  case 4:
+		Size = atoi( argv[3] );
+	  case 3:
+		Batch = atoi( argv[2] );
+	  case 2:
+		Messages = atoi( argv[1] );
+	  case 1:
+		break;
+	  default:
+		cerr << "Usage: " << argv[0] << " [ messages (> 0) [ batch (1-" << MaxBatch << ") [ size (1-" << MaxSize << ") ] ] ]" << endl;
+		exit( EXIT_FAILURE );
+	} // switch
+	if ( Messages == 0 || Batch == 0 || Batch > MaxBatch || Size == 0 || Size > MaxSize ) {
+		cerr << "Usage: " << argv[0] << " [ messages (> 0) [ batch (1-" << MaxBatch << ") [ size (1-" << MaxSize << ") ] ] ]" << endl;
+		exit( EXIT_FAILURE );
+	} // if
+
+	cout << setw(10) << "api" << setw(8) << "batch" << setw(12) << "received" << setw(10) << "lost" << setw(14) << "msgs/sec" << endl;
+	run( "sendto", false );
+	run( "sendmmsg", true );
+} // uMain
+
+// Local Variables: //
+// tab-width: 4 //
+// compile-command: "u++-work -O2 -multi -nodebug DGRAMBatch.cc" //
+// End: //
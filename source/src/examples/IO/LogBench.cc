@@ -0,0 +1,130 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// LogBench.cc -- Cost of logging from many tasks, comparing a formatted write per record (uFile::FileAccess::write)
+//     with asynchronous logging (uLog), where tasks only capture the record and a writer task formats and writes.
+//
+// Author           : agent
+// Created On       : Mon Oct 19 01:35:05 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 01:35:05 2026
+// Update Count     : 1
+//
+
+#include <uFile.h>
+#include <uLog.h>
+#include <iostream>
+using std::cout;
+using std::cerr;
+using std::osacquire;
+using std::endl;
+#include <iomanip>
+using std::setw;
+#include <cstdio>										// snprintf
+#include <cstdlib>										// atoi
+#include <fcntl.h>										// O_WRONLY
+#include <time.h>										// clock_gettime
+#include <unistd.h>										// unlink
+
+unsigned int Tasks = 16, Records = 100000;
+
+static double WallTime() {
+	timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return ts.tv_sec + ts.tv_nsec / 1.0E9;
+} // WallTime
+
+_Task Direct {
+	uFile::FileAccess &file;
+	unsigned int id;
+
+	void main() {
+		char buf[128];
+		for ( unsigned int i = 0; i < Records; i += 1 ) {
+			int len = snprintf( buf, sizeof(buf), "task %u record %u value %.3f\n", id, i, i / 7.0 );
+			file.write( buf, len );
+		} // for
+	} // Direct::main
+  public:
+	Direct( uFile::FileAccess &file, unsigned int id ) : file( file ), id( id ) {}
+}; // Direct
+
+_Task Logger {
+	uLog &log;
+	unsigned int id;
+
+	void main() {
+		for ( unsigned int i = 0; i < Records; i += 1 ) {
+			log.log( "task %u record %u value %.3f", id, i, i / 7.0 );
+		} // for
+	} // Logger::main
+  public:
+	Logger( uLog &log, unsigned int id ) : log( log ), id( id ) {}
+}; // Logger
+
+void report( const char *name, double append, double total ) {
+	double n = (double)Tasks * Records;
+	osacquire( cout ) << setw(8) << name << setw(16) << (long int)( append / n * 1.0E9 )
+					  << setw(16) << (long int)( total / n * 1.0E9 ) << endl;
+} // report
+
+void uMain::main() {
+	const char *name = "LogBench.log";
+
+	switch ( argc ) {
+	  case 4:
+		name = argv[3];
+	  case 3:
+		Records = atoi( argv[2] );
+	  case 2:
+		Tasks = atoi( argv[1] );
+	  case 1:
+		break;
+	  default:
+		cerr << "Usage: " << argv[0] << " [ tasks (> 0) [ records (> 0) [ log-file ] ] ]" << endl;
+		exit( EXIT_FAILURE );
+	} // switch
+	if ( Tasks == 0 || Records == 0 ) {
+		cerr << "Usage: " << argv[0] << " [ tasks (> 0) [ records (> 0) [ log-file ] ] ]" << endl;
+		exit( EXIT_FAILURE );
+	} // if
+
+	uFile file( name );
+	uProcessor processors[3];							// logging tasks run in parallel
+	double start, append;
+
+	cout << setw(8) << "api" << setw(16) << "ns/rec (tasks)" << setw(16) << "ns/rec (disk)" << endl;
+
+	{
+		uFile::FileAccess output( file, O_WRONLY | O_CREAT | O_TRUNC );
+		start = WallTime();
+		{
+			Direct **tasks = new Direct *[Tasks];
+			for ( unsigned int i = 0; i < Tasks; i += 1 ) tasks[i] = new Direct( output, i );
+			for ( unsigned int i = 0; i < Tasks; i += 1 ) delete tasks[i];
+			delete [] tasks;
+		}
+		append = WallTime() - start;
+		report( "write", append, append );
+	}
+	{
+		uLog log( file );
+		start = WallTime();
+		{
+			Logger **tasks = new Logger *[Tasks];
+			for ( unsigned int i = 0; i < Tasks; i += 1 ) tasks[i] = new Logger( log, i );
+			for ( unsigned int i = 0; i < Tasks; i += 1 ) delete tasks[i];
+			delete [] tasks;
+		}
+		append = WallTime() - start;
+		log.flush();									// include formatting and writing
+		report( "uLog", append, WallTime() - start );
+	}
+	unlink( name );
+} // uMain
+
+// Local Variables: //
+// tab-width: 4 //
+// compile-command: "u++-work -O2 -multi -nodebug LogBench.cc" //
+// End: //
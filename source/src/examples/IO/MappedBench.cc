@@ -0,0 +1,141 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// MappedBench.cc -- Scan a large file by reading 64K chunks (uFile::FileAccess::read) and through a mapping
+//     (uFile::MappedAccess) with prefetching ahead of the scan, while a ticker task measures how long the scanning
+//     processor is unavailable to other tasks.
+//
+// Author           : agent
+// Created On       : Mon Oct 19 01:37:51 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 01:37:51 2026
+// Update Count     : 1
+//
+
+#include <uFile.h>
+#include <iostream>
+using std::cout;
+using std::cerr;
+using std::endl;
+#include <iomanip>
+using std::setw;
+#include <cstdlib>										// atoi
+#include <cstring>										// memset
+#include <fcntl.h>										// O_RDONLY
+#include <time.h>										// clock_gettime
+#include <unistd.h>										// unlink
+
+enum { Chunk = 64 * 1024, Window = 64 * Chunk };		// read size, prefetch distance
+
+static double WallTime() {
+	timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return ts.tv_sec + ts.tv_nsec / 1.0E9;
+} // WallTime
+
+// Runs on the scanning processor, waking every millisecond; a late wakeup means the processor was blocked.
+
+_Task Ticker {
+	volatile bool &done;
+	double &worst;
+
+	void main() {
+		worst = 0.0;
+		while ( ! done ) {
+			double start = WallTime();
+			_Timeout( uDuration( 0, 1000000 ) );
+			double late = WallTime() - start - 0.001;
+			if ( late > worst ) worst = late;
+		} // while
+	} // Ticker::main
+  public:
+	Ticker( volatile bool &done, double &worst ) : done( done ), worst( worst ) {}
+}; // Ticker
+
+void report( const char *name, size_t size, double elapsed, double delay, unsigned long int sum ) {
+	cout << setw(10) << name << setw(12) << (long int)( size / elapsed / ( 1024 * 1024 ) )
+		 << setw(16) << (long int)( delay * 1.0E6 ) << setw(6) << ( sum & 0xff ) << endl;
+} // report
+
+void uMain::main() {
+	const char *name = "MappedBench.data";
+	unsigned int megabytes = 256;
+
+	switch ( argc ) {
+	  case 3:
+		name = argv[2];
+	  case 2:
+		megabytes = atoi( argv[1] );
+	  case 1:
+		break;
+	  default:
+		cerr << "Usage: " << argv[0] << " [ megabytes (> 0) [ data-file ] ]" << endl;
+		exit( EXIT_FAILURE );
+	} // switch
+	if ( megabytes == 0 ) {
+		cerr << "Usage: " << argv[0] << " [ megabytes (> 0) [ data-file ] ]" << endl;
+		exit( EXIT_FAILURE );
+	} // if
+
+	uFile file( name );
+	size_t size = (size_t)megabytes * 1024 * 1024;
+	char *buf = new char[Chunk];
+
+	{													// create data
+		uFile::FileAccess output( file, O_WRONLY | O_CREAT | O_TRUNC );
+		memset( buf, 'x', Chunk );
+		for ( size_t done = 0; done < size; done += Chunk ) output.write( buf, Chunk );
+	}
+
+	cout << setw(10) << "access" << setw(12) << "MB/sec" << setw(16) << "max stall usec" << setw(6) << "sum" << endl;
+	// Each scan uses the file as left in the page cache by the previous one; run twice to see both cold and warm.
+	for ( unsigned int run = 0; run < 2; run += 1 ) {
+		volatile bool done;
+		double start, elapsed, delay;
+		unsigned long int sum;
+
+		done = false;
+		sum = 0;
+		{
+			Ticker ticker( done, delay );
+			start = WallTime();
+			uFile::FileAccess input( file, O_RDONLY );
+			for ( ;; ) {
+				int len = input.read( buf, Chunk );
+			  if ( len == 0 ) break;
+				for ( int i = 0; i < len; i += 512 ) sum += buf[i];
+			} // for
+			elapsed = WallTime() - start;
+			done = true;
+		}
+		report( "read", size, elapsed, delay, sum );
+
+		done = false;
+		sum = 0;
+		{
+			Ticker ticker( done, delay );
+			start = WallTime();
+			uFile::MappedAccess input( file );
+			input.advise( uFile::MappedAccess::Sequential );
+			input.prefetch( 0, Window, true );				// first window before scanning
+			const char *data = input.data();
+			for ( size_t off = 0; off < input.size(); off += Chunk ) {
+				if ( off % Window == 0 ) input.prefetch( off + Window, Window ); // next window in background
+				size_t end = off + Chunk < input.size() ? off + Chunk : input.size();
+				for ( size_t i = off; i < end; i += 512 ) sum += data[i];
+			} // for
+			elapsed = WallTime() - start;
+			done = true;
+		}
+		report( "mapped", size, elapsed, delay, sum );
+	} // for
+
+	delete [] buf;
+	unlink( name );
+} // uMain
+
+// Local Variables: //
+// tab-width: 4 //
+// compile-command: "u++-work -O2 -multi -nodebug MappedBench.cc" //
+// End: //
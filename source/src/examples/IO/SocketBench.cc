@@ -0,0 +1,239 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// SocketBench.cc -- Echo server and load generator over loopback INET or UNIX stream sockets. Each connection sends
+//     a fixed-size request and waits for it to be echoed, reporting requests/sec, latency percentiles, system calls per
+//     request and CPU per request for the server and client clusters.
+//
+// Author           : agent
+// Created On       : Mon Oct 19 02:13:15 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 02:13:15 2026
+// Update Count     : 1
+//
+
+#include <uSocket.h>
+#include <uHistogram.h>
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <cstdio>										// snprintf
+#include <cstdlib>										// atoi
+#include <cstring>										// strcmp
+#include <unistd.h>										// getpid, unlink
+#include <sys/resource.h>								// getrusage, setrlimit
+
+enum { StackSize = 32 * 1024 };							// thousands of tasks on each side
+enum Domain { INET, UNIX };
+
+unsigned int Connections = 1000, MsgSize = 64, Requests = 1000, Procs = 2;
+Domain domain = INET;
+uHistogram latency;										// request round trip, nanoseconds
+
+//=======================================
+// server: one acceptor per connection, echoing until the client closes
+//=======================================
+
+_Task Acceptor {
+	uSocketServer &server;
+
+	void main() {
+		uSocketAccept acceptor( server );				// accept a connection from a client
+		char *buf = new char[MsgSize];
+		for ( ;; ) {
+			int len = acceptor.read( buf, MsgSize );
+		  if ( len == 0 ) break;						// client closed ?
+			acceptor.write( buf, len );					// write back what arrived, request may be in pieces
+		} // for
+		delete [] buf;
+	} // Acceptor::main
+  public:
+	Acceptor( uCluster &cluster, uSocketServer &server ) : uBaseTask( cluster ), server( server ) {}
+}; // Acceptor
+
+//=======================================
+// load generator: connections connect, wait at a gate so connection setup is not timed, then run closed-loop requests
+//=======================================
+
+_Monitor Gate {
+	unsigned int arrived;
+	bool opened;
+	uCondition all, go;
+  public:
+	Gate() : arrived( 0 ), opened( false ) {}
+
+	void arrive() {
+		arrived += 1;
+		if ( arrived == Connections ) all.signal();
+		if ( ! opened ) go.wait();
+		go.signal();									// cascade to next waiting connection
+	} // Gate::arrive
+
+	void connected() {
+		if ( arrived != Connections ) all.wait();
+	} // Gate::connected
+
+	void open() {
+		opened = true;
+		go.signal();
+	} // Gate::open
+}; // Gate
+
+_Task Connection {
+	Gate &gate;
+	const char *name;
+	unsigned short port;
+
+	void main() {
+		uSocketClient *client = domain == UNIX ? new uSocketClient( name ) : new uSocketClient( port );
+		char *request = new char[MsgSize], *reply = new char[MsgSize];
+		memset( request, 'x', MsgSize );
+
+		gate.arrive();
+		for ( unsigned int r = 0; r < Requests; r += 1 ) {
+			unsigned long long int start = uHistogram::now();
+			client->write( request, MsgSize );
+			for ( unsigned int len = 0; len < MsgSize; ) {	// reply may arrive in pieces
+				int rlen = client->read( reply + len, MsgSize - len );
+				if ( rlen == 0 ) uAbort( "SocketBench : server closed connection" );
+				len += rlen;
+			} // for
+			latency.record( uHistogram::now() - start );
+		} // for
+		delete client;									// close => acceptor terminates
+		delete [] request;
+		delete [] reply;
+	} // Connection::main
+  public:
+	Connection( uCluster &cluster, Gate &gate, const char *name, unsigned short port ) :
+		uBaseTask( cluster ), gate( gate ), name( name ), port( port ) {}
+}; // Connection
+
+//=======================================
+// measurement support
+//=======================================
+
+struct Sample {
+	double wall, cpu;									// process elapsed and CPU seconds
+	double server, client;								// cluster CPU seconds
+	unsigned long long int syscalls;					// I/O system calls, statistics build only
+
+	void take( uCluster &serverCluster, uCluster &clientCluster ) {
+		timespec ts;
+		clock_gettime( CLOCK_MONOTONIC, &ts );
+		wall = ts.tv_sec + ts.tv_nsec / 1.0E9;
+		rusage usage;
+		getrusage( RUSAGE_SELF, &usage );
+		cpu = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1.0E6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1.0E6;
+		server = serverCluster.getCPUTime().nanoseconds() / 1.0E9;
+		client = clientCluster.getCPUTime().nanoseconds() / 1.0E9;
+#ifdef __U_STATISTICS__
+		syscalls = (unsigned long long int)UPP::Statistics::read_syscalls + UPP::Statistics::write_syscalls +
+			UPP::Statistics::select_syscalls + UPP::Statistics::accept_syscalls + UPP::Statistics::uring_submits;
+#else
+		syscalls = 0;
+#endif // __U_STATISTICS__
+	} // Sample::take
+}; // Sample
+
+void uMain::main() {
+	const char *usage = "Usage: %s [ connections (> 0) [ message-size (> 0) [ requests (> 0) [ processors (> 0) [ inet | unix ] ] ] ] ]";
+
+	switch ( argc ) {
+	  case 6:
+		if ( strcmp( argv[5], "inet" ) == 0 ) domain = INET;
+		else if ( strcmp( argv[5], "unix" ) == 0 ) domain = UNIX;
+		else uAbort( usage, argv[0] );
+	  case 5:
+		Procs = atoi( argv[4] );
+	  case 4:
+		Requests = atoi( argv[3] );
+	  case 3:
+		MsgSize = atoi( argv[2] );
+	  case 2:
+		Connections = atoi( argv[1] );
+	  case 1:
+		break;
+	  default:
+		uAbort( usage, argv[0] );
+	} // switch
+	if ( Connections == 0 || MsgSize == 0 || Requests == 0 || Procs == 0 ) {
+		uAbort( usage, argv[0] );
+	} // if
+
+	rlimit limit;										// two descriptors per connection
+	if ( getrlimit( RLIMIT_NOFILE, &limit ) == 0 && limit.rlim_cur < limit.rlim_max ) {
+		limit.rlim_cur = limit.rlim_max;
+		setrlimit( RLIMIT_NOFILE, &limit );
+	} // if
+
+	char name[64];
+	snprintf( name, sizeof(name), "/tmp/SocketBench.%d", getpid() );
+	unsigned short port = 0;
+	uSocketServer *server = domain == UNIX ? new uSocketServer( name, SOCK_STREAM, 0, Connections ) :
+		new uSocketServer( &port, SOCK_STREAM, 0, Connections ); // backlog for connection burst
+
+	// Server and load generator run on separate clusters, so each has its own processors and CPU time.
+	uCluster serverCluster( StackSize, "server" ), clientCluster( StackSize, "client" );
+	uProcessor **processors = new uProcessor *[2 * Procs];
+	for ( unsigned int i = 0; i < Procs; i += 1 ) {
+		processors[i] = new uProcessor( serverCluster );
+		processors[Procs + i] = new uProcessor( clientCluster );
+	} // for
+
+	Gate gate;
+	Acceptor **acceptors = new Acceptor *[Connections];
+	Connection **connections = new Connection *[Connections];
+	for ( unsigned int i = 0; i < Connections; i += 1 ) {
+		acceptors[i] = new Acceptor( serverCluster, *server );
+		connections[i] = new Connection( clientCluster, gate, name, port );
+	} // for
+
+	Sample start, end;
+	gate.connected();
+	start.take( serverCluster, clientCluster );
+	gate.open();
+	for ( unsigned int i = 0; i < Connections; i += 1 ) {
+		delete connections[i];
+	} // for
+	end.take( serverCluster, clientCluster );
+
+	for ( unsigned int i = 0; i < Connections; i += 1 ) {
+		delete acceptors[i];
+	} // for
+	delete [] acceptors;
+	delete [] connections;
+	delete server;
+	if ( domain == UNIX ) unlink( name );
+	for ( unsigned int i = 0; i < 2 * Procs; i += 1 ) {
+		delete processors[i];
+	} // for
+	delete [] processors;
+
+	double requests = (double)Connections * Requests, elapsed = end.wall - start.wall;
+	char buf[512];
+	snprintf( buf, sizeof(buf),
+			  "%s, %u connections, %u bytes, %u requests/connection, %u processors/side\n"
+			  "requests/sec %.0f\n"
+			  "latency usec p50 %.1f p99 %.1f p999 %.1f max %.1f\n"
+			  "CPU usec/request process %.2f server %.2f client %.2f\n",
+			  domain == UNIX ? "unix" : "inet", Connections, MsgSize, Requests, Procs,
+			  requests / elapsed,
+			  latency.percentile( 50.0 ) / 1.0E3, latency.percentile( 99.0 ) / 1.0E3, latency.percentile( 99.9 ) / 1.0E3,
+			  latency.maximum() / 1.0E3,
+			  ( end.cpu - start.cpu ) * 1.0E6 / requests, ( end.server - start.server ) * 1.0E6 / requests,
+			  ( end.client - start.client ) * 1.0E6 / requests );
+	cout << buf;
+#ifdef __U_STATISTICS__
+	snprintf( buf, sizeof(buf), "I/O system calls/request %.2f (both sides)\n", ( end.syscalls - start.syscalls ) / requests );
+	cout << buf;
+#else
+	cout << "I/O system calls/request n/a (uC++ installed without STATISTICS)" << endl;
+#endif // __U_STATISTICS__
+} // uMain
+
+// Local Variables: //
+// tab-width: 4 //
+// compile-command: "u++-work -O2 -multi -nodebug SocketBench.cc" //
+// End: //
@@ -0,0 +1,125 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// OutputBench.cc -- Many tasks writing formatted records to one concurrent stream, comparing records formatted while
+//     holding the stream (osacquire) with records formatted in a private buffer and appended (osbuffer), at 1..N
+//     processors.
+//
+// Author           : agent
+// Created On       : Mon Oct 19 01:31:49 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 01:31:49 2026
+// Update Count     : 1
+//
+
+#include <iostream>
+using std::cout;
+using std::osacquire;
+using std::osbuffer;
+using std::endl;
+#include <fstream>
+using std::ofstream;
+#include <iomanip>
+using std::setw;
+using std::left;
+using std::right;
+using std::setprecision;
+#include <cstdlib>					// atoi
+#include <time.h>					// clock_gettime
+
+static double WallTime() {				// elapsed (not CPU) time, as tasks run on many processors
+    timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec + ts.tv_nsec / 1.0E9;
+} // WallTime
+
+_Task Logger {
+    ofstream &log;
+    unsigned int id, records;
+    bool buffered;
+
+    void main() {
+	for ( unsigned int i = 0; i < records; i += 1 ) {
+	    double value = i / 7.0;
+	    if ( buffered ) {
+		osbuffer( log ) << "task " << setw( 4 ) << id << " record " << setw( 8 ) << i
+				<< " value " << setprecision( 6 ) << value << '\n';
+	    } else {
+		osacquire( log ) << "task " << setw( 4 ) << id << " record " << setw( 8 ) << i
+				 << " value " << setprecision( 6 ) << value << '\n';
+	    } // if
+	} // for
+    } // Logger::main
+  public:
+    Logger( ofstream &log, unsigned int id, unsigned int records, bool buffered ) :
+	log( log ), id( id ), records( records ), buffered( buffered ) {}
+}; // Logger
+
+static void Run( const char *file, unsigned int procs, unsigned int tasks, unsigned int records, bool buffered ) {
+    ofstream log( file );
+    double start = WallTime();
+    {
+	Logger **loggers = new Logger *[tasks];
+	for ( unsigned int i = 0; i < tasks; i += 1 ) {
+	    loggers[i] = new Logger( log, i, records, buffered );
+	} // for
+	for ( unsigned int i = 0; i < tasks; i += 1 ) {
+	    delete loggers[i];
+	} // for
+	delete [] loggers;
+    }
+    log.flush();
+    double elapsed = WallTime() - start;
+
+    osacquire( cout ) << left << setw( 12 ) << ( buffered ? "osbuffer" : "osacquire" ) << right
+		      << setw( 6 ) << procs << setw( 8 ) << tasks
+		      << setw( 14 ) << (long int)( (double)tasks * records / elapsed ) << endl;
+} // Run
+
+void uMain::main() {
+    unsigned int MaxProcs = 8, Tasks = 100, Records = 20000;
+    const char *file = "/dev/null";
+
+    switch ( argc ) {
+      case 5:
+	file = argv[4];
+      case 4:
+	Records = atoi( argv[3] );
+      case 3:
+	Tasks = atoi( argv[2] );
+      case 2:
+	MaxProcs = atoi( argv[1] );
+      case 1:
+	break;
+      default:
+	uAbort( "Usage: %s [ maximum-processors (> 0) [ tasks (> 0) [ records (> 0) [ file ] ] ] ]", argv[0] );
+    } // switch
+    if ( MaxProcs == 0 || Tasks == 0 || Records == 0 ) {
+	uAbort( "Usage: %s [ maximum-processors (> 0) [ tasks (> 0) [ records (> 0) [ file ] ] ] ]", argv[0] );
+    } // if
+
+    osacquire( cout ) << left << setw( 12 ) << "stream" << right << setw( 6 ) << "procs" << setw( 8 ) << "tasks"
+		      << setw( 14 ) << "records/sec" << endl;
+
+    for ( unsigned int procs = 1;; procs = procs * 2 > MaxProcs ? MaxProcs : procs * 2 ) { // 1, 2, 4, ..., MaxProcs
+	uProcessor **processor = new uProcessor *[procs];
+	for ( unsigned int i = 0; i < procs - 1; i += 1 ) {	// uMain's processor is already present
+	    processor[i] = new uProcessor;
+	} // for
+
+	Run( file, procs, Tasks, Records, false );
+	Run( file, procs, Tasks, Records, true );
+
+	for ( unsigned int i = 0; i < procs - 1; i += 1 ) {
+	    delete processor[i];
+	} // for
+	delete [] processor;
+      if ( procs == MaxProcs ) break;
+    } // for
+} // uMain
+
+
+// Local Variables: //
+// compile-command: "u++-work -O2 -multi -nodebug OutputBench.cc" //
+// End: //
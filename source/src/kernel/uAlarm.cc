@@ -197,15 +197,7 @@ void uEventList::setTimer( uTime time ) {		// time parameter is real-time (not v
 
   if ( time == 0 ) return;				// zero time is invalid
 
-#if defined( REALTIME_POSIX )
-    timespec curr;
-    if ( clocktype < 0 ) type = CLOCK_REALTIME;
-    clock_gettime( type, &curr );
-#else
-    timeval curr;
-    GETTIMEOFDAY( &curr );
-#endif // REALTIME_POSIX
-    uTime currtime( curr.tv_sec, curr.tv_usec * 1000 );	// convert to nanoseconds
+    uTime currtime = uClock::now();
 
     uDuration dur = time - currtime;
     if ( dur <= 0 ) {					// if duration is zero or negative (it has already past)
@@ -76,6 +76,7 @@ void uBaseCoroutine::unwindStack() {
 
 
 void uBaseCoroutine::createCoroutine() {
+    typeName = NULL;					// set by uCoroutineConstructor/uTaskConstructor
     errno_ = 0;
     state = Start;
     notHalted = true;					// must be a non-zero value so detectable after memory is scrubbed
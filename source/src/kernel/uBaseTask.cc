@@ -30,12 +30,14 @@
 
 
 #include <uC++.h>
+#include <uHeapLmmm.h>
 #ifdef __U_PROFILER__
 #include <uProfiler.h>
 #endif // __U_PROFILER__
 //#include <uDebug.h>
 
 
+
 using namespace UPP;
 
 
@@ -78,10 +80,28 @@ void uBaseTask::createTask( uCluster &cluster ) {
 
     // memory allocation
 
+    heapSampleBytes = UPP::uHeapSampler::initialSample();
     if ( this != (uBaseTask *)uKernelModule::bootTask ) {
 	heapData = NULL;
 	uHeapControl::prepareTask( this );
     } // if
+
+    // contention profiling
+
+    lockSampleCount = 0;
+    lockHeld = NULL;
+    lockSignalled = 0;
+
+    // processor-time accounting
+
+    cpuTime = 0;
+    for ( unsigned int i = 0; i < sizeof(perfCounts) / sizeof(perfCounts[0]); i += 1 ) perfCounts[i] = 0;
+
+#ifdef __U_STATISTICS__
+    // scheduling statistics
+
+    readyTime = 0;
+#endif // __U_STATISTICS__
 } // uBaseTask::createTask
 
 
@@ -90,6 +110,21 @@ uBaseTask::uBaseTask( uCluster &cluster, uProcessor &processor ) : uBaseCoroutin
 } // uBaseTask::uBaseTask
 
 
+// The running task adds its current run, from the time its processor dispatched it, with interrupts disabled so it
+// cannot be moved to another processor between reading the time and the processor.
+
+uDuration uBaseTask::getCPUTime() const {
+    unsigned long long int ns = cpuTime;
+    if ( this == &uThisTask() ) {
+	THREAD_GETMEM( This )->disableInterrupts();
+	long long int run = uClock::monotonic() - uThisProcessor().dispatchTime;
+	if ( run > 0 ) ns += run;
+	THREAD_GETMEM( This )->enableInterrupts();
+    } // if
+    return uDuration( ns / 1000000000, ns % 1000000000 );
+} // uBaseTask::getCPUTime
+
+
 void uBaseTask::setState( uBaseTask::State s ) {
     state = s;
 
@@ -33,6 +33,12 @@
 #include <uBootTask.h>
 #include <uSystemTask.h>
 #include <uFilebuf.h>
+#include <uCPUProfiler.h>
+#include <uTracer.h>
+#include <uContention.h>
+#include <uPerfCounters.h>
+#include <uStackProfiler.h>
+#include <uHistogram.h>
 #ifdef __U_STATISTICS__
 #include <uHeapLmmm.h>
 #endif // __U_STATISTICS__
@@ -69,12 +75,13 @@ int Statistics::ready_queue = 0, Statistics::spins = 0, Statistics::spin_sched =
 unsigned int Statistics::select_syscalls = 0, Statistics::select_errors = 0, Statistics::select_eintr = 0;
 unsigned int Statistics::select_events = 0, Statistics::select_nothing = 0, Statistics::select_blocking = 0, Statistics::select_pending = 0;
 unsigned int Statistics::select_maxFD = 0;
-unsigned int Statistics::accept_syscalls = 0, Statistics::accept_errors = 0;
+unsigned int Statistics::accept_syscalls = 0, Statistics::accept_errors = 0, Statistics::accept_connections = 0, Statistics::accept_eagain = 0;
 unsigned int Statistics::read_syscalls = 0, Statistics::read_errors = 0, Statistics::read_eagain = 0, Statistics::read_chunking = 0, Statistics::read_bytes = 0;
 unsigned int Statistics::write_syscalls = 0, Statistics::write_errors = 0, Statistics::write_eagain = 0, Statistics::write_bytes = 0;
 unsigned int Statistics::sendfile_syscalls = 0, Statistics::sendfile_errors = 0, Statistics::sendfile_eagain = 0, Statistics::first_sendfile = 0, Statistics::sendfile_yields = 0;
+unsigned int Statistics::uring_submits = 0, Statistics::uring_ops = 0, Statistics::uring_fallbacks = 0;
 
-unsigned int Statistics::iopoller_exchange = 0, Statistics::iopoller_spin = 0;
+unsigned int Statistics::iopoller_exchange = 0, Statistics::iopoller_spin = 0, Statistics::iopoller_kernel = 0, Statistics::iopoller_busy = 0;
 unsigned int Statistics::signal_alarm = 0, Statistics::signal_usr1 = 0;
 
 // Scheduling statistics
@@ -133,7 +140,10 @@ void UPP::Statistics::print() {
 		    " / max fd %d\n"
 		    "  accept:"
 		    " calls %d"
-		    " / errors %d\n",
+		    " / errors %d"
+		    " / eagain %d"
+		    " / connections %d"
+		    " / connections per call %d%%\n",
 		    Statistics::select_syscalls,
 		    Statistics::select_errors,
 		    Statistics::select_eintr,
@@ -143,7 +153,10 @@ void UPP::Statistics::print() {
 		    Statistics::select_blocking,
 		    Statistics::select_maxFD,
 		    Statistics::accept_syscalls,
-		    Statistics::accept_errors );
+		    Statistics::accept_errors,
+		    Statistics::accept_eagain,
+		    Statistics::accept_connections,
+		    (Statistics::accept_syscalls != 0 ? Statistics::accept_connections * 100 / Statistics::accept_syscalls : 0 ) );
     uDebugWrite( STDOUT_FILENO, helpText, len );
 
     len = snprintf( helpText, 512,
@@ -176,16 +189,27 @@ void UPP::Statistics::print() {
 		    " / eagain %d"
 		    " / yields %d"
 		    " / first call completion %d\n"
+		    "  io_uring:"
+		    " submits %d"
+		    " / operations %d"
+		    " / fallbacks %d\n"
 		    "  iopoller:"
 		    " exchanges %d"
-		    " / spins %d\n",
+		    " / spins %d"
+		    " / kernel polls %d"
+		    " / busy polls %d\n",
 		    Statistics::sendfile_syscalls,
 		    Statistics::sendfile_errors,
 		    Statistics::sendfile_eagain,
 		    Statistics::sendfile_yields,
 		    Statistics::first_sendfile,
+		    Statistics::uring_submits,
+		    Statistics::uring_ops,
+		    Statistics::uring_fallbacks,
 		    Statistics::iopoller_exchange,
-		    Statistics::iopoller_spin );
+		    Statistics::iopoller_spin,
+		    Statistics::iopoller_kernel,
+		    Statistics::iopoller_busy );
     uDebugWrite( STDOUT_FILENO, helpText, len );
 
     len = snprintf( helpText, 512,
@@ -205,6 +229,46 @@ void UPP::Statistics::print() {
 		    Statistics::events,
 		    Statistics::setitimer );
     uDebugWrite( STDOUT_FILENO, helpText, len );
+
+    // print may be called from a signal handler that interrupted a processor holding a cluster's processor lock, so the
+    // lock is only tried, and a busy cluster's remaining histograms are skipped. The merge space is static, as print is
+    // not reentrant and a histogram is too large for a signal stack.
+
+    static const char *histogramNames[] = { "ready queue wait", "run length", "I/O wakeup" };
+    static uHistogram h;
+    len = snprintf( helpText, 512, "\nScheduling latency (microseconds):\n" );
+    uDebugWrite( STDOUT_FILENO, helpText, len );
+    uClusterDL *cr;
+    for ( uSeqIter<uClusterDL> ci( *uKernelModule::globalClusters ); ci >> cr; ) {
+	uCluster &cluster = cr->cluster();
+	len = snprintf( helpText, 512, "  cluster %.256s\n", cluster.getName() );
+	uDebugWrite( STDOUT_FILENO, helpText, len );
+	for ( unsigned int i = 0; i < uCluster::NoOfSchedHistograms; i += 1 ) {
+	  if ( ! cluster.processorsOnClusterLock.tryacquire() ) break; // interrupted processor holds lock ?
+	    h.reset();
+	    cluster.mergeSchedHistogram( i, h );
+	    cluster.processorsOnClusterLock.release();
+	  if ( h.count() == 0 ) continue;
+	    len = snprintf( helpText, 512,
+			    "    %s:"
+			    " samples %llu"
+			    " / mean %.1f"
+			    " / p50 %.1f"
+			    " / p90 %.1f"
+			    " / p99 %.1f"
+			    " / p99.9 %.1f"
+			    " / max %.1f\n",
+			    histogramNames[i],
+			    h.count(),
+			    h.mean() / 1.0E3,
+			    h.percentile( 50.0 ) / 1.0E3,
+			    h.percentile( 90.0 ) / 1.0E3,
+			    h.percentile( 99.0 ) / 1.0E3,
+			    h.percentile( 99.9 ) / 1.0E3,
+			    h.maximum() / 1.0E3 );
+	    uDebugWrite( STDOUT_FILENO, helpText, len );
+	} // for
+    } // for
 } // UPP::Statistics::print
 #endif // __U_STATISTICS__
 
@@ -384,8 +448,14 @@ void uBaseSpinLock::acquire_( bool rollforward ) {
 
 #ifdef __U_MULTI__
     int spin = SPIN_START;
+    bool first = true;
+    unsigned long long int start = 0;			// 0 => contention not sampled
     for ( ;; ) {					// poll for lock
       if ( value == 0 && uTestSet( value ) == 0 ) break;
+	if ( first ) {					// contended ?
+	    first = false;
+	    if ( uContention::spinSample() ) start = uContention::now();
+	} // if
 	if ( rollforward ) {				// allow timeslicing during spinning
 	    THREAD_GETMEM( This )->enableIntSpinLockNoRF();
 	} else {
@@ -411,6 +481,9 @@ void uBaseSpinLock::acquire_( bool rollforward ) {
 	} // if
 	THREAD_GETMEM( This )->disableIntSpinLock();
     } // for
+    if ( start != 0 ) {					// return address is the caller of acquire
+	uContention::acquired( NULL, this, __builtin_return_address( 0 ), "uSpinLock", true, uContention::now() - start );
+    } // if
 
 #if defined( __sparc__ )
     asm volatile ( "membar #LoadLoad" );		// flush the cache
@@ -481,8 +554,11 @@ bool uLock::tryacquire() {
 
 
 void uOwnerLock::add_( uBaseTask &task ) {		// used by uCondLock::signal
+    // A sampled waiter times its owner-lock re-acquire from when it is queued here, not from when it started waiting.
+    unsigned long long int signalled = task.lockSignalled != 0 ? uContention::now() : 0;
     spinLock.acquire();
     if ( owner_ != NULL ) {				// lock in use ?
+	if ( signalled != 0 ) task.lockSignalled = signalled; // task cannot restart until lock released
 	waiting.addTail( &(task.entryRef) );		// move task to owner lock list
     } else {
 	owner_ = &task;					// become owner
@@ -524,6 +600,8 @@ void uOwnerLock::acquire() {
     assert( uKernelModule::initialized ? ! THREAD_GETMEM( disableInt ) && THREAD_GETMEM( disableIntCnt ) == 0 : true );
 
     uBaseTask &task = uThisTask();			// optimization
+    bool sampled = uContention::sample( task );
+    unsigned long long int start = sampled ? uContention::now() : 0;
     spinLock.acquire();
 #ifdef KNOT
     task.setActivePriority( task.getActivePriorityValue() + 1 );
@@ -539,6 +617,9 @@ void uOwnerLock::acquire() {
 	    uFetchAdd( Statistics::owner_lock_queue, -1 );
 #endif // __U_STATISTICS__
 	    // owner_ and count set in release
+	    if ( sampled ) {
+		uContention::acquired( &task, this, __builtin_return_address( 0 ), "uOwnerLock", true, uContention::now() - start );
+	    } // if
 	    return;
 	} // if
 	owner_ = &task;					// become owner
@@ -547,6 +628,9 @@ void uOwnerLock::acquire() {
 	count += 1;					// remember how often
     } // if
     spinLock.release();
+    if ( sampled ) {					// owner reads its own count
+	uContention::acquired( count == 1 ? &task : NULL, this, __builtin_return_address( 0 ), "uOwnerLock", false, 0 );
+    } // if
 } // uOwnerLock::acquire
 
 
@@ -579,6 +663,8 @@ bool uOwnerLock::tryacquire() {
 void uOwnerLock::release() {
     assert( uKernelModule::initialized ? ! THREAD_GETMEM( disableInt ) && THREAD_GETMEM( disableIntCnt ) == 0 : true );
 
+    uBaseTask &task = uThisTask();			// optimization
+    if ( task.lockHeld == this && count == 1 ) uContention::released( task ); // last release ?
     spinLock.acquire();
 #ifdef __U_DEBUG__
     if ( owner_ == NULL ) {
@@ -628,6 +714,15 @@ uCondLock::~uCondLock() {
 #endif // __U_DEBUG__
 
 
+void uCondLock::reacquired( uBaseTask &task, uOwnerLock &lock, const void *site ) {
+  if ( task.lockSignalled == 0 ) return;		// wait not sampled ?
+    bool contended = task.lockSignalled != 1;		// queued behind the owner at signal or timeout ?
+    uContention::acquired( &task, &lock, site, "uOwnerLock", contended,
+			   contended ? uContention::now() - task.lockSignalled : 0 );
+    task.lockSignalled = 0;
+} // uCondLock::reacquired
+
+
 void uCondLock::wait( uOwnerLock &lock ) {
     uBaseTask &task = uThisTask();			// optimization
 #ifdef __U_DEBUG__
@@ -639,6 +734,9 @@ void uCondLock::wait( uOwnerLock &lock ) {
 #endif // __U_DEBUG__
     task.ownerLock = &lock;				// task remembers this lock before blocking for use in signal
     unsigned int prevcnt = lock.count;			// remember this lock's recursive count before blocking
+    if ( task.lockHeld == &lock ) uContention::released( task );
+    // Time waiting for a signal is not contention, so a sample records only the owner-lock re-acquire after the signal.
+    task.lockSignalled = uContention::sample( task ) ? 1 : 0;
     spinLock.acquire();
     waiting.addTail( &(task.entryRef) );		// queue current task
     // Must add to the condition queue first before releasing the owner lock because testing for empty condition can
@@ -648,6 +746,7 @@ void uCondLock::wait( uOwnerLock &lock ) {
     // spin released by schedule, owner lock is acquired when task restarts
 //    assert( &task == lock.owner() );
     lock.count = prevcnt;				// reestablish lock's recursive count after blocking
+    reacquired( task, lock, __builtin_return_address( 0 ) );
 } // uCondLock::wait
 
 
@@ -667,6 +766,8 @@ bool uCondLock::wait( uOwnerLock &lock, uTime time ) {
 #endif // __U_DEBUG__
     task.ownerLock = &lock;				// task remembers this lock before blocking for use in signal
     unsigned int prevcnt = lock.count;			// remember this lock's recursive count before blocking
+    if ( task.lockHeld == &lock ) uContention::released( task );
+    task.lockSignalled = uContention::sample( task ) ? 1 : 0; // see wait above
     spinLock.acquire();
 
 #ifdef __U_DEBUG_H__
@@ -688,6 +789,7 @@ bool uCondLock::wait( uOwnerLock &lock, uTime time ) {
     lock.count = prevcnt;				// reestablish lock's recursive count after blocking
 
     timeoutEvent.remove();
+    reacquired( task, lock, __builtin_return_address( 0 ) );
 
     return ! handler.timedout;
 } // uCondLock::wait
@@ -1129,6 +1231,8 @@ namespace UPP {
 	lastAcceptor = NULL;
 	notAlive = false;
 
+	typeName = NULL;				// set by uSerialConstructor/uTaskConstructor
+
 #ifdef __U_PROFILER__
 	// profiling
 
@@ -1198,6 +1302,7 @@ namespace UPP {
 	    ml.add( &(task.mutexRef), mutexOwner );	// add to end of mutex queue
 	    task.calledEntryMem = &ml;			// remember which mutex member called
 	    entryList.add( &(task.entryRef), mutexOwner ); // add mutex object to end of entry queue
+	    task.lockWaited = true;			// contention profiling
 	    uProcessorKernel::schedule( &spinLock );	// find someone else to execute; release lock on kernel stack
 	    mr = task.mutexRecursion;			// save previous recursive count
 	    task.mutexRecursion = 0;			// reset recursive count
@@ -1311,6 +1416,7 @@ namespace UPP {
 	    } // if
 	    task.mutexRecursion -= 1;
 	} else {
+	    if ( task.lockHeld == this ) uContention::released( task );
 	    if ( acceptMask ) {
 		// lock is acquired and mask set by accept statement
 		acceptMask = false;
@@ -1398,6 +1504,7 @@ namespace UPP {
 
     void uSerial::leave2() {				// used when a task is leaving a mutex and has queued itself before calling
 	uBaseTask &task = uThisTask();			// optimization
+	if ( task.lockHeld == this ) uContention::released( task );
 
 	if ( acceptMask ) {
 	    // lock is acquired and mask set by accept statement
@@ -1714,6 +1821,7 @@ namespace UPP {
 #ifdef __U_DEBUG_H__
 	uDebugPrt( "(uSerialConstructor &)%p.uSerialConstructor, f:%d, s:%p, n:%s\n", this, f, &serial, n );
 #endif // __U_DEBUG_H__
+	if ( f == uYes ) serial.typeName = n;		// CPU profiler attribution
 
 #ifdef __U_PROFILER__
 	if ( f == uYes ) {
@@ -1812,6 +1920,13 @@ namespace UPP {
 	} // if
 #endif // __U_PROFILER__
 
+	bool sampled = uContention::sample( task );
+	unsigned long long int start = 0;
+	if ( sampled ) {
+	    task.lockWaited = false;
+	    start = uContention::now();
+	} // if
+
 	try {
 	    // Polling in enter happens after properly setting values of mr and therefore, in the catch clause, it can
 	    // be used to retore the mr value in the uSerial object.
@@ -1840,6 +1955,11 @@ namespace UPP {
 	} // try
 
 	noUserOverride = true;
+	uTracer::event( uTracer::MonitorEnter, &task, &serial, 0, serial.typeName );
+	if ( sampled ) {				// return address is in the mutex member; hold unless recursive entry
+	    uContention::acquired( task.mutexRecursion == 0 ? &task : NULL, &serial, __builtin_return_address( 0 ), serial.typeName,
+				   task.lockWaited, uContention::now() - start );
+	} // if
 
 #ifdef __U_PROFILER__
 	if ( task.profileActive && uProfiler::uProfiler_registerMutexFunctionEntryDone ) { // task registered for profiling ?
@@ -1885,6 +2005,7 @@ namespace UPP {
 	} // if
 #endif // __U_PROFILER__
 
+	uTracer::event( uTracer::MonitorExit, &task, &serial, 0, serial.typeName );
 	serial.leave( mr );
     } // uSerialMember::~uSerialMember
 
@@ -1892,7 +2013,7 @@ namespace UPP {
     uCoroutineConstructor::uCoroutineConstructor( uAction f, uSerial &serial, uBaseCoroutine &coroutine, const char *name ) {
 	if ( f == uYes ) {
 	    coroutine.startHere( (void (*)( uMachContext & ))uMachContext::invokeCoroutine );
-	    coroutine.name = name;
+	    coroutine.name = coroutine.typeName = name;
 	    coroutine.serial = &serial;			// set cormonitor's serial instance
 
 #ifdef __U_PROFILER__
@@ -1926,6 +2047,7 @@ namespace UPP {
 
 
     uCoroutineDestructor::~uCoroutineDestructor() {
+	if ( f == uYes ) uStackProfiler::record( coroutine ); // before stack freed
 #ifdef __U_PROFILER__
 	if ( f == uYes ) {
 	    if ( uThisTask().profileActive && uProfiler::uProfiler_deregisterCoroutine ) { // profiling this coroutine & coroutine registered for profiling ? 
@@ -1942,8 +2064,9 @@ namespace UPP {
 #endif // __U_DEBUG_H__
 	if ( f == uYes ) {
 	    task.startHere( (void (*)( uMachContext & ))uMachContext::invokeTask );
-	    task.name = n;
+	    task.name = task.typeName = n;
 	    task.serial = &serial;			// set task's serial instance
+	    serial.typeName = n;			// CPU profiler attribution
 	    task.setSerial( serial );
 	    task.uPIQ = &piq;
 
@@ -1989,6 +2112,7 @@ namespace UPP {
 	    } // if
 #endif // __U_DEBUG__
 
+	    uStackProfiler::record( task );		// before stack freed
 	    cleanup( task );
 	} // if
     } // uTaskDestructor::uTaskDestructor
@@ -2223,6 +2347,7 @@ void UPP::uKernelBoot::startup() {
     sprintf( dummy, "dummy%d\n", 6 );			// force dynamic loading for this and associated routines
 
     uMachContext::pageSize = sysconf( _SC_PAGESIZE );
+    uClock::startup();					// UCLOCKSOURCE, before any timer is set
 
     // create kernel locks
 
@@ -2347,6 +2472,12 @@ void UPP::uKernelBoot::startup() {
     uKernelModule::userProcessors = new uProcessor*[ uKernelModule::numUserProcessors ];
     uKernelModule::userProcessors[0] = new uProcessor( *uKernelModule::userCluster );
 
+    uCPUProfiler::startup();				// UPROFILE
+    uTracer::startup();					// UTRACE
+    uContention::startup();				// UCONTENTION
+    uPerfCounters::startup();				// UPERFCOUNTERS
+    uStackProfiler::startup();				// USTACKPROFILE
+
 #ifdef __U_DEBUG__
     // uOwnerLock has a runtime check testing if locking is attempted from inside the kernel. This check only applies
     // once the system becomes concurrent. During the previous boot-strapping code, some locks may be invoked (and hence
@@ -2387,6 +2518,13 @@ void UPP::uKernelBoot::finishup() {
 	       THREAD_GETMEM( disableInt ), THREAD_GETMEM( disableIntCnt ), uThisProcessor().getPreemption() );
 #endif // __U_DEBUG_H__
 
+    uCPUProfiler::finishup();				// write profile before processors disappear
+    uTracer::finishup();				// write trace
+    uContention::finishup();				// write contention report
+    uPerfCounters::finishup();				// close per-task counts
+    uStackProfiler::finishup();				// write stack report
+    UPP::uHeapSampler::finishup();			// stop heap-profile dump task
+
     // Flush standard output streams as required by 27.4.2.1.6
 
     delete uKernelModule::cinFilebuf;
@@ -2411,6 +2549,8 @@ void UPP::uKernelBoot::finishup() {
 	       THREAD_GETMEM( disableInt ), THREAD_GETMEM( disableIntCnt ), uThisProcessor().getPreemption() );
 #endif // __U_DEBUG_H__
 
+    uFile::finishup();					// remove file helper processors while the kernel is running
+
     delete uKernelModule::userProcessors[0];
     delete [] uKernelModule::userProcessors;
     delete uKernelModule::userCluster;
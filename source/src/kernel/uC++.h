@@ -143,6 +143,8 @@ extern "C" bool malloc_zero_fill( void *addr ) __THROW;
 extern "C" size_t malloc_usable_size( void *addr ) __THROW;
 extern "C" void malloc_stats() __THROW;
 extern "C" int malloc_stats_fd( int fd ) __THROW;
+extern "C" int malloc_trim( size_t pad ) __THROW;
+extern "C" int malloc_sample_dump( int fd ) __THROW;
 
 #include <exception>
 #include <iosfwd>					// std::filebuf
@@ -162,6 +164,12 @@ extern "C" int malloc_stats_fd( int fd ) __THROW;
 #ifndef M_TOP_PAD
 #define M_TOP_PAD (-2)
 #endif // M_TOP_PAD
+#ifndef M_TRIM_THRESHOLD
+#define M_TRIM_THRESHOLD (-3)
+#endif // M_TRIM_THRESHOLD
+#define M_HUGE_PAGES (-100)				// uC++ specific: 0 => off, 1 => transparent huge pages, 2 => 1 + MAP_HUGETLB
+#define M_SAMPLE_INTERVAL (-101)			// uC++ specific: mean bytes between heap-profile samples, 0 => off
+#define M_SAMPLE_SIGNAL (-102)				// uC++ specific: signal requesting a heap-profile dump, 0 => none
 
 
 #ifdef __U_STATISTICS__
@@ -175,12 +183,13 @@ namespace UPP {
 	static unsigned int select_syscalls, select_errors, select_eintr;
 	static unsigned int select_events, select_nothing, select_blocking, select_pending;
 	static unsigned int select_maxFD;
-	static unsigned int accept_syscalls, accept_errors;
+	static unsigned int accept_syscalls, accept_errors, accept_connections, accept_eagain;
 	static unsigned int read_syscalls, read_errors, read_eagain, read_chunking, read_bytes;
 	static unsigned int write_syscalls, write_errors, write_eagain, write_bytes;
 	static unsigned int sendfile_syscalls, sendfile_errors, sendfile_eagain, first_sendfile, sendfile_yields;
+	static unsigned int uring_submits, uring_ops, uring_fallbacks;
 
-	static unsigned int iopoller_exchange, iopoller_spin;
+	static unsigned int iopoller_exchange, iopoller_spin, iopoller_kernel, iopoller_busy;
 	static unsigned int signal_alarm, signal_usr1;
 
 	// Scheduling statistics
@@ -223,12 +232,22 @@ class uCondition;					// forward declaration
 class uTimeoutHndlr;					// forward declaration
 class uWakeupHndlr;					// forward declaration
 class uRWLock;						// forward declaration
+class uCPUProfiler;					// forward declaration
+class uTracer;						// forward declaration
+class uTraceRing;					// forward declaration
+class uContention;					// forward declaration
+class uHistogram;					// forward declaration
+class uPerfCounters;					// forward declaration
+class uPerfGroup;					// forward declaration
+class uStackProfiler;					// forward declaration
 
 namespace UPP {
     class uKernelBoot;					// forward declaration
     class uInitProcessorsBoot;				// forward declaration
     _Task uBootTask;					// forward declaration
     class uHeapManager;					// forward declaration
+    class uHeapSampler;					// forward declaration
+    _Task uHeapDumper;					// forward declaration
     class uHeapControl;					// forward declaration
     class uSerial;					// forward declaration
     class uSerialConstructor;				// forward declaration
@@ -293,6 +312,8 @@ namespace UPP {
     class uSigHandlerModule {
 	friend class uKernelBoot;			// access: uSigHandlerModule
 	friend _Task ::uLocalDebugger;			// access: signal
+	friend class uHeapSampler;			// access: signal
+	friend class ::uCPUProfiler;			// access: signal, signalContextPC, signalContextFP
 #ifdef __U_PROFILER__
 	friend _Task ::uProfiler;			// access: signal, signalContextPC
 #endif // __U_PROFILER__
@@ -301,6 +322,7 @@ namespace UPP {
 
 	static void signal( int sig, void (*handler)(__U_SIGPARMS__), int flags = 0 );
 	static void *signalContextPC( __U_SIGCXT__ cxt );
+	static void *signalContextFP( __U_SIGCXT__ cxt );
 	static void *functionAddress( void (*function)() );
 	static void sigTermHandler( __U_SIGPARMS__ );
 	static void sigAlrmHandler( __U_SIGPARMS__ );
@@ -421,6 +443,7 @@ class uKernelModule {
     friend class uCluster;				// access: uKernelModuleBoot, globalClusters, globalClusterLock, rollForward
     friend _Task UPP::uBootTask;			// access: uKernelModuleBoot, systemCluster
     friend _Task uSystemTask;				// access: systemCluster
+    friend _Task UPP::uHeapDumper;			// access: systemCluster
     friend void UPP::umainProfile();			// access: bootTask
     friend class UPP::uKernelBoot;			// access: everything
     friend class UPP::uInitProcessorsBoot;		// access: numUserProcessors, userProcessors
@@ -458,6 +481,9 @@ class uKernelModule {
 
     friend class uKernelSampler;			// access: globalClusters
     friend class uClusterSampler;			// access: globalClusters
+#ifdef __U_STATISTICS__
+    friend void UPP::Statistics::print();		// access: globalClusters
+#endif // __U_STATISTICS__
 #if defined( __linux__ ) || defined( __freebsd__ )
     friend __typeof__( ::dl_iterate_phdr ) dl_iterate_phdr; // access: disableInterrupts, enableInterrupts
 #endif // __linux__ || __freebsd__
@@ -910,6 +936,7 @@ class uCondLock {
     uCondLock( uCondLock & );				// no copy
     uCondLock &operator=( uCondLock & );		// no assignment
     void waitTimeout( uBaseTask &task, TimedWaitHandler &h ); // timeout
+    static void reacquired( uBaseTask &task, uOwnerLock &lock, const void *site ); // contention sample after wait
   public:
     uCondLock() {
 #ifdef __U_STATISTICS__
@@ -1097,6 +1124,8 @@ namespace UPP {
 	friend class ::uProcessor;			// access: storage
 	friend class uKernelBoot;			// access: storage
 	friend void *uKernelModule::startThread( void *p ); // acesss: invokeCoroutine
+	friend class ::uStackProfiler;			// access: size, limit, base, stackFilled
+	friend class ::uCPUProfiler;			// access: limit, base
 
 	struct uContext_t {
 	    void *SP;
@@ -1124,6 +1153,7 @@ namespace UPP {
 	    } is;
 	} extras;					// indicates extra work during the context switch
 	bool userStack;					// use specified stack storage ?
+	bool stackFilled;				// stack filled for high-water mark ?
 
 	void createContext( unsigned int stackSize );	// used by all constructors
 
@@ -1222,14 +1252,15 @@ extern "C" void pthread_exit( void *status );
 
 class uBaseCoroutine : public UPP::uMachContext {
     friend class UPP::uMachContext;			// access: notHalted, main, suspend, setState, corStarter, corFinish
-    friend class UPP::uCoroutineConstructor;		// access: name, serial
+    friend class UPP::uCoroutineConstructor;		// access: name, typeName, serial
     friend class UPP::uCoroutineDestructor;		// access: UnwindStack
     friend class uBaseTask;				// access: serial, profileTaskSamplerInstance
     friend class UPP::uTaskDestructor;			// access: profileTaskSamplerInstance
-    friend class UPP::uTaskConstructor;			// access: name, serial
+    friend class UPP::uTaskConstructor;			// access: name, typeName, serial
     friend class UPP::uKernelBoot;			// access: last
     friend _Task UPP::uBootTask;			// access: notHalted
     friend _Coroutine UPP::uProcessorKernel;		// access: contextSw
+    friend class uStackProfiler;			// access: typeName
 #ifdef __U_ERRNO_FUNC__
     friend int *__U_ERRNO_FUNC__ __THROW;		// access: errno_
 #endif // __U_ERRNO_FUNC__
@@ -1259,6 +1290,7 @@ class uBaseCoroutine : public UPP::uMachContext {
     enum CancellationType { CancelPoll = PTHREAD_CANCEL_DEFERRED, CancelImplicit = PTHREAD_CANCEL_ASYNCHRONOUS };
   private:
     const char *name;					// textual name for coroutine/task, initialized by uC++ generated code
+    const char *typeName;				// _Coroutine/_Task type, name may be changed
     uBaseCoroutine *starter_;				// first coroutine to resume this one
     UPP::uSerial *serial;				// original serial instance for cormonitor/task (versus currently used instance)
     int errno_;						// copy of global UNIX variable errno
@@ -1684,16 +1716,17 @@ namespace UPP {
 
     class uSerial {
 	friend class ::uCondition;			// access: acceptSignalled, leave2
-	friend class uSerialConstructor;		// access: mr, prevSerial, leave
+	friend class uSerialConstructor;		// access: mr, prevSerial, leave, typeName
 	friend class uSerialDestructor;			// access: prevSerial, acceptSignalled, lastAcceptor, mutexOwner, leave, ~uSerialDestructor, enterDestructor
-	friend class uSerialMember;			// access: lastAcceptor, notAlive, enter, leave
-	friend class uTaskConstructor;			// access: acceptSignalled
+	friend class uSerialMember;			// access: lastAcceptor, notAlive, enter, leave, typeName
+	friend class uTaskConstructor;			// access: acceptSignalled, typeName
 	friend class uMachContext;			// access: leave2
 	friend _Task uBootTask;				// access: acceptSignalled
 	friend class ::uBasePrioritySeq;		// access: mutexOwnerlock TEMPORARY
 	friend class ::uRepositionEntry;		// access: lock, entryList TEMPORARY
 	friend class ::uBaseScheduleFriend;		// access: checkHookConditions
 	friend class ::uTimeoutHndlr;			// access: enterTimeout
+	friend class ::uCPUProfiler;			// access: typeName
 
 #ifdef __U_PROFILER__
 	// profiling
@@ -1727,6 +1760,10 @@ namespace UPP {
 
 	uBaseTask *lastAcceptor;			// acceptor of current entry for communication between acceptor and caller
 
+	// CPU profiling
+
+	const char *typeName;				// type of mutex object, NULL => unknown
+
 	// profiling : necessary for compatibility between non-profiling and profiling
 
 	mutable uProfileTaskSampler *profileSerialSamplerInstance; // pointer to related profiling object
@@ -1989,6 +2026,14 @@ namespace UPP {
 } // UPP
 
 
+// The events counted for each task are declared here, rather than in uPerfCounters.h, so uBaseTask can size its counts
+// without the uPerfCounters class, which refers to uProcessor.
+
+struct uPerfCountersEvents {
+    enum Counter { Cycles, Instructions, CacheMisses, BranchMisses, PageFaults, ContextSwitches, NoOfCounters };
+}; // uPerfCountersEvents
+
+
 //######################### uBaseTask (cont) #########################
 
 
@@ -2232,6 +2277,8 @@ class uBaseTask : public uBaseCoroutine {
 	return *currSerial;
     } // uBaseTask::getSerial
 
+    uDuration getCPUTime() const;			// time run on processors, including the current run if called by the task
+
 #ifdef __U_PROFILER__
     // profiling
 
@@ -2245,6 +2292,18 @@ class uBaseTask : public uBaseCoroutine {
     uBasePIQ *uPIQ;					// TEMPORARY
     void *pthreadData;					// pointer to pthread specific data
     void *heapData;					// thread-local storage for per-thread heaps
+    long int heapSampleBytes;				// bytes allocated until next heap-profile sample
+    unsigned int lockSampleCount;			// lock acquisitions until next contention sample
+    bool lockWaited;					// sampled monitor entry blocked
+    const void *lockHeld;				// lock whose hold is being timed, NULL => none
+    void *lockEntry;					// contention entry of lockHeld
+    unsigned long long int lockStart;			// time lockHeld acquired
+    unsigned long long int lockSignalled;		// sampled condition wait: 1 => owner lock free at signal, else time queued
+    unsigned long long int cpuTime;			// nanoseconds run, updated by the processor kernel
+    unsigned long long int perfCounts[uPerfCountersEvents::NoOfCounters]; // event counts while running, indexed by uPerfCounters::Counter
+#ifdef __U_STATISTICS__
+    unsigned long long int readyTime;			// time made ready, 0 => never
+#endif // __U_STATISTICS__
 
     void uYieldNoPoll();
     void uYieldYield( unsigned int times );		// inserted by translator for -yield
@@ -2369,7 +2428,7 @@ namespace UPP {
     class uNBIO {					// monitor (private mutex member)
 #endif
 	friend class ::uCluster;			// access: NBIO
-	friend _Coroutine uProcessorKernel;		// access: okToSelect, IOPoller
+	friend _Coroutine uProcessorKernel;		// access: okToSelect, IOPoller, pending, poll
 	friend class uSelectTimeoutHndlr;		// access: NBIOnode
 	friend class uKernelBoot;			// access: uNBIO
 
@@ -2380,6 +2439,9 @@ namespace UPP {
 	    enum { singleFd, multipleFds } fdType;
 	    bool timedout;				// has timeout
 	    bool *nbioTimeout;				// timeout in NBIO
+#ifdef __U_STATISTICS__
+	    unsigned long long int completed;		// time I/O completed, 0 => not woken by I/O
+#endif // __U_STATISTICS__
 	    union {
 		struct {				// used if waiting for only one fd
 		    uIOClosure *closure;
@@ -2418,25 +2480,47 @@ namespace UPP {
 	unsigned int mmaxFD;				// highest FD used in multiple master mask
 	int descriptors;				// declared here so uniprocessor kernel can check if I/O occurred
 	uBaseTask *IOPoller;				// pointer to current IO poller task, or 0
-	unsigned int pending;
-	uPid_t IOPollerPid;				// processor where IOPoller select blocks
+	volatile unsigned int pending;
+	volatile uPid_t IOPollerPid;			// processor where IOPoller select blocks
 	bool selectBlock;				// true => select blocks rather than poll
 	bool timeoutOccurred;				// set when a waiting task times out
-#if ! defined( __U_MULTI__ )
+#if defined( __U_MULTI__ )
+	// The processor kernels poll on behalf of the waiting tasks, so the master masks are protected by spin locks
+	// rather than monitor mutual exclusion, as the kernel cannot block on a monitor entry.
+
+	enum { PollInterval = 64 };			// dispatches between polls on a busy processor
+	uSpinLock lock;					// protect master masks, pending lists and counters
+	uSpinLock pollLock;				// held by the processor kernel currently polling
+	volatile unsigned int registrations;		// generation counter, detects I/O registered while blocking
+#else
 	bool okToSelect;				// uniprocessor flag indicating blocking select
-#endif // ! __U_MULTI__
+#endif // __U_MULTI__
 
+#if defined( __U_MULTI__ )
+	void checkIOStart();
+	int poll( bool block );
+#else
 	_Mutex void checkIOStart();
 	bool pollIO( NBIOnode &node );
+#endif // __U_MULTI__
 	void performIO( int fd, NBIOnode *p, uSequence<NBIOnode> &pendingIO, int cnt );
 	void checkSfds( int fd, NBIOnode *p, uSequence<NBIOnode> &pendingIO );
+	void wakeIO( int terrno );
+#if ! defined( __U_MULTI__ )
 	void unblockFD( uSequence<NBIOnode> &pendingIO );
 	_Mutex bool checkIOEnd( NBIOnode &node, int terrno );
 	bool checkPoller();
+#endif // ! __U_MULTI__
+	void ioWakeup( NBIOnode &node );
 	void waitOrPoll( NBIOnode &node, uEventNode *timeoutEvent = NULL );
 	void waitOrPoll( unsigned int nfds, NBIOnode &node, uEventNode *timeoutEvent = NULL );
+#if defined( __U_MULTI__ )
+	void initSfd( NBIOnode &node, uEventNode *timeoutEvent = NULL );
+	void initMfds( unsigned int nfds, NBIOnode &node, uEventNode *timeoutEvent = NULL );
+#else
 	_Mutex bool initSfd( NBIOnode &node, uEventNode *timeoutEvent = NULL );
 	_Mutex bool initMfds( unsigned int nfds, NBIOnode &node, uEventNode *timeoutEvent = NULL );
+#endif // __U_MULTI__
 	int select( sigset_t * );
 	int select( uIOClosure &closure, int &rwe, timeval *timeout = NULL );
 	int select( int nfds, fd_set *rfds, fd_set *wfds, fd_set *efds, timeval *timeout = NULL );
@@ -2528,15 +2612,18 @@ inline void uBaseTask::uYieldNoPoll() {
 class uProcessor {
     friend class UPP::uKernelBoot;			// access: new, uProcessor, events, contextEvent, contextSwitchHandler, setContextSwitchEvent
     friend class uKernelModule;				// access: events
-    friend class uCluster;				// access: pid, idleRef, external, processorRef, setContextSwitchEvent
-    friend _Coroutine UPP::uProcessorKernel;		// access: events, currCluster, procTask, external, globalRef, setContextSwitchEvent
+    friend class uCluster;				// access: pid, idleRef, external, processorRef, setContextSwitchEvent, cpuTime, schedHistograms
+    friend _Coroutine UPP::uProcessorKernel;		// access: events, currCluster, procTask, external, globalRef, setContextSwitchEvent, dispatchTime, cpuTime, schedHistograms
     friend _Task uProcessorTask;			// access: pid, processorClock, preemption, currCluster, setContextSwitchEvent
-    friend class UPP::uNBIO;				// access: setContextSwitchEvent
+    friend class UPP::uNBIO;				// access: setContextSwitchEvent, schedHistograms
     friend class uEventList;				// access: events, contextSwitchHandler
     friend class uEventNode;                            // access: events
     friend class uEventListPop;                         // access: contextSwitchHandler
     friend void *uKernelModule::startThread( void *p ); // acesss: everything
     friend class UPP::uMachContext;			// access: procTask
+    friend class uTracer;				// access: traceRing
+    friend class uBaseTask;				// access: dispatchTime
+    friend class uPerfCounters;				// access: perfGroup
 #if defined( __i386__ ) || defined( __ia64__ ) && ! defined( __old_perfmon__ )
     friend class HWCounters;				// access: uPerfctrContext (i386) or uPerfmon_fd (ia64)
 #endif
@@ -2587,6 +2674,8 @@ class uProcessor {
     uClock *processorClock;				// clock bound to processor
 
     uPid_t pid;
+    static unsigned int ordinals;			// processors created
+    unsigned int ordinal;				// creation order, dense unlike the processor address
 #if defined( __U_AFFINITY__ ) && defined( __solaris__ )
     cpu_set_t cpuId;
 #endif // __U_AFFINITY__
@@ -2606,6 +2695,14 @@ class uProcessor {
     uProcessorDL processorRef;				// double link field: list of processors on a cluster
     uProcessorDL globalRef;				// double link field: list of all processors
 
+    uTraceRing *traceRing;				// event trace buffer, NULL => none yet
+    unsigned long long int dispatchTime;		// uClock::monotonic when running task started
+    unsigned long long int cpuTime;			// nanoseconds run on currCluster, not yet added to the cluster's cpuTime
+    uPerfGroup *perfGroup;				// perf events of kernel thread, NULL => none yet
+#ifdef __U_STATISTICS__
+    uHistogram *schedHistograms;			// indexed by uCluster::SchedHistogram, recorded only on this processor
+#endif // __U_STATISTICS__
+
     void createProcessor( uCluster &cluster, bool detached, int ms, int spin );
     void fork( uProcessor *processor );
     void setContextSwitchEvent( int msecs );		// set the real-time timer
@@ -2627,6 +2724,10 @@ class uProcessor {
 	return pid;
     } // uProcessor::getPid
 
+    unsigned int getOrdinal() const {
+	return ordinal;
+    } // uProcessor::getOrdinal
+
     uCluster &setCluster( uCluster &cluster );
 
     uCluster &getCluster() const {
@@ -2706,14 +2807,18 @@ class uCluster {
     friend class uEventListPop;				// access: processorsOnCluster
     friend class UPP::uNBIO::uSelectTimeoutHndlr;	// access: NBIO, wakeProcessor
     friend class UPP::uKernelBoot;			// access: new, NBIO, taskAdd, taskRemove
-    friend _Coroutine UPP::uProcessorKernel;		// access: NBIO, readyQueueTryRemove, readyQueueEmpty, tasksOnCluster, makeProcessorActive, processorPause
+    friend _Coroutine UPP::uProcessorKernel;		// access: NBIO, readyQueueTryRemove, readyQueueEmpty, tasksOnCluster, makeProcessorActive, processorPause, cpuTime
     friend _Task uProcessorTask;			// access: processorAdd, processorRemove
     friend class uProcessor;				// access: processorAdd, processorRemove
     friend class uRealTimeBaseTask;			// access: taskReschedule
     friend class uPeriodicBaseTask;			// access: taskReschedule
     friend class uSporadicBaseTask;			// access: taskReschedule
     friend class uIOClosure;				// access: select
+#ifdef __U_STATISTICS__
+    friend void UPP::Statistics::print();		// access: processorsOnClusterLock, mergeSchedHistogram
+#endif // __U_STATISTICS__
     friend class uRWLock;				// access: makeTaskReady
+    friend class UPP::uHeapManager;			// access: heapArena
 
     // must be first field for alignment
     uSpinLock readyIdleTaskLock;			// protect readyQueue, idleProcessors and tasksOnCluster
@@ -2764,10 +2869,20 @@ class uCluster {
 #endif // ! __U_MULTI__
     UPP::uNBIO *NBIO;					// non-blocking I/O facilities
 
+    UPP::uHeapManager *heapArena;			// private heap arena, NULL => shared heap
+
     // profiling : necessary for compatibility between non-profiling and profiling
 
     mutable uProfileClusterSampler *profileClusterSamplerInstance; // pointer to related profiling object
 
+    volatile unsigned long long int cpuTime;		// nanoseconds run by processors that have left the cluster
+
+#ifdef __U_STATISTICS__
+    uHistogram *schedHistograms;			// indexed by SchedHistogram, from processors that have left the cluster
+
+    void mergeSchedHistogram( unsigned int which, uHistogram &histogram ) const; // processorsOnClusterLock held
+#endif // __U_STATISTICS__
+
     static void wakeProcessor( uPid_t pid );
     void processorPause();
     void makeProcessorIdle( uProcessor &processor );
@@ -2849,6 +2964,26 @@ class uCluster {
 	return processorsOnCluster;
     } // uCluster::getProcessorsOnCluster
 
+    void privateHeap();					// allocate from a heap arena private to this cluster
+
+    bool hasPrivateHeap() const {
+	return heapArena != NULL;
+    } // uCluster::hasPrivateHeap
+
+    size_t getHeapStorage() const;			// bucket storage allocated from the private heap and not freed
+
+    uDuration getCPUTime() const;			// time tasks have run on the cluster, excluding current runs
+
+#ifdef __U_STATISTICS__
+    // Nanoseconds tasks wait on the ready queue until run, run until they block or yield, and wait from the I/O they
+    // are waiting for completing until run.
+
+    enum SchedHistogram { ReadyWait, RunLength, IOWakeup, NoOfSchedHistograms };
+
+    void getSchedHistogram( SchedHistogram which, uHistogram &histogram ) const; // merge into histogram, include uHistogram.h
+    void resetSchedHistograms();
+#endif // __U_STATISTICS__
+
     void *operator new( size_t size ) {
 	return ::memalign( 128, size );			// size of cache line to prevent false sharing
     } // uCluster::operator new
@@ -0,0 +1,363 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// uCPUProfiler.cc -- statistical CPU profiler
+//
+// Author           : agent
+// Created On       : Mon Oct 19 01:46:46 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 02:44:10 2026
+// Update Count     : 3
+//
+// This  library is free  software; you  can redistribute  it and/or  modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software  Foundation; either  version 2.1 of  the License, or  (at your
+// option) any later version.
+//
+// This library is distributed in the  hope that it will be useful, but WITHOUT
+// ANY  WARRANTY;  without even  the  implied  warranty  of MERCHANTABILITY  or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+//
+// You should  have received a  copy of the  GNU Lesser General  Public License
+// along  with this library.
+//
+
+#define __U_KERNEL__
+#include <uC++.h>
+#include <uCPUProfiler.h>
+#include "uInstrument.h"
+//#include <uDebug.h>
+
+#include <climits>					// PATH_MAX
+#include <cstdio>					// snprintf
+#include <cstring>
+#include <cxxabi.h>					// __cxa_demangle
+#include <dlfcn.h>					// dladdr
+#include <fcntl.h>					// open
+#include <unistd.h>					// read, close
+#if defined( __linux__ )
+#include <sys/syscall.h>				// SYS_gettid
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif // ! sigev_notify_thread_id
+#endif // __linux__
+
+using namespace UPP;
+
+uSpinLock uCPUProfiler::lock;
+uCPUProfiler::Timer uCPUProfiler::timers[MaxProcessors];
+uCPUProfiler::Stack *uCPUProfiler::stacks = NULL;
+const char *uCPUProfiler::fileName = NULL;
+uCPUProfiler::Format uCPUProfiler::format = uCPUProfiler::Folded;
+unsigned int uCPUProfiler::frequency = 0;
+volatile bool uCPUProfiler::active = false;
+unsigned long long int uCPUProfiler::samples = 0;
+unsigned long long int uCPUProfiler::dropped = 0;
+
+enum { Empty, Filling, Ready };				// Stack states
+
+// Walk the frame-pointer chain from the interrupted frame, recording return addresses after the interrupted PC. Unlike
+// _Unwind_Backtrace, which may allocate and take locks, the walk only reads the stack, and each frame is checked to lie
+// inside the interrupted stack and above the previous frame, so a corrupt or missing chain ends the walk rather than
+// faulting. Code compiled without frame pointers (-fomit-frame-pointer) yields truncated stacks.
+
+static unsigned int walkFrames( void **pcs, unsigned int depth, unsigned int max, void *fp, void *limit, void *base ) {
+    uintptr_t frame = (uintptr_t)fp, low = (uintptr_t)limit, high = (uintptr_t)base;
+
+    while ( depth < max ) {
+      if ( frame < low || frame > high - 2 * sizeof(void *) || frame % sizeof(void *) != 0 ) break; // outside stack ?
+	void **f = (void **)frame;			// f[0] caller frame pointer, f[1] return address
+      if ( f[1] == NULL ) break;			// outermost frame
+	pcs[depth] = f[1];
+	depth += 1;
+      if ( (uintptr_t)f[0] <= frame ) break;		// frames must move towards the stack base
+	frame = (uintptr_t)f[0];
+    } // while
+    return depth;
+} // walkFrames
+
+
+void uCPUProfiler::arm( timer_t timer, unsigned int frequency ) {
+#if defined( __linux__ )
+    struct itimerspec period;
+    period.it_interval.tv_sec = 0;
+    period.it_interval.tv_nsec = frequency == 0 ? 0 : 1000000000L / frequency;
+    period.it_value = period.it_interval;		// 0 => disarm
+    timer_settime( timer, 0, &period, NULL );
+#endif // __linux__
+} // uCPUProfiler::arm
+
+
+// Called by each processor on its own kernel thread, so the timer measures and interrupts that thread. The timer is
+// created disarmed whether or not profiling is on, so profiling can start after the processor.
+
+void uCPUProfiler::registerProcessor( uProcessor &processor ) {
+#if defined( __linux__ )
+    struct sigevent event;
+    memset( &event, 0, sizeof(event) );
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_signo = SIGPROF;
+    event.sigev_notify_thread_id = syscall( SYS_gettid );
+    timer_t timer;
+  if ( timer_create( CLOCK_THREAD_CPUTIME_ID, &event, &timer ) == -1 ) return; // processor not sampled
+
+    lock.acquire();
+    for ( unsigned int i = 0; i < MaxProcessors; i += 1 ) {
+	if ( timers[i].processor == NULL ) {
+	    timers[i].processor = &processor;
+	    timers[i].timer = timer;
+	    if ( active ) arm( timer, frequency );
+	    lock.release();
+	    return;
+	} // if
+    } // for
+    lock.release();
+    timer_delete( timer );				// table full, processor not sampled
+#endif // __linux__
+} // uCPUProfiler::registerProcessor
+
+
+void uCPUProfiler::deregisterProcessor( uProcessor &processor ) {
+#if defined( __linux__ )
+    lock.acquire();
+    for ( unsigned int i = 0; i < MaxProcessors; i += 1 ) {
+	if ( timers[i].processor == &processor ) {
+	    timer_delete( timers[i].timer );
+	    timers[i].processor = NULL;
+	    break;
+	} // if
+    } // for
+    lock.release();
+#endif // __linux__
+} // uCPUProfiler::deregisterProcessor
+
+
+// Called from the signal handler on any processor: a slot is claimed with compare-and-swap and filled before it is
+// marked ready, so no lock is needed. A handler finding a slot being filled waits for the other processor to finish.
+
+void uCPUProfiler::record( const char *task, const char *cluster, const char *mutex, void **pcs, unsigned int depth ) {
+    size_t hash = 0xcbf29ce484222325ULL & (size_t)-1;	// FNV-1a
+    hash = ( hash ^ (uintptr_t)task ) * (size_t)0x100000001b3ULL;
+    hash = ( hash ^ (uintptr_t)cluster ) * (size_t)0x100000001b3ULL;
+    hash = ( hash ^ (uintptr_t)mutex ) * (size_t)0x100000001b3ULL;
+    for ( unsigned int i = 0; i < depth; i += 1 ) {
+	hash = ( hash ^ (uintptr_t)pcs[i] ) * (size_t)0x100000001b3ULL;
+    } // for
+
+    for ( size_t i = hash & (StackTableSize - 1), probe = 0; probe < StackTableSize; probe += 1, i = (i + 1) & (StackTableSize - 1) ) {
+	Stack &s = stacks[i];
+	if ( s.state == Empty && uCompareAssign( s.state, (int)Empty, (int)Filling ) ) { // new stack ?
+	    s.hash = hash;
+	    s.task = task;
+	    s.cluster = cluster;
+	    s.mutex = mutex;
+	    s.depth = depth;
+	    memcpy( s.pcs, pcs, depth * sizeof(void *) );
+	    uInstrument::copyName( s.taskName, task, NameSize );
+	    uInstrument::copyName( s.clusterName, cluster, NameSize );
+	    uInstrument::copyName( s.mutexName, mutex, NameSize );
+	    s.count = 1;
+	    __sync_synchronize();			// stack visible before ready
+	    s.state = Ready;
+	    return;
+	} // if
+	while ( s.state == Filling ) {}			// another processor is creating this stack
+	if ( s.hash == hash && s.task == task && s.cluster == cluster && s.mutex == mutex && s.depth == depth &&
+	     memcmp( s.pcs, pcs, depth * sizeof(void *) ) == 0 ) {
+	    uFetchAdd( s.count, 1 );
+	    return;
+	} // if
+    } // for
+    uFetchAdd( dropped, 1 );				// table full
+} // uCPUProfiler::record
+
+
+void uCPUProfiler::sigProfHandler( __U_SIGPARMS__ ) {
+  if ( ! active ) return;				// signal pending after stop
+    int terrno = errno;				// preserve errno at point of interrupt
+    void *pcs[MaxDepth];
+    unsigned int depth = 1;
+    void *pc = UPP::uSigHandlerModule::signalContextPC( cxt );
+    const char *task, *cluster, *mutex = NULL;
+
+    pcs[0] = pc;
+    if ( THREAD_GETMEM( RFinprogress ) ||		// roll forward in progress ?
+	 THREAD_GETMEM( disableInt ) ||			// inside kernel ?
+	 THREAD_GETMEM( disableIntSpin ) ) {		// spinlock acquired ?
+	// The task and cluster may be changing and the stack may be part way through a context switch, so only the
+	// interrupted PC is recorded.
+	task = cluster = "(kernel)";
+    } else {
+	uBaseTask &t = uThisTask();
+	task = t.getName();
+	cluster = uThisCluster().getName();
+	mutex = t.getSerial().typeName;			// monitor or task whose member is executing
+	uBaseCoroutine &c = uThisCoroutine();		// interrupted stack
+	if ( c.limit != NULL && c.base != NULL ) {	// otherwise only the interrupted PC
+	    depth = walkFrames( pcs, 1, MaxDepth, UPP::uSigHandlerModule::signalContextFP( cxt ), c.limit, c.base );
+	} // if
+    } // if
+    uFetchAdd( samples, 1 );
+    record( task, cluster, mutex, pcs, depth );
+    errno = terrno;
+} // uCPUProfiler::sigProfHandler
+
+
+// Folded stacks: attribution frames then call frames from outermost to innermost, followed by the sample count.
+
+int uCPUProfiler::writeFolded( int fd ) {
+    enum { BufferSize = 8192 };
+    char *buffer = new char[BufferSize];
+    int rc = 0;
+
+    for ( unsigned int i = 0; i < StackTableSize && rc == 0; i += 1 ) {
+	Stack &s = stacks[i];
+      if ( s.state != Ready ) continue;
+	int len = snprintf( buffer, BufferSize, "%s;%s", s.clusterName, s.taskName );
+	if ( s.mutex != NULL ) len += snprintf( buffer + len, BufferSize - len, ";%s", s.mutexName );
+	for ( int d = s.depth - 1; d >= 0 && len < BufferSize - 64; d -= 1 ) {
+	    // A return address may be the first instruction after the call's routine, so look up the call.
+	    void *pc = d == 0 ? s.pcs[d] : (char *)s.pcs[d] - 1;
+	    Dl_info info;
+	    if ( dladdr( pc, &info ) == 0 ) info.dli_fname = info.dli_sname = NULL;
+	    if ( info.dli_sname != NULL ) {
+		int status;
+		char *name = abi::__cxa_demangle( info.dli_sname, NULL, NULL, &status );
+		len += snprintf( buffer + len, BufferSize - len - 32, ";%s", status == 0 ? name : info.dli_sname );
+		free( name );
+	    } else if ( info.dli_fname != NULL ) {	// unknown routine in a known object
+		const char *base = strrchr( info.dli_fname, '/' );
+		len += snprintf( buffer + len, BufferSize - len - 32, ";%s+0x%lx", base == NULL ? info.dli_fname : base + 1,
+				 (unsigned long int)( (char *)s.pcs[d] - (char *)info.dli_fbase ) );
+	    } else {
+		len += snprintf( buffer + len, BufferSize - len - 32, ";0x%lx", (unsigned long int)(uintptr_t)s.pcs[d] );
+	    } // if
+	    if ( len > BufferSize - 64 ) len = BufferSize - 64; // truncated
+	} // for
+	len += snprintf( buffer + len, BufferSize - len, " %llu\n", s.count );
+	rc |= uInstrument::writeAll( fd, buffer, len );
+    } // for
+    delete [] buffer;
+    return rc;
+} // uCPUProfiler::writeFolded
+
+
+// pprof legacy CPU profile: header, one record per stack (count, depth, PCs), trailer, then the process mappings so pprof
+// can symbolize shared objects and position-independent executables.
+
+int uCPUProfiler::writePprof( int fd ) {
+    uintptr_t words[MaxDepth + 2];
+    int rc = 0;
+
+    words[0] = 0;					// header
+    words[1] = 3;
+    words[2] = 0;
+    words[3] = 1000000 / frequency;			// sampling period, microseconds
+    words[4] = 0;
+    rc |= uInstrument::writeAll( fd, (char *)words, 5 * sizeof(uintptr_t) );
+    for ( unsigned int i = 0; i < StackTableSize && rc == 0; i += 1 ) {
+	Stack &s = stacks[i];
+      if ( s.state != Ready ) continue;
+	words[0] = s.count;
+	words[1] = s.depth;
+	for ( unsigned int d = 0; d < s.depth; d += 1 ) words[d + 2] = (uintptr_t)s.pcs[d];
+	rc |= uInstrument::writeAll( fd, (char *)words, ( s.depth + 2 ) * sizeof(uintptr_t) );
+    } // for
+    words[0] = 0;					// trailer
+    words[1] = 1;
+    words[2] = 0;
+    rc |= uInstrument::writeAll( fd, (char *)words, 3 * sizeof(uintptr_t) );
+
+    char buffer[1024];
+    int maps = open( "/proc/self/maps", O_RDONLY ), len;
+    if ( maps != -1 ) {
+	while ( rc == 0 && ( len = ::read( maps, buffer, sizeof(buffer) ) ) > 0 ) {
+	    rc |= uInstrument::writeAll( fd, buffer, len );
+	} // while
+	close( maps );
+    } // if
+    return rc;
+} // uCPUProfiler::writePprof
+
+
+bool uCPUProfiler::start( const char *file, unsigned int frequency, Format format ) {
+#if defined( __linux__ )
+  if ( file == NULL || frequency == 0 || frequency > 10000 ) return true;
+    UPP::uSigHandlerModule::signal( SIGPROF, sigProfHandler, SA_SIGINFO | SA_RESTART );
+
+    lock.acquire();
+    if ( active ) {					// already profiling ?
+	lock.release();
+	return true;
+    } // if
+    if ( stacks == NULL ) {				// first start ?
+	stacks = (Stack *)uInstrument::table( StackTableSize * sizeof(Stack) ); // used inside the signal handler
+	if ( stacks == NULL ) {
+	    lock.release();
+	    return true;
+	} // if
+    } else {
+	memset( stacks, 0, StackTableSize * sizeof(Stack) ); // discard previous profile
+    } // if
+    fileName = strdup( file );
+    uCPUProfiler::frequency = frequency;
+    uCPUProfiler::format = format;
+    samples = dropped = 0;
+    active = true;
+    for ( unsigned int i = 0; i < MaxProcessors; i += 1 ) {
+	if ( timers[i].processor != NULL ) arm( timers[i].timer, frequency );
+    } // for
+    lock.release();
+    return false;
+#else
+    return true;					// no per-thread CPU timers
+#endif // __linux__
+} // uCPUProfiler::start
+
+
+bool uCPUProfiler::stop() {
+    lock.acquire();
+    if ( ! active ) {
+	lock.release();
+	return true;
+    } // if
+    active = false;
+    for ( unsigned int i = 0; i < MaxProcessors; i += 1 ) {
+	if ( timers[i].processor != NULL ) arm( timers[i].timer, 0 );
+    } // for
+    lock.release();
+
+    int rc = uInstrument::writeFile( fileName, format == Pprof ? writePprof : writeFolded );
+    free( (void *)fileName );
+    fileName = NULL;
+    return rc != 0;
+} // uCPUProfiler::stop
+
+
+// UPROFILE=file[,frequency] profiles the program from boot to shutdown.
+
+void uCPUProfiler::startup() {
+    char file[PATH_MAX];
+    unsigned int frequency = 100;
+    const char *value = uInstrument::option( "UPROFILE", file, sizeof(file), &frequency );
+  if ( value == NULL ) return;
+    size_t len = strlen( file );
+    Format format = len > 5 && strcmp( file + len - 5, ".prof" ) == 0 ? Pprof : Folded;
+
+    if ( start( file, frequency, format ) ) {
+	uAbort( "UPROFILE=%s : profiling unavailable or frequency not in range 1-10000.", value );
+    } // if
+} // uCPUProfiler::startup
+
+
+void uCPUProfiler::finishup() {
+    if ( active ) stop();				// write profile not stopped by program
+} // uCPUProfiler::finishup
+
+
+// Local Variables: //
+// compile-command: "make install" //
+// End: //
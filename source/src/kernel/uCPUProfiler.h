@@ -0,0 +1,102 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// uCPUProfiler.h -- statistical CPU profiler
+//
+// Author           : agent
+// Created On       : Mon Oct 19 01:46:46 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 02:38:18 2026
+// Update Count     : 2
+//
+// This  library is free  software; you  can redistribute  it and/or  modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software  Foundation; either  version 2.1 of  the License, or  (at your
+// option) any later version.
+//
+// This library is distributed in the  hope that it will be useful, but WITHOUT
+// ANY  WARRANTY;  without even  the  implied  warranty  of MERCHANTABILITY  or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+//
+// You should  have received a  copy of the  GNU Lesser General  Public License
+// along  with this library.
+//
+
+
+#ifndef __U_CPUPROFILER_H__
+#define __U_CPUPROFILER_H__
+
+
+// Each processor (kernel thread) has a timer on its own CPU clock that delivers SIGPROF to that thread, so samples are
+// proportional to the CPU used by each processor and an idle (blocked) processor takes none. A sample records the call
+// stack of the interrupted user task with the task's name, its cluster, and the type of the mutex object (monitor or
+// task) whose member it is executing; samples taken inside the runtime kernel are attributed to "(kernel)". Samples are
+// aggregated in a table without locks, so the signal handler never blocks.
+//
+// The profile is written when profiling stops, either in folded-stack format (one "cluster;task;mutex;frame;... count"
+// line per stack, for flame-graph tools) or in the pprof legacy CPU format, which carries stacks but not the
+// task/cluster/mutex attribution. Folded stacks are symbolized with dladdr, so link with -rdynamic to see the names of
+// routines in the executable. Stacks are followed through frame pointers, so compile with -fno-omit-frame-pointer for
+// complete stacks. Setting the environment variable UPROFILE=file[,frequency] profiles the whole program; a file name
+// ending in ".prof" selects the pprof format.
+
+class uCPUProfiler {
+    friend _Task uProcessorTask;			// access: registerProcessor, deregisterProcessor
+    friend class UPP::uKernelBoot;			// access: startup, finishup
+  public:
+    enum Format { Folded, Pprof };
+  private:
+    enum { MaxDepth = 32,				// maximum stack frames per sample
+	   NameSize = 32,				// characters of names kept
+	   StackTableSize = 8192,			// power of 2
+	   MaxProcessors = 1024,
+    };
+
+    struct Stack {
+	volatile int state;				// Empty, Filling, Ready
+	size_t hash;
+	const char *task, *cluster, *mutex;		// attribution, by name address
+	unsigned int depth;
+	void *pcs[MaxDepth];
+	volatile unsigned long long int count;
+	char taskName[NameSize], clusterName[NameSize], mutexName[NameSize]; // copies, names may not outlive the profile
+    }; // Stack
+
+    struct Timer {
+	uProcessor *processor;				// NULL => free
+	timer_t timer;
+    }; // Timer
+
+    static uSpinLock lock;				// protects timers and start/stop
+    static Timer timers[MaxProcessors];
+    static Stack *stacks;				// hash table of sampled stacks
+    static const char *fileName;
+    static Format format;
+    static unsigned int frequency;
+    static volatile bool active;
+    static unsigned long long int samples, dropped;
+
+    static void arm( timer_t timer, unsigned int frequency );
+    static void registerProcessor( uProcessor &processor );
+    static void deregisterProcessor( uProcessor &processor );
+    static void record( const char *task, const char *cluster, const char *mutex, void **pcs, unsigned int depth );
+    static void sigProfHandler( __U_SIGPARMS__ );
+    static int writeFolded( int fd );
+    static int writePprof( int fd );
+    static void startup();
+    static void finishup();
+  public:
+    static bool start( const char *file, unsigned int frequency = 100, Format format = Folded ); // true => failure
+    static bool stop();					// write profile, true => failure
+    static bool profiling() { return active; }
+}; // uCPUProfiler
+
+
+#endif // __U_CPUPROFILER_H__
+
+
+// Local Variables: //
+// compile-command: "make install" //
+// End: //
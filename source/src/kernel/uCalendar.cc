@@ -30,6 +30,12 @@
 //#include <uDebug.h>
 
 #include <ostream>
+#include <cstring>					// strcmp, strncmp
+#include <fcntl.h>					// open
+#include <unistd.h>					// read, close
+#if defined( __i386__ ) || defined( __x86_64__ )
+#include <cpuid.h>					// __get_cpuid
+#endif // __i386__ || __x86_64__
 
 
 //######################### uDuration #########################
@@ -98,6 +104,168 @@ void uTime::uCreateTime( int year, int month, int day, int hour, int min, int se
 //######################### uClock #########################
 
 
+// Real time is computed from the time-stamp counter when it is invariant (constant rate, runs in idle states) and the
+// operating system also uses it, avoiding a system call or vDSO work on every timed wait, accept timeout and timer
+// re-arm. Time is realBase + ( rdtsc - tscBase ) * tscMult >> Shift, where tscMult (nanoseconds per tick << Shift) is
+// measured against CLOCK_MONOTONIC, so wall-clock steps do not change the rate, and realBase is CLOCK_REALTIME at the
+// last refresh. Refreshing corrects drift and picks up wall-clock steps; it may step the time by the accumulated error,
+// normally nanoseconds. The first rate is measured over 10 ms, so refreshes start 8 times that interval apart and
+// lengthen to once a second as the rate becomes more accurate. The parameters are published with a sequence lock, and a
+// reader that races a refresh, or reads before the first rate is known, uses the system clock, so no reader ever waits
+// (time is read in the SIGALRM handler).
+//
+// UCLOCKSOURCE=system turns off the TSC; UCLOCKSOURCE=tsc uses an invariant TSC even when the operating system does not
+// (e.g., some virtual machines), which is only correct if the counters on all CPUs are synchronized.
+
+enum { TSCOff, TSCCalibrating, TSCOn };
+enum { Shift = 32 };
+static const long long int FirstCalibration = 10000000LL, RefreshPeriod = 1000000000LL; // nanoseconds
+
+static volatile int tscMode = TSCOff;
+static volatile unsigned int tscSeq = 0;		// odd => refresh in progress
+static unsigned long long int tscBase, tscMult, tscPeriod; // tscPeriod is ticks until next refresh
+static long long int realBase, monoBase;
+
+
+static inline long long int sysTime( clockid_t type ) {
+    timespec ts;
+    clock_gettime( type, &ts );				// vdso, no system call
+    return (long long int)ts.tv_sec * TIMEGRAN + ts.tv_nsec;
+} // sysTime
+
+
+static inline uTime sysNow() {
+#if defined( REALTIME_POSIX )
+    timespec curr;
+    clock_gettime( CLOCK_REALTIME, &curr );
+    return uTime( curr.tv_sec, curr.tv_nsec );
+#else
+    timeval curr;
+    GETTIMEOFDAY( &curr );
+    return uTime( curr.tv_sec, curr.tv_usec * 1000 );	// convert to nanoseconds
+#endif // REALTIME_POSIX
+} // sysNow
+
+
+#if defined( __i386__ ) || defined( __x86_64__ )
+// Integer arithmetic only, as it may run in a signal handler. Only one refresh at a time; a task losing the race
+// carries on with the system clock.
+
+static void tscRefresh() {
+    unsigned int seq = tscSeq;
+  if ( ( seq & 1 ) != 0 || ! uCompareAssign( tscSeq, seq, seq + 1 ) ) return; // refresh in progress ?
+
+    long long int mono = sysTime( CLOCK_MONOTONIC );
+    unsigned long long int tsc = uRdtsc();
+    long long int real = sysTime( CLOCK_REALTIME );
+
+    unsigned long long int dmono = mono - monoBase, dtsc = tsc - tscBase;
+    unsigned long long int next = dmono < RefreshPeriod / 8 ? dmono * 8 : RefreshPeriod; // short interval => sooner
+    while ( dmono >= ( 1ULL << ( 64 - Shift ) ) ) {	// long interval, prevent overflow
+	dmono >>= 1;
+	dtsc >>= 1;
+    } // while
+    unsigned long long int mult = dtsc == 0 ? 0 : ( dmono << Shift ) / dtsc;
+    if ( mult != 0 ) {					// otherwise keep previous rate
+	tscMult = mult;
+	tscPeriod = ( next << Shift ) / mult;
+    } // if
+    tscBase = tsc;
+    realBase = real;
+    monoBase = mono;
+    if ( tscMult != 0 ) tscMode = TSCOn;
+    __sync_synchronize();				// parameters visible before release
+    tscSeq = seq + 2;
+} // tscRefresh
+#endif // __i386__ || __x86_64__
+
+
+void uClock::startup() {
+#if defined( __i386__ ) || defined( __x86_64__ )
+    const char *value = getenv( "UCLOCKSOURCE" );
+    bool force = false;
+    if ( value != NULL && *value != '\0' ) {
+	if ( strcmp( value, "tsc" ) == 0 ) {
+	    force = true;
+	} else if ( strcmp( value, "system" ) == 0 ) {
+	    return;
+	} else {
+	    uAbort( "UCLOCKSOURCE=%s : clock source must be \"tsc\" or \"system\".", value );
+	} // if
+    } // if
+
+    unsigned int eax, ebx, ecx, edx;
+  if ( __get_cpuid( 0x80000007, &eax, &ebx, &ecx, &edx ) == 0 || ( edx & ( 1 << 8 ) ) == 0 ) return; // not invariant ?
+#if defined( __linux__ )
+    if ( ! force ) {					// kernel clock source is TSC => counters synchronized across CPUs
+	char source[32];
+	int len = -1;
+	int fd = open( "/sys/devices/system/clocksource/clocksource0/current_clocksource", O_RDONLY );
+	if ( fd != -1 ) {
+	    len = read( fd, source, sizeof(source) - 1 );
+	    close( fd );
+	} // if
+      if ( len < 3 || strncmp( source, "tsc", 3 ) != 0 ) return;
+    } // if
+#endif // __linux__
+
+    monoBase = sysTime( CLOCK_MONOTONIC );		// start of first calibration interval
+    tscBase = uRdtsc();
+    tscMode = TSCCalibrating;
+#endif // __i386__ || __x86_64__
+} // uClock::startup
+
+
+// Time from the TSC, from realBase (real time) or monoBase (monotonic time). false => use the system clock.
+
+static inline bool tscTime( bool monotonic, long long int &time ) {
+#if defined( __i386__ ) || defined( __x86_64__ )
+    if ( __builtin_expect( tscMode == TSCOn, 1 ) ) {
+	unsigned int seq = tscSeq;
+	__atomic_thread_fence( __ATOMIC_ACQUIRE );
+	long long int delta = uRdtsc() - tscBase;
+	unsigned long long int mult = tscMult, period = tscPeriod;
+	long long int base = monotonic ? monoBase : realBase;
+	__atomic_thread_fence( __ATOMIC_ACQUIRE );
+	if ( ( seq & 1 ) == 0 && seq == tscSeq ) {	// consistent parameters ?
+	    if ( delta < 0 ) delta = 0;			// counters on different CPUs slightly out of step
+	    if ( (unsigned long long int)delta < period ) {
+		time = base + (long long int)( (unsigned long long int)delta * mult >> Shift );
+		return true;
+	    } // if
+	    tscRefresh();				// period elapsed, use system clock this time
+	} // if
+    } else if ( tscMode == TSCCalibrating ) {
+	if ( sysTime( CLOCK_MONOTONIC ) - monoBase >= FirstCalibration ) tscRefresh();
+    } // if
+#endif // __i386__ || __x86_64__
+    return false;
+} // tscTime
+
+
+uTime uClock::now() {
+    uTime time;
+  if ( tscTime( false, time.tv ) ) return time;
+    return sysNow();
+} // uClock::now
+
+
+// Intervals (dispatch, CPU and wait times) are measured on the monotonic clock, which wall-clock steps do not move and
+// which keeps nanosecond resolution when the TSC is not used. Re-anchoring the TSC to CLOCK_MONOTONIC can still move a
+// reading back by its accumulated error, so callers clamp differences at zero.
+
+unsigned long long int uClock::monotonic() {
+    long long int time;
+  if ( tscTime( true, time ) ) return time;
+    return sysTime( CLOCK_MONOTONIC );
+} // uClock::monotonic
+
+
+bool uClock::usingTSC() {
+    return tscMode == TSCOn;
+} // uClock::usingTSC
+
+
 // uClock::uClock( int ) {
 //     // Use exceptions here later on, to see if clock call works
 //     //		clock_gettime( CLOCK_REALTIME, &curr );
@@ -108,29 +276,14 @@ void uTime::uCreateTime( int year, int month, int day, int hour, int min, int se
 
 
 void uClock::resetClock( uTime adj ) {
-#if defined( REALTIME_POSIX )
-    timespec curr;
-    clock_gettime( CLOCK_REALTIME, &curr );
-#else
-    timeval curr;
-    GETTIMEOFDAY( &curr );
-#endif
-    uTime currtime( curr.tv_sec, curr.tv_usec * 1000 );	// convert to nanoseconds
+    uTime currtime = now();
     clocktype = -1;
     offset.tv = currtime.tv - adj.tv;
 } // uClock::resetClock
 
 
 uTime uClock::getTime() {				// ##### REFERENCED IN TRANSLATOR #####
-#if defined( REALTIME_POSIX )
-    timespec curr;
-    if ( clocktype < 0 ) type = CLOCK_REALTIME;
-    clock_gettime( type, &curr );
-#else
-    timeval curr;
-    GETTIMEOFDAY( &curr );
-#endif
-    uTime currtime( curr.tv_sec, curr.tv_usec * 1000 );	// convert to nanoseconds
+    uTime currtime = now();
 
     if ( clocktype < 0 ) {				// using virtual clock if < 0
 	currtime.tv -= offset.tv;			// adjust the time to reflect the "virtual" time.
@@ -443,8 +443,12 @@ inline bool operator<=( uTime op1, uTime op2 ) {
 
 
 class uClock {
+    friend class UPP::uKernelBoot;			// access: startup
+
     uTime offset;					// for virtual clock: contains offset from real-time
     int clocktype;					// implementation only -1 (virtual), CLOCK_REALTIME
+
+    static void startup();
   public:
     uClock() {
 	clocktype = CLOCK_REALTIME;
@@ -464,6 +468,10 @@ class uClock {
     void getTime( int &year, int &month, int &day, int &hour, int &minutes, int &seconds, long int &nsec );
 
     static void convertTime( uTime time, int &year, int &month, int &day, int &hour, int &minutes, int &seconds, long int &nsec );
+
+    static uTime now();					// real time, from the TSC when usable
+    static unsigned long long int monotonic();	// nanoseconds for intervals, from the TSC when usable
+    static bool usingTSC();
 }; // uClock
 
 
@@ -30,6 +30,9 @@
 
 #include <uC++.h>
 #include <uIOcntl.h>
+#include <uHeapLmmm.h>
+#include <uTracer.h>
+#include <uHistogram.h>
 #ifdef __U_PROFILER__
 #include <uProfiler.h>
 #endif // __U_PROFILER__
@@ -123,7 +126,9 @@ void uCluster::processorPause() {
 	    uFetchAdd( UPP::Statistics::kernel_thread_pause, 1 );
 #endif // __U_STATISTICS__
 
+	    uTracer::event( uTracer::IdleBegin, NULL );
 	    sigsuspend( &old_mask );			// install old signal mask over new one and wait for signal to arrive
+	    uTracer::event( uTracer::IdleEnd, NULL );
 
 	    if ( sigprocmask( SIG_SETMASK, &old_mask, NULL ) == -1 ) { // new mask restored so install old signal mask over new one
 		uAbort( "internal error, sigprocmask" );
@@ -191,6 +196,10 @@ void uCluster::makeProcessorActive() {
 
 
 void uCluster::makeTaskReady( uBaseTask &readyTask ) {
+    uTracer::event( uTracer::Wake, &readyTask, NULL, 0, readyTask.getName() );
+#ifdef __U_STATISTICS__
+    readyTask.readyTime = uHistogram::now();
+#endif // __U_STATISTICS__
     readyIdleTaskLock.acquire();
     if ( &readyTask.bound != NULL ) {			// task bound to a specific processor ?
 #ifdef __U_DEBUG_H__
@@ -247,6 +256,17 @@ void uCluster::makeTaskReady( uBaseTaskSeq &newTasks, unsigned int n ) {
 	       this, uThisTask().getName(), &uThisTask() );
 #endif // __U_DEBUG_H__
 
+    if ( uTracer::tracing() ) {
+	for ( uBaseTaskDL *t = newTasks.head(); t != NULL; t = newTasks.succ( t ) ) {
+	    uTracer::event( uTracer::Wake, &t->task(), NULL, 0, t->task().getName() );
+	} // for
+    } // if
+#ifdef __U_STATISTICS__
+    unsigned long long int now = uHistogram::now();
+    for ( uBaseTaskDL *t = newTasks.head(); t != NULL; t = newTasks.succ( t ) ) {
+	t->task().readyTime = now;
+    } // for
+#endif // __U_STATISTICS__
     readyQueue->transfer( newTasks, n );		// add task(s) to end of cluster ready queue
 
 #ifdef __U_MULTI__
@@ -333,6 +353,15 @@ void uCluster::processorRemove( uProcessor &processor ) {
     processorsOnClusterLock.acquire();
     numProcessors -= 1;
     processorsOnCluster.remove( &(processor.processorRef) );
+    // Called on the processor (or after it stops), so it is not dispatching and its time can be moved to the cluster.
+    __atomic_fetch_add( &cpuTime, processor.cpuTime, __ATOMIC_RELAXED );
+    processor.cpuTime = 0;
+#ifdef __U_STATISTICS__
+    for ( unsigned int i = 0; i < NoOfSchedHistograms; i += 1 ) {
+	schedHistograms[i].merge( processor.schedHistograms[i] );
+	processor.schedHistograms[i].reset();
+    } // for
+#endif // __U_STATISTICS__
     processorsOnClusterLock.release();
 } // uCluster::processorRemove
 
@@ -383,6 +412,11 @@ void uCluster::createCluster( unsigned int stackSize, const char *name ) {
 
     numProcessors = 0;
     idleProcessorsCnt = 0;
+    heapArena = NULL;
+    cpuTime = 0;
+#ifdef __U_STATISTICS__
+    schedHistograms = new uHistogram[NoOfSchedHistograms];
+#endif // __U_STATISTICS__
 
     setName( name );
     setStackSize( stackSize );
@@ -452,6 +486,9 @@ uCluster::~uCluster() {
 #ifdef __U_MULTI__
     delete NBIO;
 #endif // __U_MULTI__
+#ifdef __U_STATISTICS__
+    delete [] schedHistograms;
+#endif // __U_STATISTICS__
 
     uProcessorDL *pr;
     for ( uSeqIter<uProcessorDL> iter(processorsOnCluster); iter >> pr; ) {
@@ -482,6 +519,10 @@ uCluster::~uCluster() {
 	delete readyQueue;
     } // if
 
+    if ( heapArena != NULL ) {				// blocks from the arena may still be in use
+	uHeapManager::arenaRelease( heapArena );
+    } // if
+
 #if __U_LOCALDEBUGGER_H__
     if ( uLocalDebugger::uLocalDebuggerActive ) uLocalDebugger::uLocalDebuggerInstance->destroyCluster( *this );
 #endif // __U_LOCALDEBUGGER_H__
@@ -492,6 +533,72 @@ uCluster::~uCluster() {
 } // uCluster::~uCluster
 
 
+#ifdef __U_STATISTICS__
+// Processors record into their own histograms, so the cluster's histogram is the sum of those of processors that have
+// left the cluster and those of its current processors.
+
+void uCluster::mergeSchedHistogram( unsigned int which, uHistogram &histogram ) const {
+    histogram.merge( schedHistograms[which] );
+    uProcessorDL *pr;
+    for ( uSeqIter<uProcessorDL> iter( processorsOnCluster ); iter >> pr; ) {
+	histogram.merge( pr->processor().schedHistograms[which] );
+    } // for
+} // uCluster::mergeSchedHistogram
+
+
+void uCluster::getSchedHistogram( SchedHistogram which, uHistogram &histogram ) const {
+    uCluster &cluster = *(uCluster *)this;		// lock is not const
+    cluster.processorsOnClusterLock.acquire();
+    mergeSchedHistogram( which, histogram );
+    cluster.processorsOnClusterLock.release();
+} // uCluster::getSchedHistogram
+
+
+void uCluster::resetSchedHistograms() {
+    processorsOnClusterLock.acquire();
+    for ( unsigned int i = 0; i < NoOfSchedHistograms; i += 1 ) schedHistograms[i].reset();
+    uProcessorDL *pr;
+    for ( uSeqIter<uProcessorDL> iter( processorsOnCluster ); iter >> pr; ) {
+	for ( unsigned int i = 0; i < NoOfSchedHistograms; i += 1 ) pr->processor().schedHistograms[i].reset();
+    } // for
+    processorsOnClusterLock.release();
+} // uCluster::resetSchedHistograms
+#endif // __U_STATISTICS__
+
+
+// Concurrent callers may each acquire an arena; only one is installed and the others are released for reuse.
+
+void uCluster::privateHeap() {
+  if ( heapArena != NULL ) return;
+    uHeapManager *arena = uHeapManager::arenaAcquire( getName() );
+    if ( ! uCompareAssign( heapArena, (uHeapManager *)NULL, arena ) ) { // another caller installed an arena ?
+	uHeapManager::arenaRelease( arena );
+    } // if
+} // uCluster::privateHeap
+
+
+size_t uCluster::getHeapStorage() const {
+    if ( heapArena == NULL ) return 0;
+    return heapArena->arenaStorage();
+} // uCluster::getHeapStorage
+
+
+// Each processor accumulates the time its tasks run on the cluster, so dispatching does not update a counter shared by
+// all the cluster's processors; the total is the time of processors that left plus that of the current processors.
+
+uDuration uCluster::getCPUTime() const {
+    uCluster &cluster = *(uCluster *)this;		// lock is not const
+    cluster.processorsOnClusterLock.acquire();
+    unsigned long long int ns = cpuTime;
+    uProcessorDL *pr;
+    for ( uSeqIter<uProcessorDL> iter( cluster.processorsOnCluster ); iter >> pr; ) {
+	ns += pr->processor().cpuTime;
+    } // for
+    cluster.processorsOnClusterLock.release();
+    return uDuration( ns / 1000000000, ns % 1000000000 );
+} // uCluster::getCPUTime
+
+
 void uCluster::taskResetPriority( uBaseTask &owner, uBaseTask &calling ) { // TEMPORARY
 #ifdef __U_DEBUG_H__
     uDebugPrt( "(uCluster &)%p.taskResetPriority, owner:%p, calling:%p, owner's cluster:%p\n", this, &owner, &calling, owner.currCluster );
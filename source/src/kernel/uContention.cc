@@ -0,0 +1,255 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// uContention.cc -- lock and monitor contention profiler
+//
+// Author           : agent
+// Created On       : Mon Oct 19 01:56:42 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 02:44:10 2026
+// Update Count     : 2
+//
+// This  library is free  software; you  can redistribute  it and/or  modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software  Foundation; either  version 2.1 of  the License, or  (at your
+// option) any later version.
+//
+// This library is distributed in the  hope that it will be useful, but WITHOUT
+// ANY  WARRANTY;  without even  the  implied  warranty  of MERCHANTABILITY  or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+//
+// You should  have received a  copy of the  GNU Lesser General  Public License
+// along  with this library.
+//
+
+#define __U_KERNEL__
+#include <uC++.h>
+#include <uContention.h>
+#include "uInstrument.h"
+//#include <uDebug.h>
+
+#include <climits>					// PATH_MAX
+#include <cstdio>					// snprintf
+#include <cstdlib>					// qsort
+#include <cstring>
+#include <cxxabi.h>					// __cxa_demangle
+#include <dlfcn.h>					// dladdr
+
+
+using namespace UPP;
+
+uSpinLock uContention::lock;
+uContention::Entry *uContention::entries = NULL;
+const char *uContention::fileName = NULL;
+unsigned int uContention::period = 0;
+volatile bool uContention::active = false;
+volatile unsigned int uContention::spinTicket = 0;
+unsigned long long int uContention::samples = 0;
+unsigned long long int uContention::dropped = 0;
+
+enum { Empty, Filling, Ready };				// Entry states
+
+static inline void add( volatile unsigned long long int &total, unsigned long long int value ) {
+    __atomic_fetch_add( &total, value, __ATOMIC_SEQ_CST ); // uFetchAdd increment is an int
+} // add
+
+
+// Waits and holds are differences of monotonic times, which can be a few nanoseconds negative (see uClock::monotonic),
+// so acquired and released clamp them at zero.
+
+unsigned long long int uContention::now() {
+    return uClock::monotonic();				// same clock as dispatch times
+} // uContention::now
+
+
+// Acquisitions until the next sample, uniform in 1 .. 2 * period - 1 so the mean is the period. The nanosecond clock
+// supplies the randomness.
+
+unsigned int uContention::interval() {
+    return 1 + now() % ( 2 * period - 1 );
+} // uContention::interval
+
+
+// Called with spin locks held and interrupts disabled: an entry is claimed with compare-and-swap and filled before it
+// is marked ready, so no lock is needed.
+
+uContention::Entry *uContention::lookup( const void *lock, const void *site, const char *kind ) {
+    size_t hash = ( (uintptr_t)lock >> 3 ) * 31 + ( (uintptr_t)site >> 2 );
+    hash ^= hash >> 17;
+
+    for ( size_t i = hash & (TableSize - 1), probe = 0; probe < TableSize; probe += 1, i = (i + 1) & (TableSize - 1) ) {
+	Entry &e = entries[i];
+	if ( e.state == Empty && uCompareAssign( e.state, (int)Empty, (int)Filling ) ) { // new entry ?
+	    e.lock = lock;
+	    e.site = site;
+	    e.kind = kind;
+	    __sync_synchronize();			// entry visible before ready
+	    e.state = Ready;
+	    return &e;
+	} // if
+	while ( e.state == Filling ) {}			// another processor is creating this entry
+	if ( e.lock == lock && e.site == site ) return &e;
+    } // for
+    uFetchAdd( dropped, 1 );				// table full
+    return NULL;
+} // uContention::lookup
+
+
+// A holder starts timing its hold of the lock, unless it is timing another lock it acquired first.
+
+void uContention::acquired( uBaseTask *holder, const void *lock, const void *site, const char *kind, bool contended, unsigned long long int wait ) {
+    Entry *e = lookup( lock, site, kind == NULL ? "monitor" : kind );
+  if ( e == NULL ) return;
+    if ( (long long int)wait < 0 ) wait = 0;
+    uFetchAdd( samples, 1 );
+    uFetchAdd( e->acquisitions, 1 );
+    if ( contended ) {
+	uFetchAdd( e->contended, 1 );
+	add( e->waitTotal, wait );
+	for ( unsigned long long int max = e->waitMax; wait > max; max = e->waitMax ) {
+	  if ( uCompareAssign( e->waitMax, max, wait ) ) break;
+	} // for
+    } // if
+    if ( holder != NULL && holder->lockHeld == NULL ) {
+	holder->lockEntry = e;
+	holder->lockStart = now();
+	holder->lockHeld = lock;
+    } // if
+} // uContention::acquired
+
+
+void uContention::released( uBaseTask &task ) {
+    Entry *e = (Entry *)task.lockEntry;
+    task.lockHeld = NULL;
+  if ( ! active || e->state != Ready ) return;		// profile stopped or restarted while held
+    long long int hold = now() - task.lockStart;
+    if ( hold > 0 ) add( e->holdTotal, hold );
+    uFetchAdd( e->holds, 1 );
+} // uContention::released
+
+
+int uContention::byWait( const void *e1, const void *e2 ) { // descending total wait
+    unsigned long long int w1 = (*(Entry **)e1)->waitTotal, w2 = (*(Entry **)e2)->waitTotal;
+    return w1 < w2 ? 1 : w1 > w2 ? -1 : 0;
+} // uContention::byWait
+
+
+static int symbol( char *buffer, int size, const void *pc ) {
+    Dl_info info;
+    // The site is a return address, which may be the first instruction after the calling routine, so look up the call.
+    if ( dladdr( (char *)pc - 1, &info ) == 0 ) info.dli_fname = info.dli_sname = NULL;
+    if ( info.dli_sname != NULL ) {
+	int status;
+	char *name = abi::__cxa_demangle( info.dli_sname, NULL, NULL, &status );
+	int len = snprintf( buffer, size, "%s", status == 0 ? name : info.dli_sname );
+	free( name );
+	return len;
+    } else if ( info.dli_fname != NULL ) {		// unknown routine in a known object
+	const char *base = strrchr( info.dli_fname, '/' );
+	return snprintf( buffer, size, "%s+0x%lx", base == NULL ? info.dli_fname : base + 1,
+			 (unsigned long int)( (char *)pc - (char *)info.dli_fbase ) );
+    } else {
+	return snprintf( buffer, size, "0x%lx", (unsigned long int)(uintptr_t)pc );
+    } // if
+} // symbol
+
+
+int uContention::report( int fd ) {
+  if ( entries == NULL ) return -1;
+    enum { BufferSize = 1024 };
+    char buffer[BufferSize];
+    int rc = 0;
+
+    Entry **sorted = new Entry *[TableSize];
+    unsigned int n = 0;
+    for ( unsigned int i = 0; i < TableSize; i += 1 ) {
+	if ( entries[i].state == Ready ) sorted[n++] = &entries[i];
+    } // for
+    qsort( sorted, n, sizeof(Entry *), byWait );
+
+    int len = snprintf( buffer, BufferSize, "Contention profile: 1 in %u acquisitions sampled, %llu samples, %llu dropped;"
+			" counts and total wait are estimates\n"
+			"%14s %12s %12s %12s %12s  %s\n", period, samples, dropped,
+			"wait ms", "max wait us", "contended", "acquisitions", "avg hold us", "lock (address) site" );
+    rc |= uInstrument::writeAll( fd, buffer, len );
+    for ( unsigned int i = 0; i < n && rc == 0; i += 1 ) {
+	Entry &e = *sorted[i];
+	len = snprintf( buffer, BufferSize, "%14.3f %12.1f %12llu %12llu %12.1f  %s (%p) ",
+			(double)e.waitTotal * period / 1.0E6, e.waitMax / 1.0E3, e.contended * period, e.acquisitions * period,
+			e.holds == 0 ? 0.0 : (double)e.holdTotal / e.holds / 1.0E3, e.kind, e.lock );
+	len += symbol( buffer + len, BufferSize - len - 1, e.site );
+	if ( len > BufferSize - 1 ) len = BufferSize - 1;	// truncated
+	buffer[len] = '\n';
+	rc |= uInstrument::writeAll( fd, buffer, len + 1 );
+    } // for
+    delete [] sorted;
+    return rc;
+} // uContention::report
+
+
+bool uContention::start( const char *file, unsigned int period ) {
+  if ( file == NULL || period == 0 ) return true;
+
+    lock.acquire();
+    if ( active ) {					// already profiling ?
+	lock.release();
+	return true;
+    } // if
+    if ( entries == NULL ) {				// first start ?
+	entries = (Entry *)uInstrument::table( TableSize * sizeof(Entry) ); // used with spin locks held
+	if ( entries == NULL ) {
+	    lock.release();
+	    return true;
+	} // if
+    } else {
+	memset( (void *)entries, 0, TableSize * sizeof(Entry) ); // discard previous profile
+    } // if
+    fileName = strdup( file );
+    uContention::period = period;
+    samples = dropped = 0;
+    active = true;
+    lock.release();
+    return false;
+} // uContention::start
+
+
+bool uContention::stop() {
+    lock.acquire();
+    if ( ! active ) {
+	lock.release();
+	return true;
+    } // if
+    active = false;
+    lock.release();
+
+    int rc = uInstrument::writeFile( fileName, report );
+    free( (void *)fileName );
+    fileName = NULL;
+    return rc != 0;
+} // uContention::stop
+
+
+// UCONTENTION=file[,period] profiles the program from boot to shutdown.
+
+void uContention::startup() {
+    char file[PATH_MAX];
+    unsigned int period = 100;
+    const char *value = uInstrument::option( "UCONTENTION", file, sizeof(file), &period );
+  if ( value == NULL ) return;
+
+    if ( start( file, period ) ) {
+	uAbort( "UCONTENTION=%s : sampling period must be greater than 0.", value );
+    } // if
+} // uContention::startup
+
+
+void uContention::finishup() {
+    if ( active ) stop();				// write report not stopped by program
+} // uContention::finishup
+
+
+// Local Variables: //
+// compile-command: "make install" //
+// End: //
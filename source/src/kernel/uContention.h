@@ -0,0 +1,104 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// uContention.h -- lock and monitor contention profiler
+//
+// Author           : agent
+// Created On       : Mon Oct 19 01:56:42 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 02:39:11 2026
+// Update Count     : 2
+//
+// This  library is free  software; you  can redistribute  it and/or  modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software  Foundation; either  version 2.1 of  the License, or  (at your
+// option) any later version.
+//
+// This library is distributed in the  hope that it will be useful, but WITHOUT
+// ANY  WARRANTY;  without even  the  implied  warranty  of MERCHANTABILITY  or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+//
+// You should  have received a  copy of the  GNU Lesser General  Public License
+// along  with this library.
+//
+
+
+#ifndef __U_CONTENTION_H__
+#define __U_CONTENTION_H__
+
+
+// On average, one in "period" acquisitions of a monitor (mutex member entry), owner lock, or condition-lock wait by each
+// task is sampled, at random intervals so a repeating pattern of acquisitions is not always sampled at the same place.
+// A sample records the time the task waits to acquire, and the time it holds the monitor or owner lock until it leaves,
+// waits or releases it. For a condition-lock wait, only the owner-lock re-acquire after the signal counts as waiting;
+// the time waiting for the signal is not contention. Spin locks are sampled only when contended, one in "period"
+// contended acquisitions, as timing every acquisition would slow the kernel. Samples accumulate per lock instance and
+// call site (the mutex member, or the routine acquiring the lock) in a table without locks.
+//
+// The report, written when profiling stops, lists the locks from most to least total wait, with counts and total wait
+// scaled up by the period as estimates. Call sites are symbolized with dladdr, so link with -rdynamic to see the names
+// of routines in the executable. Setting the environment variable UCONTENTION=file[,period] profiles the whole program.
+
+class uContention {
+    friend class UPP::uSerial;				// access: released
+    friend class UPP::uSerialMember;			// access: sample, now, acquired
+    friend class uOwnerLock;				// access: sample, now, acquired, released
+    friend class uCondLock;				// access: sample, now, acquired, released
+    friend class uBaseSpinLock;				// access: spinSample, now, acquired
+    friend class UPP::uKernelBoot;			// access: startup, finishup
+
+    enum { TableSize = 4096 };				// power of 2
+
+    struct Entry {
+	volatile int state;				// Empty, Filling, Ready
+	const void *lock, *site;
+	const char *kind;				// monitor type or lock kind
+	volatile unsigned long long int acquisitions, contended, waitTotal, waitMax, holdTotal, holds; // nanoseconds
+    }; // Entry
+
+    static uSpinLock lock;				// protects start/stop
+    static Entry *entries;
+    static const char *fileName;
+    static unsigned int period;
+    static volatile bool active;
+    static volatile unsigned int spinTicket;
+    static unsigned long long int samples, dropped;
+
+    static bool sample( uBaseTask &task ) {		// acquisition by task sampled ?
+      if ( __builtin_expect( ! active, 1 ) ) return false;
+	if ( task.lockSampleCount > 1 ) {
+	    task.lockSampleCount -= 1;
+	    return false;
+	} // if
+	task.lockSampleCount = interval();
+	return true;
+    } // uContention::sample
+
+    static bool spinSample() {				// contended spin-lock acquisition sampled ?
+	return active && uFetchAdd( spinTicket, 1 ) % period == 0;
+    } // uContention::spinSample
+
+    static unsigned long long int now();
+    static unsigned int interval();
+    static Entry *lookup( const void *lock, const void *site, const char *kind );
+    static void acquired( uBaseTask *holder, const void *lock, const void *site, const char *kind, bool contended, unsigned long long int wait );
+    static void released( uBaseTask &task );
+    static int byWait( const void *e1, const void *e2 );
+    static void startup();
+    static void finishup();
+  public:
+    static bool start( const char *file, unsigned int period = 100 ); // true => failure
+    static bool stop();					// write report, true => failure
+    static bool profiling() { return active; }
+    static int report( int fd );			// -1 => failure
+}; // uContention
+
+
+#endif // __U_CONTENTION_H__
+
+
+// Local Variables: //
+// compile-command: "make install" //
+// End: //
@@ -41,6 +41,13 @@
 #define __U_DEFAULT_MMAP_START__ (256 * 1024)
 
 
+// Define the trim threshold in bytes. When this much storage in large buckets has been freed since the last trim, the
+// next idle processor returns the free storage to the operating system (madvise) and releases the unused top of the
+// heap (sbrk).
+
+#define __U_DEFAULT_TRIM_THRESHOLD__ (4 * 1024 * 1024)
+
+
 // Define the default scheduling pre-emption time in milliseconds.  A scheduling pre-emption is attempted every default
 // pre-emption milliseconds.  A pre-emption does not occur if the executing task is not in user code or the task is
 // currently in a critical section.  A critical section begins when a task acquires a lock and ends when a user releases
@@ -78,6 +85,7 @@
 
 extern unsigned int uDefaultHeapExpansion();		// heap expansion size (bytes)
 extern unsigned int uDefaultMmapStart();		// cross over point to use mmap rather than buckets
+extern unsigned int uDefaultTrimThreshold();		// freed storage before returning memory to the OS (bytes)
 extern unsigned int uDefaultStackSize();		// cluster coroutine/task stack size (bytes)
 extern unsigned int uMainStackSize();			// uMain task stack size (bytes)
 extern unsigned int uDefaultSpin();			// processor spin time for idle task (context switches)
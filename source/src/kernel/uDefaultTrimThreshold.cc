@@ -0,0 +1,42 @@
+//                              -*- Mode: C++ -*- 
+// 
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+// 
+// uDefaultTrimThreshold.cc -- 
+// 
+// Author           : agent
+// Created On       : Mon Oct 19 00:55:35 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 00:55:35 2026
+// Update Count     : 1
+// 
+// This  library is free  software; you  can redistribute  it and/or  modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software  Foundation; either  version 2.1 of  the License, or  (at your
+// option) any later version.
+// 
+// This library is distributed in the  hope that it will be useful, but WITHOUT
+// ANY  WARRANTY;  without even  the  implied  warranty  of MERCHANTABILITY  or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+// 
+// You should  have received a  copy of the  GNU Lesser General  Public License
+// along  with this library.
+// 
+
+
+#include <uDefault.h>
+
+
+// Must be a separate translation unit so that an application can redefine this routine and the loader does not link
+// this routine from the uC++ standard library.
+
+
+unsigned int uDefaultTrimThreshold() {
+    return __U_DEFAULT_TRIM_THRESHOLD__;
+} // uDefaultTrimThreshold
+
+
+// Local Variables: //
+// compile-command: "make install" //
+// End: //
@@ -38,9 +38,11 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <cstdlib>					// strtoul
 #include <cstring>
 #include <new>
-#include <unistd.h>					// sbrk, sysconf
+#include <unistd.h>					// sbrk, sysconf, read
+#include <fcntl.h>					// open
 
 #define likely(x)       __builtin_expect(!!(x), 1)
 #define unlikely(x)     __builtin_expect(!!(x), 0)
@@ -57,6 +59,12 @@ namespace UPP {
     unsigned int uHeapManager::maxBucketsUsed;
     size_t uHeapManager::heapExpand;
     size_t uHeapManager::mmapStart;
+    size_t uHeapManager::trimThreshold;
+    unsigned int uHeapManager::trimBucketStart;
+    size_t uHeapManager::trimPending = 0;
+    size_t uHeapManager::hugePageSize = 2 * 1024 * 1024; // x86/ARM PMD size, unless the kernel reports otherwise
+    uHeapManager::HugePages uHeapManager::hugePages = uHeapManager::HugeNone;
+    uHeapManager *uHeapManager::arenas = NULL;
 
     unsigned int uHeapManager::bucketSizes[uHeapManager::NoBucketSizes] = {
 	16, 24, 32, 40, 48, 56, 64, 72,
@@ -102,13 +110,32 @@ namespace UPP {
     unsigned int uHeapManager::cmemalign_calls = 0;
     unsigned long long int uHeapManager::realloc_storage = 0;
     unsigned int uHeapManager::realloc_calls = 0;
+    unsigned int uHeapManager::trim_calls = 0;
+    unsigned long long int uHeapManager::trim_madvise_storage = 0;
+    unsigned long long int uHeapManager::trim_sbrk_storage = 0;
+    size_t uHeapManager::trim_released = 0;
+    unsigned long long int uHeapManager::huge_storage = 0;
+    unsigned int uHeapManager::hugetlb_calls = 0;
+    unsigned long long int uHeapManager::hugetlb_storage = 0;
 
     int uHeapManager::statfd = 2;			// default stderr
 
     // Use "write" because streams may be shutdown when calls are made.
     void uHeapManager::print() {
-	char helpText[512];
-	int len = snprintf( helpText, 512, "\nHeap statistics:\n"
+	// Retained storage is the heap extent plus the outstanding mmapped storage, less the free storage whose pages were
+	// returned to the OS by the last trim (approximate as trimmed blocks may have been reallocated since).
+	unsigned long long int retained = mmap_storage - munmap_storage - trim_released;
+	unsigned long long int extent = 0;
+	if ( heapManagerInstance != NULL ) {
+	    extent = (char *)heapManagerInstance->heapEnd - (char *)heapManagerInstance->heapBegin + heapManagerInstance->heapRemaining;
+	    retained += extent;
+	} // if
+	// Huge-page coverage is the advised storage relative to the heap extent plus the mmapped storage.
+	unsigned long long int mapped = extent + mmap_storage - munmap_storage;
+	unsigned int coverage = mapped == 0 ? 0 : ( huge_storage + hugetlb_storage ) * 100 / mapped;
+
+	char helpText[1024];
+	int len = snprintf( helpText, 1024, "\nHeap statistics:\n"
 			   "  malloc: calls %u / storage %llu\n"
 			   "  calloc: calls %u / storage %llu\n"
 			   "  memalign: calls %u / storage %llu\n"
@@ -117,7 +144,10 @@ namespace UPP {
 			   "  free: calls %u / storage %llu\n"
 			   "  mmap: calls %u / storage %llu\n"
 			   "  munmap: calls %u / storage %llu\n"
-			   "  sbrk: calls %u / storage %llu\n",
+			   "  sbrk: calls %u / storage %llu\n"
+			   "  trim: calls %u / madvise %llu / sbrk %llu\n"
+			   "  storage: released %zu / retained %llu\n"
+			   "  huge pages: advised %llu / hugetlb calls %u / storage %llu / coverage %u%%\n",
 			   malloc_calls, malloc_storage,
 			   calloc_calls, calloc_storage,
 			   memalign_calls, memalign_storage,
@@ -126,9 +156,19 @@ namespace UPP {
 			   free_calls, free_storage,
 			   mmap_calls, mmap_storage,
 			   munmap_calls, munmap_storage,
-			   sbrk_calls, sbrk_storage
+			   sbrk_calls, sbrk_storage,
+			   trim_calls, trim_madvise_storage, trim_sbrk_storage,
+			   trim_released, retained,
+			   huge_storage, hugetlb_calls, hugetlb_storage, coverage
 	    );
 	uDebugWrite( statfd, helpText, len );
+
+	for ( uHeapManager *arena = arenas; arena != NULL; arena = arena->nextArena ) {
+	    len = snprintf( helpText, 1024, "  arena %.256s: malloc calls %u / storage %llu / free calls %u / storage %llu\n",
+			    arena->arenaName == NULL ? "*unused*" : arena->arenaName,
+			    arena->arenaMallocCalls, arena->arenaMallocStorage, arena->arenaFreeCalls, arena->arenaFreeStorage );
+	    uDebugWrite( statfd, helpText, len );
+	} // for
     } // uHeapManager::print
 #endif // __U_STATISTICS__
 
@@ -161,6 +201,96 @@ namespace UPP {
 	return false;
     } // uHeapManager::setMmapStart
 
+    bool uHeapManager::setTrimThreshold( size_t value ) {
+      if ( value < pageSize ) return true;
+	trimThreshold = value;				// negative mallopt value => huge => automatic trimming off
+	return false;
+    } // uHeapManager::setTrimThreshold
+
+    bool uHeapManager::setHugePages( int value ) {
+	switch ( value ) {
+	  case HugeNone:
+	    break;
+#ifdef MADV_HUGEPAGE
+	  case HugeTransparent:
+	    break;
+#ifdef MAP_HUGETLB
+	  case HugeTLB:
+	    break;
+#endif // MAP_HUGETLB
+#endif // MADV_HUGEPAGE
+	  default:
+	    return true;				// unknown or unsupported mode
+	} // switch
+	hugePages = (HugePages)value;
+	return false;
+    } // uHeapManager::setHugePages
+
+
+    // Heap for allocations by the current task: the arena of its cluster or the shared heap. Before the kernel boots,
+    // there is no active cluster.
+
+    inline uHeapManager *uHeapManager::arena() {
+	uCluster *cluster = THREAD_GETMEM( activeCluster );
+      if ( likely( cluster == NULL || cluster->heapArena == NULL ) ) return heapManagerInstance;
+	return cluster->heapArena;
+    } // uHeapManager::arena
+
+#ifdef __U_DEBUG__
+    bool uHeapManager::checkHome( FreeHeader *freeElem ) {
+	if ( &heapManagerInstance->freeLists[0] <= freeElem && freeElem < &heapManagerInstance->freeLists[NoBucketSizes] ) return true;
+	for ( uHeapManager *arena = arenas; arena != NULL; arena = arena->nextArena ) {
+	    if ( &arena->freeLists[0] <= freeElem && freeElem < &arena->freeLists[NoBucketSizes] ) return true;
+	} // for
+	return false;
+    } // uHeapManager::checkHome
+#endif // __U_DEBUG__
+
+    // Arenas are never deleted because blocks allocated from an arena may be freed after its cluster is deleted;
+    // instead, an unused arena (and its free storage) is given to the next cluster requesting one.
+
+    uHeapManager *uHeapManager::arenaAcquire( const char *name ) {
+	uHeapManager *arena;
+	heapManagerInstance->arenaLock.acquire();
+	for ( arena = arenas; arena != NULL && arena->arenaName != NULL; arena = arena->nextArena ); // find unused arena
+	if ( arena != NULL ) arena->arenaName = name;
+	heapManagerInstance->arenaLock.release();
+
+	if ( arena == NULL ) {
+	    void *storage = ::memalign( 128, sizeof(uHeapManager) ); // size of cache line to prevent false sharing
+	    if ( storage == NULL ) noMemory();
+	    arena = new( storage ) uHeapManager( name );
+	    heapManagerInstance->arenaLock.acquire();
+	    arena->nextArena = arenas;
+	    arenas = arena;
+	    heapManagerInstance->arenaLock.release();
+	} // if
+	return arena;
+    } // uHeapManager::arenaAcquire
+
+    void uHeapManager::arenaRelease( uHeapManager *arena ) {
+	arena->arenaName = NULL;			// free storage stays on the arena's lists for reuse
+    } // uHeapManager::arenaRelease
+
+    // Storage allocated from the arena and not freed, computed on query from the carved chunks and the free lists so
+    // malloc/free touch no shared counters. The value is approximate while allocation continues.
+
+    size_t uHeapManager::arenaStorage() {
+	extlock.acquire();
+	size_t carved = arenaChunkStorage - heapRemaining;
+	extlock.release();
+
+	size_t freed = 0;
+	for ( unsigned int i = 0; i <= maxBucketsUsed; i += 1 ) {
+	    freeLists[i].lock.acquire();
+	    for ( Storage *p = freeLists[i].freeList; p != NULL; p = p->header.kind.real.next ) {
+		freed += freeLists[i].blockSize;
+	    } // for
+	    freeLists[i].lock.release();
+	} // for
+	return carved > freed ? carved - freed : 0;
+    } // uHeapManager::arenaStorage
+
     inline bool uHeapManager::headers( const char *name, void *addr, Storage::Header *&header, FreeHeader *&freeElem, size_t &size, size_t &alignment ) {
 	header = (Storage::Header *)( (char *)addr - sizeof(Storage::Header) );
 	if ( unlikely( (header->kind.fake.alignment & 1) == 1 ) ) { // fake header ?
@@ -172,12 +302,12 @@ namespace UPP {
 	    header = (Storage::Header *)((char *)header - offset);
 	} // if
 	if ( unlikely( addr < heapBegin || heapEnd < addr ) ) {	// mmapped ?
-	    size = header->kind.real.blockSize & -3;
+	    size = realSize( header );
 	    return true;
 	} else {
-	    freeElem = (FreeHeader *)((size_t)header->kind.real.home & -3);
+	    freeElem = realHome( header );
 #ifdef __U_DEBUG__
-	    if ( freeElem < &freeLists[0] || &freeLists[NoBucketSizes] <= freeElem ) {
+	    if ( ! checkHome( freeElem ) ) {
 		uAbort( "Attempt to %s storage %p with corrupted header.\n"
 			"Possible cause is duplicate free on same block or overwriting of header information.",
 			name, addr );
@@ -196,11 +326,43 @@ namespace UPP {
 		   this, size, heapBegin, heapEnd, heapRemaining, sbrk(0) );
 #endif // __U_DEBUG_H__
 	ptrdiff_t rem = heapRemaining - size;
-	if ( rem < 0 ) {
+	if ( rem < 0 && this != heapManagerInstance ) {	// arena ?
+	    // Carve a new chunk from the shared heap, after putting the unused end of the current chunk onto this arena's
+	    // free lists in the largest buckets that fit.
+
+	    while ( heapRemaining >= bucketSizes[0] ) {
+		FreeHeader key;
+		key.blockSize = heapRemaining;		// fake element for search
+		FreeHeader *freeElem = std::upper_bound( freeLists, freeLists + maxBucketsUsed + 1, key ) - 1; // binary search
+		Storage *block = (Storage *)heapEnd;
+		freeElem->lock.acquire();
+		block->header.kind.real.next = freeElem->freeList;
+		freeElem->freeList = block;
+		freeElem->lock.release();
+		heapEnd = (char *)heapEnd + freeElem->blockSize;
+		heapRemaining -= freeElem->blockSize;
+	    } // while
+
+	    size_t increase = uCeiling( size > heapExpand ? size : heapExpand, uAlign() );
+	    void *chunk = heapManagerInstance->extend( increase );
+	    if ( chunk == NULL ) {			// errno set
+		extlock.release();
+		return NULL;
+	    } // if
+	    heapBegin = heapEnd = chunk;
+	    heapRemaining = increase;
+	    arenaChunkStorage += increase;
+	    rem = increase - size;
+	} else if ( rem < 0 ) {
 	    // If the size requested is bigger than the current remaining storage, increase the size of the heap.
 
 	    size_t increase = uCeiling( size > heapExpand ? size : heapExpand, uAlign() );
-	    if ( sbrk( increase ) == (void *)-1 ) {
+	    if ( hugePages != HugeNone ) {		// end the heap on a huge-page boundary so whole huge pages back it
+		char *brk = (char *)heapEnd + heapRemaining;
+		increase = (char *)uCeiling( (uintptr_t)brk + increase, hugePageSize ) - brk;
+	    } // if
+	    char *prev = (char *)sbrk( increase );
+	    if ( prev == (char *)-1 ) {
 #ifdef __U_DEBUG_H__
 		uDebugPrt( "0x%zx = (uHeapManager &)%p.extend( %zu ), heapBegin:%p, heapEnd:%p, heapRemaining:0x%zx, sbrk:%p\n",
 			   NULL, this, size, heapBegin, heapEnd, heapRemaining, sbrk(0) );
@@ -213,6 +375,18 @@ namespace UPP {
 	    sbrk_calls += 1;
 	    sbrk_storage += increase;
 #endif // __U_STATISTICS__
+#ifdef MADV_HUGEPAGE
+	    if ( hugePages != HugeNone ) {
+		// prev is huge-page aligned except for the first extension after huge pages are enabled.
+		char *start = (char *)uCeiling( (uintptr_t)prev, hugePageSize );
+		char *end = (char *)uFloor( (uintptr_t)prev + increase, hugePageSize );
+		if ( start < end && madvise( start, end - start, MADV_HUGEPAGE ) == 0 ) {
+#ifdef __U_STATISTICS__
+		    huge_storage += end - start;
+#endif // __U_STATISTICS__
+		} // if
+	    } // if
+#endif // MADV_HUGEPAGE
 #ifdef __U_DEBUG__
 	    // Set new memory to garbage so subsequent uninitialized usages might fail.
 	    memset( (char *)heapEnd + heapRemaining, '\377', increase );
@@ -245,26 +419,57 @@ namespace UPP {
 	size_t tsize = size + sizeof(Storage::Header);
 	if ( tsize >= mmapStart ) {			// large size => mmap
 	    tsize = uCeiling( tsize, pageSize );	// must be multiple of page size
-#ifdef __U_STATISTICS__
-	    uFetchAdd( mmap_calls, 1 );
-	    uFetchAdd( mmap_storage, tsize );
-#endif // __U_STATISTICS__
 	    int mmapFlags = MAP_PRIVATE |
 #if defined( __freebsd__ )
 		MAP_ANON;
 #else
 		MAP_ANONYMOUS;
 #endif
-	    block = (Storage *)::mmap( 0, tsize, PROT_READ | PROT_WRITE, mmapFlags, mmapFd, 0 );
+	    block = (Storage *)MAP_FAILED;
+	    size_t hugeFlag = 0;			// huge-page backing, subtracted from statistics by free
+#ifdef MAP_HUGETLB
+	    if ( unlikely( hugePages == HugeTLB && tsize >= hugePageSize ) ) {
+		// Requires preallocated huge pages (vm.nr_hugepages); otherwise fall back to normal pages.
+		size_t hsize = uCeiling( tsize, hugePageSize ); // munmap length must be a multiple of huge-page size
+		block = (Storage *)::mmap( 0, hsize, PROT_READ | PROT_WRITE, mmapFlags | MAP_HUGETLB, mmapFd, 0 );
+		if ( block != MAP_FAILED ) {
+		    tsize = hsize;
+		    hugeFlag = HugeTLBFlag;
+#ifdef __U_STATISTICS__
+		    uFetchAdd( hugetlb_calls, 1 );
+		    uFetchAdd( hugetlb_storage, tsize );
+#endif // __U_STATISTICS__
+		} // if
+	    } // if
+#endif // MAP_HUGETLB
 	    if ( block == MAP_FAILED ) {
-		// Do not call strerror( errno ) as it may call malloc.
-		uAbort( "(uHeapManager &)0x%p.doMalloc() : internal error, mmap failure, size:%zu error:%d.", this, tsize, errno );
+		block = (Storage *)::mmap( 0, tsize, PROT_READ | PROT_WRITE, mmapFlags, mmapFd, 0 );
+		if ( block == MAP_FAILED ) {
+		    // Do not call strerror( errno ) as it may call malloc.
+		    uAbort( "(uHeapManager &)0x%p.doMalloc() : internal error, mmap failure, size:%zu error:%d.", this, tsize, errno );
+		} // if
+#ifdef MADV_HUGEPAGE
+		if ( unlikely( hugePages != HugeNone && tsize >= hugePageSize ) ) {
+		    char *start = (char *)uCeiling( (uintptr_t)block, hugePageSize );
+		    char *end = (char *)uFloor( (uintptr_t)block + tsize, hugePageSize );
+		    if ( start < end && madvise( start, end - start, MADV_HUGEPAGE ) == 0 ) {
+			hugeFlag = HugeAdvisedFlag;
+#ifdef __U_STATISTICS__
+			uFetchAdd( huge_storage, end - start );
+#endif // __U_STATISTICS__
+		    } // if
+		} // if
+#endif // MADV_HUGEPAGE
 	    } // if
+#ifdef __U_STATISTICS__
+	    uFetchAdd( mmap_calls, 1 );
+	    uFetchAdd( mmap_storage, tsize );
+#endif // __U_STATISTICS__
 #ifdef __U_DEBUG__
 	    // Set new memory to garbage so subsequent uninitialized usages might fail.
 	    memset( block, '\377', tsize );
 #endif // __U_DEBUG__
-	    block->header.kind.real.blockSize = tsize;	// storage size for munmap
+	    block->header.kind.real.blockSize = tsize | hugeFlag; // storage size for munmap
 	} else {
 	    FreeHeader key;
 	    key.blockSize = tsize;			// fake element for search
@@ -299,6 +504,12 @@ namespace UPP {
 	    } // if
 
 	    block->header.kind.real.home = freeElem;	// pointer back to free list of apropriate size
+#ifdef __U_STATISTICS__
+	    if ( this != heapManagerInstance ) {	// arena accounting
+		uFetchAdd( arenaMallocCalls, 1 );
+		uFetchAdd( arenaMallocStorage, tsize );
+	    } // if
+#endif // __U_STATISTICS__
 	} // if
 
 	void *area = &(block->data);			// adjust off header to user bytes
@@ -337,10 +548,20 @@ namespace UPP {
 	FreeHeader *freeElem;
 	size_t size, alignment;				// not used (see realloc)
 
-	if ( headers( "free", addr, header, freeElem, size, alignment ) ) { // mmapped ?
+	bool mapped = headers( "free", addr, header, freeElem, size, alignment );
+	if ( unlikely( header->kind.real.blockSize & SampledFlag ) ) { // sampled by heap profiler ?
+	    uHeapSampler::freed( header );
+	} // if
+	if ( mapped ) {					// mmapped ?
 #ifdef __U_STATISTICS__
 	    uFetchAdd( munmap_calls, 1 );
 	    uFetchAdd( munmap_storage, size );
+	    if ( header->kind.real.blockSize & HugeTLBFlag ) {
+		__atomic_fetch_sub( &hugetlb_storage, size, __ATOMIC_RELAXED );
+	    } else if ( header->kind.real.blockSize & HugeAdvisedFlag ) { // same range as advised by doMalloc
+		size_t advised = uFloor( (uintptr_t)header + size, hugePageSize ) - uCeiling( (uintptr_t)header, hugePageSize );
+		__atomic_fetch_sub( &huge_storage, advised, __ATOMIC_RELAXED );
+	    } // if
 #endif // __U_STATISTICS__
 	    if ( munmap( header, size ) == -1 ) {
 #ifdef __U_DEBUG__
@@ -376,6 +597,20 @@ namespace UPP {
 #ifdef __U_DEBUG_H__
 	    uDebugPrt( "(uHeapManager &)%p.doFree( %p ) returning free block in list 0x%zx\n", this, addr, size );
 #endif // __U_DEBUG_H__
+
+#ifdef __U_STATISTICS__
+	    uHeapManager *owner = freeElem->owner;
+	    if ( owner != this ) {			// arena accounting
+		uFetchAdd( owner->arenaFreeCalls, 1 );
+		uFetchAdd( owner->arenaFreeStorage, size );
+	    } // if
+#endif // __U_STATISTICS__
+
+	    // Only frees of large blocks count towards trimming, and the counter is lock free, so small frees pay nothing.
+	    // The trim itself is left to the next idle processor (see trimIdle), so this free does not pay for it.
+	    if ( unlikely( size >= bucketSizes[trimBucketStart] ) ) {
+		uFetchAdd( trimPending, size );
+	    } // if
 	} // if
 
 #ifdef __U_DEBUG__
@@ -390,6 +625,90 @@ namespace UPP {
     } // uHeapManager::doFree
 
 
+    // Release the whole pages of the free blocks in large buckets, keeping each block's header page (free-list link).
+    // Release is page granular even in huge-page mode: bucket blocks are below the mmap crossover (256K by default), so
+    // few free blocks span a whole huge page; the kernel splits the huge page around the released run and khugepaged
+    // collapses it again after the pages are reused.
+
+    size_t uHeapManager::releaseFree() {
+	size_t madvised = 0;
+	for ( unsigned int i = trimBucketStart; i <= maxBucketsUsed; i += 1 ) {
+	    FreeHeader &freeElem = freeLists[i];
+
+	    // Detach the free list so allocations/frees of this size are not delayed by the system calls.
+	    freeElem.lock.acquire();
+	    Storage *list = freeElem.freeList;
+	    freeElem.freeList = NULL;
+	    freeElem.lock.release();
+	  if ( list == NULL ) continue;
+
+	    Storage *last = NULL;
+	    for ( Storage *p = list; p != NULL; p = p->header.kind.real.next ) {
+		char *start = (char *)uCeiling( (uintptr_t)&p->data, pageSize );
+		char *end = (char *)uFloor( (uintptr_t)p + freeElem.blockSize, pageSize );
+		// MADV_DONTNEED rather than MADV_FREE so RSS drops immediately instead of under memory pressure.
+		if ( start < end && madvise( start, end - start, MADV_DONTNEED ) == 0 ) {
+		    madvised += end - start;
+		} // if
+		last = p;
+	    } // for
+
+	    freeElem.lock.acquire();			// splice back blocks freed during the trim
+	    last->header.kind.real.next = freeElem.freeList;
+	    freeElem.freeList = list;
+	    freeElem.lock.release();
+	} // for
+	return madvised;
+    } // uHeapManager::releaseFree
+
+
+    // Return free storage to the OS. Free blocks in large buckets of the shared heap and the arenas release their whole
+    // pages with madvise, so a block stays on its free list and faults in zero pages when reused. Then the unallocated
+    // storage at the top of the heap, beyond "pad" bytes, is released with sbrk. Returns the number of bytes released. If
+    // another task is trimming, nothing is done.
+
+    size_t uHeapManager::trim( size_t pad ) {
+      if ( ! trimlock.tryacquire() ) return 0;		// trim in progress ?
+	__atomic_exchange_n( &trimPending, 0, __ATOMIC_RELAXED ); // frees during the trim count towards the next one
+
+	size_t madvised = releaseFree();
+	for ( uHeapManager *arena = arenas; arena != NULL; arena = arena->nextArena ) {
+	    madvised += arena->releaseFree();
+	} // for
+
+	// In huge-page mode, shrink the top only by whole huge pages so the heap end stays on a huge-page boundary.
+	size_t align = hugePages == HugeNone ? pageSize : hugePageSize;
+
+	size_t shrink = 0;
+	extlock.acquire();
+	// Only shrink if no one else has moved the break (e.g., direct sbrk by a library).
+	if ( heapRemaining > pad && sbrk( 0 ) == (char *)heapEnd + heapRemaining ) {
+	    shrink = uFloor( heapRemaining - pad, align );
+	    if ( shrink != 0 ) {
+		if ( sbrk( -(intptr_t)shrink ) == (void *)-1 ) {
+		    shrink = 0;
+		} else {
+		    heapRemaining -= shrink;
+		} // if
+	    } // if
+	} // if
+	extlock.release();
+
+#ifdef __U_STATISTICS__
+	trim_calls += 1;
+	trim_madvise_storage += madvised;
+	trim_sbrk_storage += shrink;
+	trim_released = madvised;
+	if ( hugePages != HugeNone ) huge_storage -= std::min( huge_storage, (unsigned long long int)shrink ); // released top was advised
+#endif // __U_STATISTICS__
+#ifdef __U_DEBUG_H__
+	uDebugPrt( "(uHeapManager &)%p.trim( %zu ) madvise:%zu sbrk:%zu\n", this, pad, madvised, shrink );
+#endif // __U_DEBUG_H__
+	trimlock.release();
+	return madvised + shrink;
+    } // uHeapManager::trim
+
+
     size_t uHeapManager::checkFree( bool prt ) {
 	size_t total = 0;
 #ifdef __U_STATISTICS__
@@ -425,9 +744,23 @@ namespace UPP {
 	uDebugPrt( "(uHeapManager &)%p.uHeap()\n", this );
 #endif // __U_DEBUG_H__
 	pageSize = sysconf( _SC_PAGESIZE );
-    
+
+	// Huge-page size is per architecture/configuration (2MB x86, 512MB arm64 with 64K pages); use the kernel's value.
+	int fd = open( "/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", O_RDONLY );
+	if ( fd != -1 ) {
+	    char buf[32];
+	    ssize_t len = read( fd, buf, sizeof(buf) - 1 );
+	    close( fd );
+	    if ( len > 0 ) {
+		buf[len] = '\0';
+		size_t size = strtoul( buf, NULL, 10 );
+		if ( size > pageSize && uPow2( size ) ) hugePageSize = size;
+	    } // if
+	} // if
+
 	for ( unsigned int i = 0; i < NoBucketSizes; i += 1 ) { // initialize the free lists
 	    freeLists[i].blockSize = bucketSizes[i];
+	    freeLists[i].owner = this;
 	} // for
 
 #ifdef FASTLOOKUP
@@ -442,6 +775,12 @@ namespace UPP {
 	    uAbort( "uHeapManager::uHeapManager : internal error, mmap start initialization failure." );
 	} // if
 	heapExpand = uDefaultHeapExpansion();
+	if ( setTrimThreshold( uDefaultTrimThreshold() ) ) {
+	    uAbort( "uHeapManager::uHeapManager : internal error, trim threshold initialization failure." );
+	} // if
+
+	// find the first bucket whose blocks span at least one page beyond the header page
+	for ( trimBucketStart = 0; trimBucketStart < NoBucketSizes - 1 && bucketSizes[trimBucketStart] < 2 * pageSize; trimBucketStart += 1 );
 
 	char *end = (char *)sbrk( 0 );
 	sbrk( (char *)uCeiling( (long unsigned int)end, uAlign() ) - end ); // move start of heap to multiple of alignment
@@ -453,6 +792,28 @@ namespace UPP {
     } // uHeapManager::uHeapManager
 
 
+    uHeapManager::uHeapManager( const char *name ) {	// arena
+#ifdef __U_DEBUG_H__
+	uDebugPrt( "(uHeapManager &)%p.uHeap( %s )\n", this, name );
+#endif // __U_DEBUG_H__
+	for ( unsigned int i = 0; i < NoBucketSizes; i += 1 ) { // initialize the free lists
+	    freeLists[i].blockSize = bucketSizes[i];
+	    freeLists[i].freeList = NULL;
+	    freeLists[i].owner = this;
+	} // for
+
+	heapBegin = heapEnd = NULL;			// no chunk
+	heapRemaining = 0;
+	nextArena = NULL;
+	arenaName = name;
+	arenaChunkStorage = 0;
+#ifdef __U_STATISTICS__
+	arenaMallocCalls = arenaFreeCalls = 0;
+	arenaMallocStorage = arenaFreeStorage = 0;
+#endif // __U_STATISTICS__
+    } // uHeapManager::uHeapManager
+
+
     uHeapManager::~uHeapManager() {
 #ifdef __U_STATISTICS__
 	if ( UPP::Statistics::prtHeapterm ) {
@@ -560,15 +921,19 @@ extern "C" {
 	uFetchAdd( UPP::uHeapManager::malloc_storage, size );
 #endif // __U_STATISTICS__
 
-	void *area = UPP::uHeapManager::heapManagerInstance->doMalloc( size );
+	void *area = UPP::uHeapManager::arena()->doMalloc( size );
 	if ( unlikely( area == NULL ) ) errno = ENOMEM;	// POSIX
 
 #ifdef __U_PROFILER__
 	if ( uThisTask().profileActive && uProfiler::uProfiler_registerMemoryAllocate ) {
 	    UPP::uHeapManager::Storage::Header *header = (UPP::uHeapManager::Storage::Header *)( (char *)area - sizeof(UPP::uHeapManager::Storage::Header) );
-	    PROFILEMALLOCENTRY( header ) = (*uProfiler::uProfiler_registerMemoryAllocate)( uProfiler::profilerInstance, area, size, header->kind.real.blockSize & -3 );
+	    PROFILEMALLOCENTRY( header ) = (*uProfiler::uProfiler_registerMemoryAllocate)( uProfiler::profilerInstance, area, size, UPP::uHeapManager::realSize( header ) );
 	} // if
 #endif // __U_PROFILER__
+	if ( unlikely( UPP::uHeapSampler::interval != 0 ) && area != NULL ) { // heap profiling ?
+	    UPP::uHeapManager::Storage::Header *header = (UPP::uHeapManager::Storage::Header *)( (char *)area - sizeof(UPP::uHeapManager::Storage::Header) );
+	    if ( UPP::uHeapSampler::sample( header, size ) ) header->kind.real.blockSize |= UPP::uHeapManager::SampledFlag; // mark for free
+	} // if
 #ifdef __U_DEBUG_H__
 	uDebugPrt( "%p = malloc( %zu )\n", area, size );
 #endif // __U_DEBUG_H__
@@ -593,7 +958,7 @@ extern "C" {
 	if ( ! mapped )					// mapped storage is zero filled, except debug mode scrubs memory
 #endif // __U_DEBUG__
 	    memset( area, '\0', asize - ( (char *)area - (char *)header ) ); // set to zeros
-	header->kind.real.blockSize |= 2;		// mark as zero filled
+	header->kind.real.blockSize |= UPP::uHeapManager::ZeroFillFlag; // mark as zero filled
 #ifdef __U_DEBUG_H__
 	uDebugPrt( "%p = calloc( %zu, %zu )\n", area, noOfElems, elemSize );
 #endif // __U_DEBUG_H__
@@ -618,7 +983,7 @@ extern "C" {
 	if ( ! mapped )					// mapped storage is zero filled, except debug mode scrubs memory
 #endif // __U_DEBUG__
 	    memset( area, '\0', asize - ( (char *)area - (char *)header ) ); // set to zeros
-	header->kind.real.blockSize |= 2;		// mark as zero filled
+	header->kind.real.blockSize |= UPP::uHeapManager::ZeroFillFlag; // mark as zero filled
 #ifdef __U_DEBUG_H__
 	uDebugPrt( "%p = cmemalign( %zu, %zu, %zu )\n", area, alignment, noOfElems, elemSize );
 #endif // __U_DEBUG_H__
@@ -661,14 +1026,14 @@ extern "C" {
 	    area = malloc( size );			// create new area
 	} // if
       if ( unlikely( area == NULL ) ) return NULL;
-	if ( unlikely( header->kind.real.blockSize & 2 ) ) { // previous request zero fill (calloc/cmemalign) ?
+	if ( unlikely( header->kind.real.blockSize & UPP::uHeapManager::ZeroFillFlag ) ) { // previous request zero fill (calloc/cmemalign) ?
 	    assert( (header->kind.real.blockSize & 1) == 0 );
 	    bool mapped __attribute__(( unused )) = UPP::uHeapManager::heapManagerInstance->headers( "realloc", area, header, freeElem, asize, alignment );
 #ifndef __U_DEBUG__
 	    if ( ! mapped )				// mapped storage is zero filled, except debug mode scrubs memory
 #endif // __U_DEBUG__
 		memset( (char *)area + usize, '\0', asize - ( (char *)area - (char *)header ) - usize ); // zero-fill back part
-	    header->kind.real.blockSize |= 2;		// mark new request as zero fill
+	    header->kind.real.blockSize |= UPP::uHeapManager::ZeroFillFlag; // mark new request as zero fill
 	} // if
 	memcpy( area, addr, usize );			// copy bytes
 	free( addr );
@@ -705,7 +1070,7 @@ extern "C" {
 
 	// subtract uAlign() because it is already the minimum alignment
 	// add sizeof(Storage) for fake header
-	char *area = (char *)UPP::uHeapManager::heapManagerInstance->doMalloc( size + alignment - uAlign() + sizeof(UPP::uHeapManager::Storage) );
+	char *area = (char *)UPP::uHeapManager::arena()->doMalloc( size + alignment - uAlign() + sizeof(UPP::uHeapManager::Storage) );
       if ( unlikely( area == NULL ) ) return area;
 
 	// address in the block of the "next" alignment address
@@ -722,9 +1087,12 @@ extern "C" {
 
 #ifdef __U_PROFILER__
 	if ( uThisTask().profileActive && uProfiler::uProfiler_registerMemoryAllocate ) {
-	    PROFILEMALLOCENTRY( fakeHeader ) = (*uProfiler::uProfiler_registerMemoryAllocate)( uProfiler::profilerInstance, area, size, realHeader->kind.real.home->blockSize & -3 );
+	    PROFILEMALLOCENTRY( fakeHeader ) = (*uProfiler::uProfiler_registerMemoryAllocate)( uProfiler::profilerInstance, area, size, UPP::uHeapManager::realHome( realHeader )->blockSize );
 	} // if
 #endif // __U_PROFILER__
+	if ( unlikely( UPP::uHeapSampler::interval != 0 ) ) { // heap profiling ?
+	    if ( UPP::uHeapSampler::sample( realHeader, size ) ) realHeader->kind.real.blockSize |= UPP::uHeapManager::SampledFlag; // mark for free
+	} // if
 
 #ifdef __U_DEBUG_H__
 	uDebugPrt( "%p = memalign( %zu, %zu )\n", user, alignment, size );
@@ -793,7 +1161,7 @@ extern "C" {
 // 	size_t size, alignment;
 
 // 	UPP::uHeapManager::heapManagerInstance->headers( "malloc_zero_fill", addr, header, freeElem, size, alignment );
-// 	return (header->kind.real.blockSize & 2) != 0;	// zero filled (calloc/cmemalign) ?
+// 	return (header->kind.real.blockSize & UPP::uHeapManager::ZeroFillFlag) != 0; // zero filled (calloc/cmemalign) ?
 //     } // malloc_zero_fill
 
     bool malloc_zero_fill( void *addr ) __THROW {
@@ -802,7 +1170,7 @@ extern "C" {
 	if ( (header->kind.fake.alignment & 1) == 1 ) { // fake header ?
 	    header = (UPP::uHeapManager::Storage::Header *)((char *)header - header->kind.fake.offset);
 	} // if
-	return (header->kind.real.blockSize & 2) != 0;	// zero filled (calloc/cmemalign) ?
+	return (header->kind.real.blockSize & UPP::uHeapManager::ZeroFillFlag) != 0; // zero filled (calloc/cmemalign) ?
     } // malloc_zero_fill
 
 
@@ -845,11 +1213,29 @@ extern "C" {
 	  case M_MMAP_THRESHOLD:
 	    if ( UPP::uHeapManager::heapManagerInstance->setMmapStart( value ) ) return 1;
 	    break;
+	  case M_TRIM_THRESHOLD:
+	    if ( UPP::uHeapManager::heapManagerInstance->setTrimThreshold( value ) ) return 1;
+	    break;
+	  case M_HUGE_PAGES:
+	    if ( UPP::uHeapManager::heapManagerInstance->setHugePages( value ) ) return 1;
+	    break;
+	  case M_SAMPLE_INTERVAL:
+	    if ( UPP::uHeapSampler::setInterval( value ) ) return 1;
+	    break;
+	  case M_SAMPLE_SIGNAL:
+	    if ( UPP::uHeapSampler::setSignal( value ) ) return 1;
+	    break;
 	  default:
 	    return 1;
 	} // switch
 	return 0;
     } // mallopt
+
+
+    int malloc_trim( size_t pad ) __THROW {
+	if ( unlikely( UPP::uHeapManager::heapManagerInstance == NULL ) ) return 0;
+	return UPP::uHeapManager::heapManagerInstance->trim( pad ) != 0; // 1 => storage released
+    } // malloc_trim
 } // extern "C"
 
 
@@ -44,6 +44,8 @@ extern "C" size_t malloc_usable_size( void *addr ) __THROW;
 extern "C" void malloc_stats() __THROW;
 extern "C" int malloc_stats_fd( int fd ) __THROW;
 extern "C" int mallopt( int param_number, int value ) __THROW;
+extern "C" int malloc_trim( size_t pad ) __THROW;
+extern "C" int malloc_sample_dump( int fd ) __THROW;
 
 
 namespace UPP {
@@ -58,13 +60,17 @@ namespace UPP {
 	friend void *::memalign( size_t alignment, size_t size ) __THROW; // access: boot
 	friend void *::valloc( size_t size ) __THROW;	// access: pageSize
 	friend void ::free( void *addr ) __THROW;	// access: doFree
-	friend int ::mallopt( int param_number, int value ) __THROW; // access: heapManagerInstance, setHeapExpand, setMmapStart
+	friend int ::mallopt( int param_number, int value ) __THROW; // access: heapManagerInstance, setHeapExpand, setMmapStart, setTrimThreshold, setHugePages
+	friend int ::malloc_trim( size_t pad ) __THROW;	// access: heapManagerInstance, trim
 	friend size_t ::malloc_alignment( void *addr ) __THROW; // access: Header, FreeHeader
 	friend bool ::malloc_zero_fill( void *addr ) __THROW; // access: Storage
 	friend size_t ::malloc_usable_size( void *addr ) __THROW; // access: Header, FreeHeader
 	friend void ::malloc_stats() __THROW;
 	friend int ::malloc_stats_fd( int fd ) __THROW;
 	friend class uHeapControl;			// access: heapManagerInstance, boot
+	friend class ::uCluster;			// access: arenaAcquire, arenaRelease, arenaStorage
+	friend class uHeapSampler;			// access: Storage
+	friend _Coroutine uProcessorKernel;		// access: trimIdle
 #ifdef __U_STATISTICS__
 	friend void UPP::Statistics::print();
 #endif // __U_STATISTICS__
@@ -103,14 +109,37 @@ namespace UPP {
 	    char data[0];				// storage
 	}; // Storage
 
+	// Flags in the low bits of a real header's home/blockSize word, which is at least 8-byte aligned; bit 0 stays clear.
+	// The huge-page flags are set only in the size of an mmapped block, which is a multiple of the page size, so they
+	// need not be stripped from home pointers. Decode the word only with realHome/realSize so every path strips all the
+	// flags.
+	enum { ZeroFillFlag = 2,			// calloc/cmemalign storage
+	       SampledFlag = 4,				// sampled by uHeapSampler, so free must remove it from the sampler
+	       HeaderFlags = ZeroFillFlag | SampledFlag,
+	       HugeTLBFlag = 8,				// mmapped with MAP_HUGETLB, so free subtracts from hugetlb_storage
+	       HugeAdvisedFlag = 16,			// mmapped and advised MADV_HUGEPAGE, so free subtracts from huge_storage
+	       MappedFlags = HugeTLBFlag | HugeAdvisedFlag
+	};
+
+	static FreeHeader *realHome( Storage::Header *header ) {
+	    return (FreeHeader *)( header->kind.real.blockSize & ~(size_t)HeaderFlags );
+	} // uHeapManager::realHome
+
+	static size_t realSize( Storage::Header *header ) {
+	    return header->kind.real.blockSize & ~(size_t)( HeaderFlags | MappedFlags );
+	} // uHeapManager::realSize
+
 	struct FreeHeader {
 	    uSpinLock lock;				// must be first field for alignment
 	    size_t blockSize;				// size of allocations on this list
 	    Storage *freeList;
+	    uHeapManager *owner;			// heap (shared or arena) containing this list
 
 	    bool operator<( const FreeHeader &a2 ) const { return blockSize < a2.blockSize; }
 	}; // FreeHeader
 
+	enum HugePages { HugeNone, HugeTransparent, HugeTLB }; // huge-page backing of heap storage
+
 	enum { NoBucketSizes = 97,			// number of buckets sizes
 #ifdef FASTLOOKUP
 	       LookupSizes = 65536,			// number of fast lookup sizs
@@ -121,6 +150,12 @@ namespace UPP {
 	static size_t pageSize;				// architecture pagesize
 	static size_t heapExpand;			// sbrk advance
 	static size_t mmapStart;			// cross over point for mmap
+	static size_t trimThreshold;			// freed storage in large buckets before trimming
+	static unsigned int trimBucketStart;		// first bucket with blocks large enough to release pages
+	static size_t trimPending;			// storage freed in large buckets since last trim
+	static size_t hugePageSize;			// huge-page (PMD) size reported by the kernel
+	static HugePages hugePages;			// huge-page mode
+	static uHeapManager *arenas;			// list of per-cluster arenas
 	static unsigned int maxBucketsUsed;		// maximum number of buckets in use
 	static unsigned int bucketSizes[NoBucketSizes];	// different bucket sizes
 #ifdef FASTLOOKUP
@@ -151,6 +186,13 @@ namespace UPP {
 	static unsigned int cmemalign_calls;
 	static unsigned long long int realloc_storage;
 	static unsigned int realloc_calls;
+	static unsigned int trim_calls;
+	static unsigned long long int trim_madvise_storage;
+	static unsigned long long int trim_sbrk_storage;
+	static size_t trim_released;			// storage returned to the OS by last trim
+	static unsigned long long int huge_storage;	// storage advised for transparent huge pages
+	static unsigned int hugetlb_calls;
+	static unsigned long long int hugetlb_storage;
 	static int statfd;
 	static void print();
 #endif // __U_STATISTICS__
@@ -160,29 +202,133 @@ namespace UPP {
 	// must be first fields for alignment
 	FreeHeader freeLists[NoBucketSizes];		// buckets for different allocation sizes
 	uSpinLock extlock;				// protects allocation-buffer extension
+	uSpinLock trimlock;				// only one trim at a time
+	uSpinLock arenaLock;				// protects list of arenas
 
 	void *heapBegin;				// start of heap
 	void *heapEnd;					// logical end of heap
 	size_t heapRemaining;				// amount of storage not allocated in the current chunk
 
+	// An arena carves its storage in chunks from the shared heap, so every bucket block lies within the shared heap's
+	// [heapBegin, heapEnd] and the header's home pointer routes a free back to the owning arena's list.
+
+	uHeapManager *nextArena;			// list of all arenas
+	const char *arenaName;				// name of owning cluster, NULL => arena unused
+	size_t arenaChunkStorage;			// storage carved from the shared heap, protected by extlock
+#ifdef __U_STATISTICS__
+	unsigned int arenaMallocCalls;			// arena accounting (bucket storage only)
+	unsigned long long int arenaMallocStorage;
+	unsigned int arenaFreeCalls;
+	unsigned long long int arenaFreeStorage;
+#endif // __U_STATISTICS__
+
 	static void boot();
 	static void noMemory();				// called by "builtin_new" when malloc returns 0
 	static void checkAlign( size_t alignment );
 	static bool setHeapExpand( size_t value );
 	static bool setMmapStart( size_t value );
+	static bool setTrimThreshold( size_t value );
+	static bool setHugePages( int value );
+	static uHeapManager *arena();
+#ifdef __U_DEBUG__
+	static bool checkHome( FreeHeader *freeElem );
+#endif // __U_DEBUG__
+	static uHeapManager *arenaAcquire( const char *name );
+	static void arenaRelease( uHeapManager *arena );
 
 	bool headers( const char *name, void *addr, Storage::Header *&header, FreeHeader *&freeElem, size_t &size, size_t &alignment );
 	void *extend( size_t size );
 	void *doMalloc( size_t size );
 	void doFree( void *addr );
+	size_t trim( size_t pad );
+	size_t releaseFree();
+
+	// Called by a processor with no ready tasks: trim when enough large-bucket storage has been freed.
+	static void trimIdle() {
+	  if ( __builtin_expect( trimPending < trimThreshold, 1 ) ) return;
+	    heapManagerInstance->trim( 0 );
+	} // uHeapManager::trimIdle
+	size_t arenaStorage();
 	size_t checkFree( bool prt = false );
 	uHeapManager();
+	uHeapManager( const char *name );
 	~uHeapManager();
 
 	void *operator new( size_t, void *storage );
 	void *operator new( size_t size );
       public:
     }; // uHeapManager
+
+
+    // Sampling heap profiler. Each task counts down the bytes it allocates; when the count reaches zero, the allocation
+    // is sampled (call stack recorded, block marked in its header) and a new count is drawn from an exponential
+    // distribution with the sampling interval as mean, so sampled allocations form a Poisson process over bytes. Frees
+    // of marked blocks subtract from the site's live storage. The tables are updated with atomic instructions, so
+    // sampled allocations and frees take no lock. The profile is written in the pprof legacy heap format, on request by
+    // malloc_sample_dump, or by a dump task when the signal set with mallopt( M_SAMPLE_SIGNAL ) arrives.
+
+    class uHeapSampler {
+	friend void *::malloc( size_t size ) __THROW;	// access: interval, sample
+	friend void *::memalign( size_t alignment, size_t size ) __THROW; // access: interval, sample
+	friend int ::mallopt( int param_number, int value ) __THROW; // access: setInterval, setSignal
+	friend int ::malloc_sample_dump( int fd ) __THROW; // access: dump
+	friend class uHeapManager;			// access: freed
+	friend class ::uBaseTask;			// access: initialSample
+	friend _Coroutine uProcessorKernel;		// access: dumpRequested, dumpPending
+	friend _Task uHeapDumper;			// access: dumpFile
+	friend class uKernelBoot;			// access: finishup
+
+	enum { MaxDepth = 32,				// maximum stack frames per site
+	       SiteTableSize = 4096,			// power of 2
+	       BlockTableSize = 65536,			// power of 2, maximum live sampled blocks
+	};
+
+	struct Site {
+	    size_t hash;
+	    unsigned int depth;
+	    void *pcs[MaxDepth];
+	    unsigned long long int allocCount, allocBytes;
+	    unsigned long long int liveCount, liveBytes;
+	}; // Site
+
+	struct Block {
+	    void *key;					// real header of sampled block, NULL => empty, Deleted => tombstone
+	    Site *site;
+	    size_t size;				// requested size
+	}; // Block
+
+	static size_t interval;				// mean bytes between samples, 0 => off
+	static uSpinLock lock;				// protects creation of tables and dump task
+	static Site *sites;				// hash table of call sites
+	static Block *blocks;				// hash table of live sampled blocks
+	static unsigned long long int dropped;		// samples not recorded because a table is full
+	static unsigned long long int randomState;
+	static volatile bool dumpRequested;		// set by signal handler
+	static unsigned int dumpCount;
+	static int dumpSignal;				// 0 => no signal requests dumps
+	static uHeapDumper *dumper;			// writes requested dumps
+
+	static bool setInterval( size_t value );
+	static bool setSignal( int sig );
+	static long int nextSample();
+	static long int initialSample();
+	static bool record( uBaseTask &task, void *key, size_t size );
+	static void freed( void *key );
+	static int dump( int fd );
+	static void dumpFile();
+	static void dumpPending();
+	static void sigDumpHandler( __U_SIGPARMS__ );
+	static void finishup();
+
+	// Called for every allocation when sampling is on; returns true if the block is sampled.
+	static bool sample( void *key, size_t size ) {
+	    uBaseTask *task = THREAD_GETMEM( activeTask );
+	  if ( task == NULL ) return false;		// kernel not booted
+	    task->heapSampleBytes -= size;
+	  if ( __builtin_expect( task->heapSampleBytes > 0, 1 ) ) return false;
+	    return record( *task, key, size );
+	} // uHeapSampler::sample
+    }; // uHeapSampler
 } // UPP
 
 
@@ -0,0 +1,345 @@
+//                              -*- Mode: C++ -*- 
+// 
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+// 
+// uHeapSampler.cc -- sampling heap profiler
+// 
+// Author           : agent
+// Created On       : Mon Oct 19 01:03:28 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 02:44:10 2026
+// Update Count     : 3
+// 
+// This  library is free  software; you  can redistribute  it and/or  modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software  Foundation; either  version 2.1 of  the License, or  (at your
+// option) any later version.
+// 
+// This library is distributed in the  hope that it will be useful, but WITHOUT
+// ANY  WARRANTY;  without even  the  implied  warranty  of MERCHANTABILITY  or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+// 
+// You should  have received a  copy of the  GNU Lesser General  Public License
+// along  with this library.
+// 
+
+#define __U_KERNEL__
+#include <uC++.h>
+#include <uHeapLmmm.h>
+#include "uInstrument.h"
+//#include <uDebug.h>
+
+#include <cmath>					// log
+#include <climits>					// LONG_MAX
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>					// open
+#include <unistd.h>					// read, close, getpid
+
+extern "C" {
+    typedef _Unwind_Reason_Code (*_Unwind_Trace_Fn)( struct _Unwind_Context *, void * );
+    extern _Unwind_Reason_Code _Unwind_Backtrace( _Unwind_Trace_Fn, void * );
+} // extern "C"
+
+
+namespace UPP {
+    size_t uHeapSampler::interval = 0;
+    uSpinLock uHeapSampler::lock;
+    uHeapSampler::Site *uHeapSampler::sites = NULL;
+    uHeapSampler::Block *uHeapSampler::blocks = NULL;
+    unsigned long long int uHeapSampler::dropped = 0;
+    unsigned long long int uHeapSampler::randomState = 0;
+    volatile bool uHeapSampler::dumpRequested = false;
+    unsigned int uHeapSampler::dumpCount = 0;
+    int uHeapSampler::dumpSignal = 0;
+    uHeapDumper *uHeapSampler::dumper = NULL;
+
+#   define Deleted ((void *)1)				// block-table tombstone
+#   define Claimed ((void *)2)				// block-table entry being filled
+    enum { MaxProbes = 128 };				// bound search of block table
+
+    struct Trace {
+	void **pcs;
+	unsigned int depth, skip, max;
+    }; // Trace
+
+    static _Unwind_Reason_Code traceFrame( struct _Unwind_Context *context, void *arg ) {
+	Trace &trace = *(Trace *)arg;
+	if ( trace.skip > 0 ) {				// ignore sampler and allocation routines
+	    trace.skip -= 1;
+	    return _URC_NO_REASON;
+	} // if
+      if ( trace.depth == trace.max ) return _URC_END_OF_STACK;
+	trace.pcs[trace.depth] = (void *)_Unwind_GetIP( context );
+	trace.depth += 1;
+	return _URC_NO_REASON;
+    } // traceFrame
+
+    static inline size_t hashKey( void *key ) {
+	return (size_t)(((unsigned long long int)(uintptr_t)key >> 4) * 0x9e3779b97f4a7c15ULL >> 16);
+    } // hashKey
+
+
+    bool uHeapSampler::setInterval( size_t value ) {
+      if ( value > LONG_MAX / 2 ) return true;		// negative mallopt value ?
+	if ( value != 0 && sites == NULL ) {		// first enable ?
+	    lock.acquire();
+	    if ( sites == NULL ) {			// tables used inside malloc and free
+		void *s = uInstrument::table( SiteTableSize * sizeof(Site) );
+		void *b = uInstrument::table( BlockTableSize * sizeof(Block) );
+		if ( s == NULL || b == NULL ) {
+		    if ( s != NULL ) munmap( s, SiteTableSize * sizeof(Site) );
+		    if ( b != NULL ) munmap( b, BlockTableSize * sizeof(Block) );
+		    lock.release();
+		    return true;
+		} // if
+		blocks = (Block *)b;
+		sites = (Site *)s;
+	    } // if
+	    lock.release();
+	} // if
+	interval = value;
+	return false;
+    } // uHeapSampler::setInterval
+
+
+    // Exponentially distributed byte count with mean "interval". The uniform variate is splitmix64 of a shared counter,
+    // so concurrent draws need only an atomic add.
+
+    long int uHeapSampler::nextSample() {
+	unsigned long long int z = __atomic_add_fetch( &randomState, 0x9e3779b97f4a7c15ULL, __ATOMIC_RELAXED );
+	z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+	z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+	z ^= z >> 31;
+	double u = ( z >> 11 ) * ( 1.0 / 9007199254740992.0 ); // [0,1)
+	double next = -log( 1.0 - u ) * interval;
+	if ( next < 1.0 ) return 1;
+	if ( next > LONG_MAX / 2 ) return LONG_MAX / 2;
+	return (long int)next;
+    } // uHeapSampler::nextSample
+
+
+    // First count for a new task, so its first allocation is not always sampled. Zero => sampling off when the task was
+    // created, so the task's first allocation after sampling is turned on is sampled.
+
+    long int uHeapSampler::initialSample() {
+      if ( interval == 0 ) return 0;
+	return nextSample();
+    } // uHeapSampler::initialSample
+
+
+    // Sites and blocks are claimed with a compare-and-swap and then filled; a site is matched only after its stack is
+    // published (depth set), so a racing allocation from the same stack may start a second entry for the site, which
+    // pprof merges.
+
+    bool uHeapSampler::record( uBaseTask &task, void *key, size_t size ) {
+	task.heapSampleBytes = LONG_MAX;		// allocations by the unwinder are not sampled
+
+	void *pcs[MaxDepth];
+	Trace trace = { pcs, 0, 2, MaxDepth };		// skip record and malloc/memalign
+	_Unwind_Backtrace( traceFrame, &trace );
+	if ( trace.depth == 0 ) {			// unwind failed ?
+	    pcs[0] = __builtin_return_address( 0 );
+	    trace.depth = 1;
+	} // if
+	size_t hash = 0xcbf29ce484222325ULL & (size_t)-1; // FNV-1a
+	for ( unsigned int i = 0; i < trace.depth; i += 1 ) {
+	    hash = ( hash ^ (uintptr_t)pcs[i] ) * (size_t)0x100000001b3ULL;
+	} // for
+	if ( hash == 0 ) hash = 1;			// 0 => empty site
+
+	bool sampled = false;
+	Site *site = NULL;
+	for ( size_t i = hash & (SiteTableSize - 1), probe = 0; probe < SiteTableSize; probe += 1, i = (i + 1) & (SiteTableSize - 1) ) {
+	    Site &s = sites[i];
+	    size_t h = __atomic_load_n( &s.hash, __ATOMIC_ACQUIRE );
+	    if ( h == 0 && __atomic_compare_exchange_n( &s.hash, &h, hash, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) ) { // empty => new site
+		memcpy( s.pcs, pcs, trace.depth * sizeof(void *) );
+		__atomic_store_n( &s.depth, trace.depth, __ATOMIC_RELEASE ); // publish stack
+		site = &s;
+		break;
+	    } // if
+	    if ( h == hash && __atomic_load_n( &s.depth, __ATOMIC_ACQUIRE ) == trace.depth && memcmp( s.pcs, pcs, trace.depth * sizeof(void *) ) == 0 ) {
+		site = &s;
+		break;
+	    } // if
+	} // for
+
+	if ( site == NULL ) {				// site table full ?
+	    __atomic_fetch_add( &dropped, 1, __ATOMIC_RELAXED );
+	} else {
+	    __atomic_fetch_add( &site->allocCount, 1, __ATOMIC_RELAXED );
+	    __atomic_fetch_add( &site->allocBytes, size, __ATOMIC_RELAXED );
+	    for ( size_t i = hashKey( key ) & (BlockTableSize - 1), probe = 0; probe < MaxProbes; probe += 1, i = (i + 1) & (BlockTableSize - 1) ) {
+		Block &b = blocks[i];
+		void *k = __atomic_load_n( &b.key, __ATOMIC_ACQUIRE );
+		if ( ( k == NULL || k == Deleted ) && __atomic_compare_exchange_n( &b.key, &k, Claimed, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) ) {
+		    b.site = site;
+		    b.size = size;
+		    __atomic_fetch_add( &site->liveCount, 1, __ATOMIC_RELAXED );
+		    __atomic_fetch_add( &site->liveBytes, size, __ATOMIC_RELAXED );
+		    __atomic_store_n( &b.key, key, __ATOMIC_RELEASE ); // publish block
+		    sampled = true;
+		    break;
+		} // if
+	    } // for
+	    if ( ! sampled ) __atomic_fetch_add( &dropped, 1, __ATOMIC_RELAXED ); // counted in total but not tracked as live
+	} // if
+	task.heapSampleBytes = nextSample();
+
+	dumpPending();
+	return sampled;
+    } // uHeapSampler::record
+
+
+    // A block is freed only after its malloc returns, so its entry is published; a NULL entry ends the search because
+    // entries are never emptied, only marked deleted.
+
+    void uHeapSampler::freed( void *key ) {
+	for ( size_t i = hashKey( key ) & (BlockTableSize - 1), probe = 0; probe < MaxProbes; probe += 1, i = (i + 1) & (BlockTableSize - 1) ) {
+	    Block &b = blocks[i];
+	    void *k = __atomic_load_n( &b.key, __ATOMIC_ACQUIRE );
+	  if ( k == NULL ) break;			// not found
+	    if ( k == key ) {
+		__atomic_fetch_sub( &b.site->liveCount, 1, __ATOMIC_RELAXED );
+		__atomic_fetch_sub( &b.site->liveBytes, b.size, __ATOMIC_RELAXED );
+		__atomic_store_n( &b.key, Deleted, __ATOMIC_RELEASE );
+		break;
+	    } // if
+	} // for
+    } // uHeapSampler::freed
+
+
+    // Write the profile in the pprof legacy heap format, which pprof unsamples using the heap_v2 interval. Allocations
+    // and frees during the dump are partially reflected.
+
+    int uHeapSampler::dump( int fd ) {
+      if ( sites == NULL ) return -1;			// sampling never enabled
+	enum { BufferSize = 1024 };
+	char buffer[BufferSize];
+	int len, rc = 0;
+
+	unsigned long long int liveCount = 0, liveBytes = 0, allocCount = 0, allocBytes = 0;
+	for ( unsigned int i = 0; i < SiteTableSize; i += 1 ) {
+	    liveCount += sites[i].liveCount;
+	    liveBytes += sites[i].liveBytes;
+	    allocCount += sites[i].allocCount;
+	    allocBytes += sites[i].allocBytes;
+	} // for
+	len = snprintf( buffer, BufferSize, "heap profile: %6llu: %8llu [%6llu: %8llu] @ heap_v2/%zu\n",
+			liveCount, liveBytes, allocCount, allocBytes, interval );
+	rc |= uInstrument::writeAll( fd, buffer, len );
+	for ( unsigned int i = 0; i < SiteTableSize && rc == 0; i += 1 ) {
+	    Site &s = sites[i];
+	    unsigned int depth = __atomic_load_n( &s.depth, __ATOMIC_ACQUIRE );
+	  if ( depth == 0 ) continue;			// empty or stack not published
+	    len = snprintf( buffer, BufferSize, "%6llu: %8llu [%6llu: %8llu] @", s.liveCount, s.liveBytes, s.allocCount, s.allocBytes );
+	    for ( unsigned int d = 0; d < depth; d += 1 ) { // 32 frames * 19 characters fit in the buffer
+		len += snprintf( buffer + len, BufferSize - len, " 0x%lx", (unsigned long int)(uintptr_t)s.pcs[d] );
+	    } // for
+	    len += snprintf( buffer + len, BufferSize - len, "\n" );
+	    rc |= uInstrument::writeAll( fd, buffer, len );
+	} // for
+
+	// Mapped libraries allow pprof to symbolize addresses in shared objects and position-independent executables.
+	len = snprintf( buffer, BufferSize, "\nMAPPED_LIBRARIES:\n" );
+	rc |= uInstrument::writeAll( fd, buffer, len );
+	int maps = open( "/proc/self/maps", O_RDONLY );
+	if ( maps != -1 ) {
+	    while ( rc == 0 && ( len = ::read( maps, buffer, BufferSize ) ) > 0 ) {
+		rc |= uInstrument::writeAll( fd, buffer, len );
+	    } // while
+	    close( maps );
+	} // if
+	return rc;
+    } // uHeapSampler::dump
+
+
+    void uHeapSampler::dumpFile() {
+      if ( sites == NULL ) return;			// sampling never enabled
+	char name[64];
+	snprintf( name, sizeof(name), "uheap.%ld.%u.heap", (long int)getpid(), uFetchAdd( dumpCount, 1 ) );
+	uInstrument::writeFile( name, dump );
+    } // uHeapSampler::dumpFile
+
+
+    // Wake the dump task for a dump requested by the signal. Called at safe points: a sampled allocation in a busy
+    // program, and the processor idle loop, which the signal wakes from pselect/sigsuspend when the program is idle. The
+    // dump is written by the task, not here, because the idle loop runs on the scheduler stack.
+
+    void uHeapSampler::dumpPending() {
+      if ( ! dumpRequested || ! __atomic_exchange_n( &dumpRequested, false, __ATOMIC_ACQUIRE ) ) return; // one caller wakes
+	dumper->wake.V();
+    } // uHeapSampler::dumpPending
+
+
+    // Writing the profile is not async-signal-safe (locks), so the signal only requests a dump (see dumpPending).
+
+    void uHeapSampler::sigDumpHandler( __U_SIGPARMS__ ) {
+	dumpRequested = true;
+    } // uHeapSampler::sigDumpHandler
+
+
+    _Task uHeapDumper {
+	friend class uHeapSampler;			// access: wake, stop
+
+	UPP::uSemaphore wake;				// dump requested or stop
+	volatile bool stop;
+
+	void main() {
+	    for ( ;; ) {
+		wake.P();
+	      if ( stop ) break;
+		uHeapSampler::dumpFile();
+	    } // for
+	} // uHeapDumper::main
+      public:
+	uHeapDumper() : uBaseTask( *uKernelModule::systemCluster ), wake( 0 ), stop( false ) {}
+    }; // uHeapDumper
+
+
+    // Dumps on a signal are opt in, because the signal may be used by the program. The dump task and handler are
+    // created once, after the kernel starts, and remain until shutdown.
+
+    bool uHeapSampler::setSignal( int sig ) {
+      if ( sig <= 0 || sig >= NSIG || THREAD_GETMEM( activeTask ) == NULL ) return true; // kernel not booted ?
+	uHeapDumper *d = new uHeapDumper;		// creating a task may block, so not under the spin lock
+	lock.acquire();
+	bool set = dumpSignal == 0;
+	if ( set ) {
+	    dumper = d;
+	    dumpSignal = sig;
+	} // if
+	lock.release();
+	if ( ! set ) {					// only one dump signal
+	    d->stop = true;
+	    d->wake.V();
+	    delete d;
+	    return true;
+	} // if
+	uSigHandlerModule::signal( sig, sigDumpHandler, SA_SIGINFO | SA_RESTART );
+	return false;
+    } // uHeapSampler::setSignal
+
+
+    void uHeapSampler::finishup() {
+      if ( dumper == NULL ) return;
+	dumper->stop = true;
+	dumper->wake.V();
+	delete dumper;					// wait for a dump in progress
+	dumper = NULL;
+    } // uHeapSampler::finishup
+} // UPP
+
+
+extern "C" {
+    int malloc_sample_dump( int fd ) __THROW {
+	return UPP::uHeapSampler::dump( fd );
+    } // malloc_sample_dump
+} // extern "C"
+
+
+// Local Variables: //
+// compile-command: "make install" //
+// End: //
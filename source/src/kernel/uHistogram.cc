@@ -0,0 +1,86 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// uHistogram.cc -- log-linear (HDR) histogram of durations
+//
+// Author           : agent
+// Created On       : Mon Oct 19 02:01:02 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 02:40:15 2026
+// Update Count     : 2
+//
+// This  library is free  software; you  can redistribute  it and/or  modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software  Foundation; either  version 2.1 of  the License, or  (at your
+// option) any later version.
+//
+// This library is distributed in the  hope that it will be useful, but WITHOUT
+// ANY  WARRANTY;  without even  the  implied  warranty  of MERCHANTABILITY  or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+//
+// You should  have received a  copy of the  GNU Lesser General  Public License
+// along  with this library.
+//
+
+#define __U_KERNEL__
+#include <uC++.h>
+#include <uHistogram.h>
+
+
+void uHistogram::reset() {
+    for ( unsigned int i = 0; i < Buckets; i += 1 ) counts[i] = 0;
+    total = sum = max = 0;
+} // uHistogram::reset
+
+
+void uHistogram::merge( const uHistogram &other ) {
+    for ( unsigned int i = 0; i < Buckets; i += 1 ) counts[i] += other.counts[i];
+    total += other.total;
+    sum += other.sum;
+    if ( other.max > max ) max = other.max;
+} // uHistogram::merge
+
+
+// The highest value in the bucket holding the percentile, so the result never understates, capped by the largest value
+// recorded.
+
+unsigned long long int uHistogram::percentile( double percent ) const {
+    unsigned long long int n = total;
+  if ( n == 0 ) return 0;
+    unsigned long long int rank = (unsigned long long int)( percent / 100.0 * n + 0.5 );
+    if ( rank == 0 ) rank = 1;
+
+    unsigned long long int seen = 0;
+    for ( unsigned int i = 0; i < Buckets; i += 1 ) {
+	seen += counts[i];
+      if ( seen >= rank ) {
+	    unsigned long long int high;
+	    if ( i < SubBuckets ) {			// exact
+		high = i;
+	    } else {
+		unsigned int shift = i / SubBuckets - 1;
+		high = ( ( (unsigned long long int)( SubBuckets + i % SubBuckets ) + 1 ) << shift ) - 1;
+	    } // if
+	    return high < max ? high : max;
+	} // if
+    } // for
+    return max;						// counts still being updated
+} // uHistogram::percentile
+
+
+unsigned long long int uHistogram::now() {
+    return uClock::monotonic();				// same clock as dispatch times
+} // uHistogram::now
+
+
+unsigned long long int uHistogram::since( unsigned long long int start ) {
+    unsigned long long int curr = now();
+    return curr > start ? curr - start : 0;		// see uClock::monotonic
+} // uHistogram::since
+
+
+// Local Variables: //
+// compile-command: "make install" //
+// End: //
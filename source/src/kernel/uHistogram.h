@@ -0,0 +1,85 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// uHistogram.h -- log-linear (HDR) histogram of durations
+//
+// Author           : agent
+// Created On       : Mon Oct 19 02:01:02 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 02:40:15 2026
+// Update Count     : 2
+//
+// This  library is free  software; you  can redistribute  it and/or  modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software  Foundation; either  version 2.1 of  the License, or  (at your
+// option) any later version.
+//
+// This library is distributed in the  hope that it will be useful, but WITHOUT
+// ANY  WARRANTY;  without even  the  implied  warranty  of MERCHANTABILITY  or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+//
+// You should  have received a  copy of the  GNU Lesser General  Public License
+// along  with this library.
+//
+
+
+#ifndef __U_HISTOGRAM_H__
+#define __U_HISTOGRAM_H__
+
+
+// Values, in nanoseconds, are counted in buckets whose width doubles with each power of 2, each power split into
+// SubBuckets linear buckets, so any value from 0 to 2^64-1 is recorded in fixed space with a relative error of at most
+// 1 / SubBuckets (6.25%). Recording is a few atomic adds and takes no lock, so any processor may record, including with
+// interrupts disabled in the kernel; reading while others record gives a consistent enough snapshot for reporting. To
+// keep recording free of cache-line sharing, each processor records into its own histograms, which are merged on read.
+
+class uHistogram {
+  public:
+    enum { SubBits = 4, SubBuckets = 1 << SubBits, Buckets = ( 65 - SubBits ) * SubBuckets };
+  private:
+    volatile unsigned long long int counts[Buckets];
+    volatile unsigned long long int total, sum, max;
+
+    static unsigned int bucket( unsigned long long int value ) {
+      if ( value < SubBuckets ) return value;		// exact
+	unsigned int msb = 63 - __builtin_clzll( value );
+	return ( msb - SubBits + 1 ) * SubBuckets + ( value >> ( msb - SubBits ) ) - SubBuckets;
+    } // uHistogram::bucket
+
+    uHistogram( uHistogram & );				// no copy
+    uHistogram &operator=( uHistogram & );		// no assignment
+  public:
+    uHistogram() {
+	reset();
+    } // uHistogram::uHistogram
+
+    void record( unsigned long long int value ) {
+	__atomic_fetch_add( &counts[bucket( value )], 1, __ATOMIC_RELAXED );
+	__atomic_fetch_add( &total, 1, __ATOMIC_RELAXED );
+	__atomic_fetch_add( &sum, value, __ATOMIC_RELAXED );
+	for ( unsigned long long int m = max; value > m; m = max ) {
+	  if ( __atomic_compare_exchange_n( &max, &m, value, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) ) break;
+	} // for
+    } // uHistogram::record
+
+    void reset();
+    void merge( const uHistogram &other );		// add other's values, not concurrently with record on this
+
+    unsigned long long int count() const { return total; }
+    unsigned long long int maximum() const { return max; }
+    double mean() const { return total == 0 ? 0.0 : (double)sum / total; }
+    unsigned long long int percentile( double percent ) const; // value at or below which percent of the values lie
+
+    static unsigned long long int now();		// nanoseconds, from uClock::monotonic
+    static unsigned long long int since( unsigned long long int start ); // nanoseconds from start to now, >= 0
+}; // uHistogram
+
+
+#endif // __U_HISTOGRAM_H__
+
+
+// Local Variables: //
+// compile-command: "make install" //
+// End: //
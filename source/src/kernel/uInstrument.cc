@@ -0,0 +1,101 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// uInstrument.cc --
+//
+// Author           : agent
+// Created On       : Mon Oct 19 02:44:10 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 02:44:10 2026
+// Update Count     : 1
+//
+// This  library is free  software; you  can redistribute  it and/or  modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software  Foundation; either  version 2.1 of  the License, or  (at your
+// option) any later version.
+//
+// This library is distributed in the  hope that it will be useful, but WITHOUT
+// ANY  WARRANTY;  without even  the  implied  warranty  of MERCHANTABILITY  or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+//
+// You should  have received a  copy of the  GNU Lesser General  Public License
+// along  with this library.
+//
+
+#define __U_KERNEL__
+#include <uC++.h>
+#include "uInstrument.h"
+//#include <uDebug.h>
+
+#include <cerrno>
+#include <cstdlib>					// getenv, strtoul
+#include <cstring>					// strchr, strlen, memcpy
+#include <fcntl.h>					// open
+#include <unistd.h>					// write, close
+#include <sys/mman.h>					// mmap
+
+
+namespace UPP {
+    const char *uInstrument::option( const char *var, char *file, size_t size, unsigned int *param ) {
+	const char *value = getenv( var );
+      if ( value == NULL || *value == '\0' ) return NULL;
+
+	const char *comma = param == NULL ? NULL : strchr( value, ',' );
+	size_t len = comma == NULL ? strlen( value ) : comma - value;
+	if ( len >= size ) len = size - 1;
+	memcpy( file, value, len );
+	file[len] = '\0';
+	if ( comma != NULL && comma[1] != '\0' ) *param = strtoul( comma + 1, NULL, 10 );
+	return value;
+    } // uInstrument::option
+
+
+    void *uInstrument::table( size_t size ) {
+	void *storage = ::mmap( 0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE |
+#if defined( __freebsd__ )
+				MAP_ANON,
+#else
+				MAP_ANONYMOUS,
+#endif // __freebsd__
+				-1, 0 );
+	return storage == MAP_FAILED ? NULL : storage;
+    } // uInstrument::table
+
+
+    int uInstrument::writeFile( const char *name, int (*writer)( int fd ) ) {
+	int fd = ::open( name, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+      if ( fd == -1 ) return -1;
+	int rc = writer( fd );
+	if ( ::close( fd ) == -1 ) rc = -1;
+	return rc;
+    } // uInstrument::writeFile
+
+
+    int uInstrument::writeAll( int fd, const char *buffer, size_t len ) {
+	for ( size_t count = 0; count < len; ) {
+	    ssize_t retcode = ::write( fd, buffer + count, len - count );
+	    if ( retcode == -1 ) {
+	      if ( errno != EINTR ) return -1;
+		continue;
+	    } // if
+	    count += retcode;
+	} // for
+	return 0;
+    } // uInstrument::writeAll
+
+
+    void uInstrument::copyName( char *to, const char *from, unsigned int size ) {
+	unsigned int i = 0;
+	if ( from != NULL ) {
+	    for ( ; i < size - 1 && from[i] != '\0'; i += 1 ) to[i] = from[i];
+	} // if
+	to[i] = '\0';
+    } // uInstrument::copyName
+} // UPP
+
+
+// Local Variables: //
+// compile-command: "make install" //
+// End: //
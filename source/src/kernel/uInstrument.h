@@ -0,0 +1,64 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// uInstrument.h -- support shared by the profilers, tracer and counters
+//
+// Author           : agent
+// Created On       : Mon Oct 19 02:44:10 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 02:44:10 2026
+// Update Count     : 1
+//
+// This  library is free  software; you  can redistribute  it and/or  modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software  Foundation; either  version 2.1 of  the License, or  (at your
+// option) any later version.
+//
+// This library is distributed in the  hope that it will be useful, but WITHOUT
+// ANY  WARRANTY;  without even  the  implied  warranty  of MERCHANTABILITY  or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+//
+// You should  have received a  copy of the  GNU Lesser General  Public License
+// along  with this library.
+//
+
+
+#ifndef __U_INSTRUMENT_H__
+#define __U_INSTRUMENT_H__
+
+
+#include <cstddef>					// size_t
+
+
+namespace UPP {
+    class uInstrument {
+      public:
+	// Environment variable of the form file[,param], e.g., UPROFILE=cpu.prof,200. Copies the file name (truncated to
+	// size) and, if param is not NULL and a value follows the comma, sets *param. Returns the variable's value, NULL
+	// => unset or empty.
+	static const char *option( const char *var, char *file, size_t size, unsigned int *param );
+
+	// Zero-filled storage from mmap rather than malloc, because instrumentation tables are used where the heap cannot
+	// be called: in signal handlers, with spin locks held, or inside the allocator. NULL => no storage.
+	static void *table( size_t size );
+
+	// Create (or truncate) the named file, write it with writer, and close it. Returns 0, or -1 on any failure.
+	static int writeFile( const char *name, int (*writer)( int fd ) );
+
+	// Write all of buffer, retrying partial writes and interrupts. Returns 0, or -1 on failure.
+	static int writeAll( int fd, const char *buffer, size_t len );
+
+	// Copy a name, truncated to size - 1 characters and terminated; NULL => empty. Safe in a signal handler.
+	static void copyName( char *to, const char *from, unsigned int size );
+    }; // uInstrument
+} // UPP
+
+
+#endif // __U_INSTRUMENT_H__
+
+
+// Local Variables: //
+// compile-command: "make install" //
+// End: //
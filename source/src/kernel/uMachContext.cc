@@ -32,6 +32,8 @@
 #include <uProfiler.h>
 #endif // __U_PROFILER__
 #include <uHeapLmmm.h>
+#include <uPerfCounters.h>
+#include <uStackProfiler.h>
 
 #include <uDebug.h>					// access: uDebugWrite
 #undef __U_DEBUG_H__					// turn off debug prints
@@ -164,6 +166,7 @@ namespace UPP {
 	    pthread_deletespecific_( This.pthreadData );
 	} // if
 
+	uPerfCounters::finishTask( This );
 	uHeapControl::finishTask();
 
 	This.notHalted = false;
@@ -412,6 +415,9 @@ namespace UPP {
 	context = base;
 	top = (char *)context + cxtSize;
 
+	stackFilled = uStackProfiler::filling();
+	if ( stackFilled ) uStackProfiler::fill( limit, base );
+
 	extras.allExtras = 0;
     } // uMachContext::createContext
 
@@ -28,6 +28,10 @@
 // WARNING: The poller task uses uYieldNoPoll so that nonlocal exceptions and
 // cancellation cannot occur while it is conceptually blocked on an I/O
 // operation.
+//
+// For the multiprocessor, there is no poller task: a processor kernel polls
+// on behalf of the waiting tasks when its ready queues are empty, and blocks
+// in pselect rather than pausing when its spin expires.
 // ***************************************************************************
 
 
@@ -36,6 +40,8 @@
 
 #include <uC++.h>
 #include <uIOcntl.h>
+#include <uTracer.h>
+#include <uHistogram.h>
 //#include <uDebug.h>
 
 #include <algorithm>
@@ -261,6 +267,117 @@ namespace UPP {
     } // uNBIO::select
 
 
+#if defined( __U_MULTI__ )
+    /********************* poll *********************
+	Purpose: Poll for I/O on behalf of the waiting tasks; called by a processor kernel when its ready queues are
+	         empty, and periodically by a busy processor kernel
+	Effect: Tasks whose I/O completed or timed out are made ready on the cluster, where the polling processor
+		picks them up next. When block is true and no work arrives, the processor blocks in pselect rather
+		than pausing, so one processor per cluster waits for I/O events.
+	Return: number of tasks woken, or -1 if no polling occurred because nothing is pending or another processor
+		on the cluster is polling
+    **************************************************/
+    int uNBIO::poll( bool block ) {
+	assert( THREAD_GETMEM( disableInt ) && THREAD_GETMEM( disableIntCnt ) > 0 );
+
+      if ( pending == 0 ) return -1;			// optimization: racy check, rechecked under the lock
+      if ( ! pollLock.tryacquire() ) return -1;		// another processor is polling for this cluster
+
+	lock.acquire();
+	if ( pending == 0 ) {				// waiting tasks woken by another processor ?
+	    lock.release();
+	    pollLock.release();
+	    return -1;
+	} // if
+	checkIOStart();					// merge master masks for pselect
+	unsigned int generation = registrations;
+	unsigned int waiting = pending;
+	lock.release();
+
+#ifdef __U_STATISTICS__
+	uFetchAdd( Statistics::iopoller_kernel, 1 );
+#endif // __U_STATISTICS__
+
+	// Note, pselect occurs outside of the lock, so that tasks can register interest in other I/O events.
+
+	uProcessor &processor = uThisProcessor();
+	uCluster &cluster = processor.getCluster();
+	int terrno;
+
+	selectBlock = false;				// default is polling
+	if ( ! block || timeoutOccurred ) {		// poll only or timeouts to process ?
+	    terrno = select( NULL );
+	} else {
+	    if ( processor.getPreemption() != 0 ) {	// optimize out UNIX call if possible
+		processor.setContextSwitchEvent( 0 );	// turn off preemption to prevent waking UNIX processor
+	    } // if
+
+	    // Block any SIGALRM/SIGUSR1 signals from external sources so a wakeup arriving after the checks below
+	    // interrupts the pselect rather than being lost.
+	    sigset_t new_mask, old_mask;
+	    sigemptyset( &new_mask );
+	    sigemptyset( &old_mask );
+	    sigaddset( &new_mask, SIGALRM );
+	    sigaddset( &new_mask, SIGUSR1 );
+	    if ( sigprocmask( SIG_BLOCK, &new_mask, &old_mask ) == -1 ) {
+		uAbort( "internal error, sigprocmask" );
+	    } // if
+
+	    IOPollerPid = processor.getPid();		// registrations now wake this processor
+	    __sync_synchronize();			// publish IOPollerPid before rechecking registrations
+
+	    cluster.readyIdleTaskLock.acquire();
+	    if ( ! cluster.readyQueueEmpty() || ! processor.external.empty() || // work arrived ?
+		 generation != registrations ||	// I/O registered after the masks were merged ?
+		 ( ! THREAD_GETMEM( RFinprogress ) && THREAD_GETMEM( RFpending ) ) ) { // interrupt won race ?
+		cluster.readyIdleTaskLock.release();
+		IOPollerPid = (uPid_t)-1;
+		if ( sigprocmask( SIG_SETMASK, &old_mask, NULL ) == -1 ) {
+		    uAbort( "internal error, sigprocmask" );
+		} // if
+		terrno = select( NULL );		// poll for descriptors
+	    } else {
+		// Tasks migrating to a cluster wake a processor. When there is more than one processor on a cluster, do
+		// not signal the one blocked on select (by not putting it on the idle list), otherwise there can be a
+		// large number of unnecessary EINTR restarts for the select.
+
+		if ( cluster.getProcessors() == 1 )	// must go on idle queue if only process
+		    cluster.makeProcessorIdle( processor );
+		cluster.readyIdleTaskLock.release();
+
+		selectBlock = true;			// going to block
+#ifdef __U_STATISTICS__
+		uFetchAdd( Statistics::select_blocking, 1 );
+#endif // __U_STATISTICS__
+		terrno = select( &old_mask );
+
+		if ( sigprocmask( SIG_SETMASK, &old_mask, NULL ) == -1 ) { // new mask restored so install old signal mask over new one
+		    uAbort( "internal error, sigprocmask" );
+		} // if
+
+		if ( processor.idle() )
+		    cluster.makeProcessorActive( processor );
+	    } // if
+
+	    if ( processor.getPreemption() != 0 ) {	// optimize out UNIX call if possible
+		processor.setContextSwitchEvent( processor.getPreemption() ); // reset processor preemption time
+	    } // if
+	} // if
+
+	lock.acquire();
+	wakeIO( terrno );				// make ready the tasks whose I/O completed or timed out
+	int woken = waiting + ( registrations - generation ) - pending; // pending includes new registrations
+	lock.release();
+	pollLock.release();
+
+	// rollForward is called by uProcessorKernel::main explicitly during spinning or implicitly by enableInterrupts on
+	// the backside of the next scheduled task.
+
+	return woken;
+    } // uNBIO::poll
+
+#else
+
     /******************* pollIO *********************
 	Purpose: Perform pollIO actions
 	Effect:
@@ -368,6 +485,7 @@ namespace UPP {
 
 	return checkIOEnd( node, terrno );		// acquires mutual exclusion
     } // uNBIO::pollIO
+#endif // __U_MULTI__
 
 
     /******************* performIO **********************
@@ -403,6 +521,9 @@ namespace UPP {
 #endif // __U_DEBUG_H__
 	    pendingIO.remove( p );			// remove node from list of waiting tasks
 	    p->nfds = cnt;				// set return value
+#ifdef __U_STATISTICS__
+	    p->completed = uHistogram::now();
+#endif // __U_STATISTICS__
 	    p->pending.V();				// wake up waiting task (empty for IOPoller)
 	    pending -= 1;
 	} // if
@@ -448,6 +569,7 @@ namespace UPP {
     } // uNBIO::checkSfds
 
 
+#if ! defined( __U_MULTI__ )
     /******************* unblockFD **********************
 	Purpose: unblock the pending IO from the waiting queue
 	Effect: next pending task becomes IOPoller and will be waked up
@@ -464,9 +586,15 @@ namespace UPP {
 		   this, uThisTask().getName(), &uThisTask(), (IOPoller != NULL ? IOPoller->getName() : "NULL"), IOPoller );
 #endif // __U_DEBUG_H__
     } // uNBIO::unblockFD
+#endif // ! __U_MULTI__
 
 
-    bool uNBIO::checkIOEnd( NBIOnode &node, int terrno ) {
+    /********************* wakeIO *********************
+	Purpose: Process the result of a pselect
+	Effect: Wake each task whose I/O completed, timed out or failed, and reset the master masks for the tasks still
+		waiting; the caller provides mutual exclusion
+    **************************************************/
+    void uNBIO::wakeIO( int terrno ) {
 	unsigned int i, tcnt, cnt;
 	unsigned int tmasks;
 	NBIOnode *p;
@@ -597,6 +725,9 @@ namespace UPP {
 #endif // __U_DEBUG_H__
 			pendingIOMfds.remove( p );	// remove node from list of waiting tasks
 			p->nfds = tcnt;			// set return value
+#ifdef __U_STATISTICS__
+			if ( tcnt != 0 ) p->completed = uHistogram::now();
+#endif // __U_STATISTICS__
 			p->pending.V();			// wake up waiting task (empty for IOPoller)
 			pending -= 1;
 		    } else {				// task is not waking up
@@ -776,6 +907,12 @@ namespace UPP {
 		uAbort( "(uNBIO &)%p.checkIOEnd() : internal error, maxFD:%d error(%d) %s.", this, maxFD, terrno, strerror( terrno ) );
 	    } // if
 	} // if
+    } // uNBIO::wakeIO
+
+
+#if ! defined( __U_MULTI__ )
+    bool uNBIO::checkIOEnd( NBIOnode &node, int terrno ) {
+	wakeIO( terrno );
 
 	// If the IOPoller's I/O completed, attempt to nominate another waiting
 	// task to be the IOPoller.
@@ -823,27 +960,74 @@ namespace UPP {
 
 	return false;
     } // uNBIO::checkPoller
+#endif // ! __U_MULTI__
+
+
+    // The task waiting for I/O is running again: record the time since the processor polling found the I/O complete.
+
+    void uNBIO::ioWakeup( NBIOnode &node ) {
+#ifdef __U_STATISTICS__
+	if ( node.completed != 0 ) {
+	    uThisProcessor().schedHistograms[uCluster::IOWakeup].record( uHistogram::since( node.completed ) );
+	} // if
+#endif // __U_STATISTICS__
+    } // uNBIO::ioWakeup
 
 
     void uNBIO::waitOrPoll( NBIOnode &node, uEventNode *timeoutEvent ) {
+	uTracer::event( uTracer::IOWaitBegin, &uThisTask(), NULL, node.smfd.sfd.closure->access.fd );
+#ifdef __U_STATISTICS__
+	node.completed = 0;
+#endif // __U_STATISTICS__
+#if defined( __U_MULTI__ )
+	initSfd( node, timeoutEvent );
+	node.pending.P();				// processor kernels poll and wake this task
+	ioWakeup( node );
+#else
 	if ( ! initSfd( node, timeoutEvent ) ) {	// single bit ?
 	    node.pending.P();
-	    if ( ! node.listed() ) return;		// not poller task ?
+	    if ( ! node.listed() ) {			// not poller task ?
+		ioWakeup( node );
+		uTracer::event( uTracer::IOWaitEnd, &uThisTask() );
+		return;
+	    } // if
 	} // if
 	while ( pollIO( node ) ) uThisTask().uYieldNoPoll(); // busy wait
+#endif // __U_MULTI__
+	uTracer::event( uTracer::IOWaitEnd, &uThisTask() );
     } // uNBIO::waitOrPoll
 
 
     void uNBIO::waitOrPoll( unsigned int nfds, NBIOnode &node, uEventNode *timeoutEvent ) {
+	uTracer::event( uTracer::IOWaitBegin, &uThisTask(), NULL, nfds ); // number of descriptors rather than one
+#ifdef __U_STATISTICS__
+	node.completed = 0;
+#endif // __U_STATISTICS__
+#if defined( __U_MULTI__ )
+	initMfds( nfds, node, timeoutEvent );
+	node.pending.P();				// processor kernels poll and wake this task
+	ioWakeup( node );
+#else
 	if ( ! initMfds( nfds, node, timeoutEvent ) ) {	// multiple bits ?
 	    node.pending.P();
-	    if ( ! node.listed() ) return;		// not poller task ?
+	    if ( ! node.listed() ) {			// not poller task ?
+		ioWakeup( node );
+		uTracer::event( uTracer::IOWaitEnd, &uThisTask() );
+		return;
+	    } // if
 	} // if
 	while ( pollIO( node ) ) uThisTask().uYieldNoPoll(); // busy wait
+#endif // __U_MULTI__
+	uTracer::event( uTracer::IOWaitEnd, &uThisTask() );
     } // uNBIO::waitOrPoll
 
 
+#if defined( __U_MULTI__ )
+    void uNBIO::initSfd( NBIOnode &node, uEventNode *timeoutEvent ) {
+	lock.acquire();
+#else
     bool uNBIO::initSfd( NBIOnode &node, uEventNode *timeoutEvent ) {
+#endif // __U_MULTI__
 	unsigned int fd = node.smfd.sfd.closure->access.fd; // optimization
 
 	if ( fd >= smaxFD ) {				// increase maxFD if necessary
@@ -869,14 +1053,27 @@ namespace UPP {
 	    pendingIOSfds[fd].addTail( &node );		// node is removed by IOPoller
 	} // if
 
+#if defined( __U_MULTI__ )
+	pending += 1;
+	uFetchAdd( registrations, 1 );			// fence: counted before reading IOPollerPid
+	lock.release();
+	uPid_t temp = IOPollerPid;			// race: IOPollerPid can change to -1 if poller wakes before wakeup
+	if ( temp != (uPid_t)-1 ) uThisCluster().wakeProcessor( temp ); // add fd to blocked select
+#else
 	uPid_t temp = IOPollerPid;			// race: IOPollerPid can change to -1 if poller wakes before wakeup
 	if ( temp != (uPid_t)-1 ) uThisCluster().wakeProcessor( temp );
 	pending += 1;
 	return checkPoller();
+#endif // __U_MULTI__
     } // uNBIO::initSfd
 
 
+#if defined( __U_MULTI__ )
+    void uNBIO::initMfds( unsigned int nfds, NBIOnode &node, uEventNode *timeoutEvent ) {
+	lock.acquire();
+#else
     bool uNBIO::initMfds( unsigned int nfds, NBIOnode &node, uEventNode *timeoutEvent ) {
+#endif // __U_MULTI__
 	if ( nfds > mmaxFD ) {				// increase maxFD if necessary
 	    mmaxFD = nfds;
 	} // if
@@ -910,10 +1107,18 @@ namespace UPP {
 
 	pendingIOMfds.addTail( &node );			// node is removed by IOPoller
 
+#if defined( __U_MULTI__ )
+	pending += 1;
+	uFetchAdd( registrations, 1 );			// fence: counted before reading IOPollerPid
+	lock.release();
+	uPid_t temp = IOPollerPid;			// race: IOPollerPid can change to -1 if poller wakes before wakeup
+	if ( temp != (uPid_t)-1 ) uThisCluster().wakeProcessor( temp ); // add fds to blocked select
+#else
 	uPid_t temp = IOPollerPid;			// race: IOPollerPid can change to -1 if poller wakes before wakeup
 	if ( temp != (uPid_t)-1 ) uThisCluster().wakeProcessor( temp );
 	pending += 1;
 	return checkPoller();
+#endif // __U_MULTI__
     } // uNBIO::initMfds
 
 
@@ -934,9 +1139,11 @@ namespace UPP {
 	IOPoller = NULL;				// no poller task
 	IOPollerPid = (uPid_t)-1;			// IOPoller not blocked on a processor
 	timeoutOccurred = false;
-#if ! defined( __U_MULTI__ )
+#if defined( __U_MULTI__ )
+	registrations = 0;
+#else
 	okToSelect = false;
-#endif // ! __U_MULTI__
+#endif // __U_MULTI__
     } // uNBIO::uNBIO
 
 
@@ -0,0 +1,264 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// uPerfCounters.cc -- per-task hardware and software event counts using Linux perf events
+//
+// Author           : agent
+// Created On       : Mon Oct 19 02:05:30 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 02:44:10 2026
+// Update Count     : 2
+//
+// This  library is free  software; you  can redistribute  it and/or  modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software  Foundation; either  version 2.1 of  the License, or  (at your
+// option) any later version.
+//
+// This library is distributed in the  hope that it will be useful, but WITHOUT
+// ANY  WARRANTY;  without even  the  implied  warranty  of MERCHANTABILITY  or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+//
+// You should  have received a  copy of the  GNU Lesser General  Public License
+// along  with this library.
+//
+
+#define __U_KERNEL__
+#include <uC++.h>
+#include <uPerfCounters.h>
+#include "uInstrument.h"
+//#include <uDebug.h>
+
+#include <climits>					// PATH_MAX
+#include <cstdio>					// snprintf
+#include <cstring>
+#include <fcntl.h>					// open
+#include <unistd.h>					// read, write, close
+#if defined( __linux__ )
+#include <linux/perf_event.h>
+#include <sys/syscall.h>				// SYS_perf_event_open
+#endif // __linux__
+
+
+using namespace UPP;
+
+uSpinLock uPerfCounters::lock;
+volatile bool uPerfCounters::active = false;
+volatile int uPerfCounters::logFd = -1;
+const char *uPerfCounters::names[NoOfCounters] = { "cycles", "instructions", "cache-misses", "branch-misses", "page-faults", "context-switches" };
+
+static volatile bool opened[uPerfCounters::NoOfCounters]; // event opened on some processor
+
+
+class uPerfGroup {
+    friend class uPerfCounters;
+
+    int leader;						// -1 => no events
+    int fds[uPerfCounters::NoOfCounters];		// -1 => unavailable
+    unsigned int slot[uPerfCounters::NoOfCounters];	// position of event in a group read
+    unsigned int members;
+    bool running;					// task dispatched and start read
+    unsigned long long int start[uPerfCounters::NoOfCounters];
+}; // uPerfGroup
+
+
+#if defined( __linux__ )
+static int perfOpen( unsigned int type, unsigned long long int config, int group ) {
+    perf_event_attr attr;
+    memset( &attr, 0, sizeof(attr) );
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = type == PERF_TYPE_HARDWARE;	// user mode only needs less privilege
+    attr.exclude_hv = 1;
+    return syscall( SYS_perf_event_open, &attr, 0, -1, group, 0 ); // calling kernel thread, any CPU
+} // perfOpen
+#endif // __linux__
+
+
+// Called by the kernel thread of the processor, as events are per thread. The group comes from uInstrument::table, as it is
+// created in the kernel.
+
+uPerfGroup *uPerfCounters::open() {
+    uPerfGroup *g = (uPerfGroup *)uInstrument::table( sizeof(uPerfGroup) ); // zero filled
+    if ( g == NULL ) {
+	uAbort( "uPerfCounters::open : internal error, mmap failure, error(%d) %s.", errno, strerror( errno ) );
+    } // if
+    g->leader = -1;
+#if defined( __linux__ )
+    static const struct { unsigned int type; unsigned long long int config; } events[NoOfCounters] = {
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+	{ PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS },
+	{ PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES },
+    };
+    for ( unsigned int i = 0; i < NoOfCounters; i += 1 ) {
+	g->fds[i] = perfOpen( events[i].type, events[i].config, g->leader );
+	if ( g->fds[i] != -1 ) {
+	    if ( g->leader == -1 ) g->leader = g->fds[i]; // first event opened leads the group
+	    g->slot[i] = g->members;
+	    g->members += 1;
+	    opened[i] = true;
+	} // if
+    } // for
+#else
+    for ( unsigned int i = 0; i < NoOfCounters; i += 1 ) g->fds[i] = -1;
+#endif // __linux__
+    return g;
+} // uPerfCounters::open
+
+
+void uPerfCounters::read( uPerfGroup &group, unsigned long long int values[] ) {
+    unsigned long long int buffer[1 + NoOfCounters];	// number of events, then values
+    if ( group.leader == -1 || ::read( group.leader, buffer, sizeof(buffer) ) != (ssize_t)( ( 1 + group.members ) * sizeof(buffer[0]) ) ) {
+	memset( values, 0, NoOfCounters * sizeof(values[0]) );
+	return;
+    } // if
+    for ( unsigned int i = 0; i < NoOfCounters; i += 1 ) {
+	values[i] = group.fds[i] == -1 ? 0 : buffer[1 + group.slot[i]];
+    } // for
+} // uPerfCounters::read
+
+
+// Called by the processor kernel with interrupts disabled, before switching to a task.
+
+void uPerfCounters::begin( uProcessor &processor ) {
+    if ( processor.perfGroup == NULL ) processor.perfGroup = open();
+    read( *processor.perfGroup, processor.perfGroup->start );
+    processor.perfGroup->running = true;
+} // uPerfCounters::begin
+
+
+// Called by the processor kernel when the task returns, which is before a terminated task can be deleted.
+
+void uPerfCounters::end( uProcessor &processor, uBaseTask &task ) {
+    uPerfGroup &g = *processor.perfGroup;
+  if ( ! g.running ) return;				// counting started while task ran
+    g.running = false;
+    unsigned long long int now[NoOfCounters];
+    read( g, now );
+    for ( unsigned int i = 0; i < NoOfCounters; i += 1 ) {
+	task.perfCounts[i] += now[i] - g.start[i];
+    } // for
+} // uPerfCounters::end
+
+
+// Called by each processor as it terminates, on its kernel thread.
+
+void uPerfCounters::deregisterProcessor( uProcessor &processor ) {
+    uPerfGroup *g = processor.perfGroup;
+  if ( g == NULL ) return;
+    processor.perfGroup = NULL;
+    for ( unsigned int i = 0; i < NoOfCounters; i += 1 ) {
+	if ( g->fds[i] != -1 ) ::close( g->fds[i] );
+    } // for
+    ::munmap( g, sizeof(uPerfGroup) );
+} // uPerfCounters::deregisterProcessor
+
+
+void uPerfCounters::get( uBaseTask &task, unsigned long long int counts[NoOfCounters] ) {
+    for ( unsigned int i = 0; i < NoOfCounters; i += 1 ) counts[i] = task.perfCounts[i];
+  if ( &task != &uThisTask() ) return;
+    THREAD_GETMEM( This )->disableInterrupts();		// cannot move to another processor while reading
+    uPerfGroup *g = uThisProcessor().perfGroup;
+    if ( g != NULL && g->running ) {			// add current run
+	unsigned long long int now[NoOfCounters];
+	read( *g, now );
+	for ( unsigned int i = 0; i < NoOfCounters; i += 1 ) counts[i] += now[i] - g->start[i];
+    } // if
+    THREAD_GETMEM( This )->enableInterrupts();
+} // uPerfCounters::get
+
+
+bool uPerfCounters::available( Counter counter ) {
+    return opened[counter];
+} // uPerfCounters::available
+
+
+// One line per task, written with a single write so lines from tasks terminating on different processors do not mix.
+// The write holds the lock, so stop cannot close the descriptor, which start might then reuse, during the write.
+
+void uPerfCounters::log( uBaseTask &task ) {
+    unsigned long long int counts[NoOfCounters];
+    get( task, counts );
+    char buffer[512];
+    int len = snprintf( buffer, sizeof(buffer), "%.64s (%p):", task.getName(), &task );
+    for ( unsigned int i = 0; i < NoOfCounters; i += 1 ) {
+      if ( ! opened[i] ) continue;
+	len += snprintf( buffer + len, sizeof(buffer) - len, " %s %llu", names[i], counts[i] );
+    } // for
+    if ( counts[Instructions] != 0 ) {
+	len += snprintf( buffer + len, sizeof(buffer) - len, " IPC %.2f", (double)counts[Instructions] / ( counts[Cycles] == 0 ? 1 : counts[Cycles] ) );
+    } // if
+    buffer[len] = '\n';
+    lock.acquire();
+    if ( logFd != -1 ) {				// not stopped since finishTask checked ?
+	if ( ::write( logFd, buffer, len + 1 ) == -1 ) {} // best effort
+    } // if
+    lock.release();
+} // uPerfCounters::log
+
+
+bool uPerfCounters::start( const char *file ) {
+#if defined( __linux__ )
+    lock.acquire();
+    if ( active ) {					// already counting ?
+	lock.release();
+	return true;
+    } // if
+    if ( file != NULL ) {
+	logFd = ::open( file, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644 );
+	if ( logFd == -1 ) {
+	    lock.release();
+	    return true;
+	} // if
+    } // if
+    active = true;
+    lock.release();
+    return false;
+#else
+    return true;					// no perf events
+#endif // __linux__
+} // uPerfCounters::start
+
+
+// Counts are kept, so they can still be read. Processors keep their events open for the next start.
+
+bool uPerfCounters::stop() {
+    lock.acquire();
+    if ( ! active ) {
+	lock.release();
+	return true;
+    } // if
+    active = false;
+    int fd = logFd;
+    logFd = -1;
+    lock.release();
+    return fd != -1 && ::close( fd ) == -1;
+} // uPerfCounters::stop
+
+
+// UPERFCOUNTERS=file counts events for the whole program.
+
+void uPerfCounters::startup() {
+    char file[PATH_MAX];
+    const char *value = uInstrument::option( "UPERFCOUNTERS", file, sizeof(file), NULL );
+  if ( value == NULL ) return;
+    if ( start( file ) ) {
+	uAbort( "UPERFCOUNTERS=%s : cannot create file or perf events unsupported.", value );
+    } // if
+} // uPerfCounters::startup
+
+
+void uPerfCounters::finishup() {
+    if ( active ) stop();				// close log not stopped by program
+} // uPerfCounters::finishup
+
+
+// Local Variables: //
+// compile-command: "make install" //
+// End: //
@@ -0,0 +1,91 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// uPerfCounters.h -- per-task hardware and software event counts using Linux perf events
+//
+// Author           : agent
+// Created On       : Mon Oct 19 02:05:30 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 02:40:44 2026
+// Update Count     : 2
+//
+// This  library is free  software; you  can redistribute  it and/or  modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software  Foundation; either  version 2.1 of  the License, or  (at your
+// option) any later version.
+//
+// This library is distributed in the  hope that it will be useful, but WITHOUT
+// ANY  WARRANTY;  without even  the  implied  warranty  of MERCHANTABILITY  or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+//
+// You should  have received a  copy of the  GNU Lesser General  Public License
+// along  with this library.
+//
+
+
+#ifndef __U_PERFCOUNTERS_H__
+#define __U_PERFCOUNTERS_H__
+
+
+// Operating-system tools see only the kernel threads of the processors, each running many tasks. While counting, each
+// processor opens a group of perf events for its kernel thread, and the processor kernel reads the group when it
+// switches to a task and when the task returns, adding the differences to the task, so the counts of a kernel thread
+// are split among the tasks it runs. Hardware counters (cycles, instructions, cache and branch misses) are often
+// unavailable in virtual machines or restricted by perf_event_paranoid; software events (page faults, kernel-thread
+// context switches) always work. Unavailable events count zero. Hardware events count user mode only.
+//
+// A read of the group is a system call, so counting adds two to each context switch; when not counting, each switch
+// costs a test of one flag. Setting the environment variable UPERFCOUNTERS=file counts the whole program, writing the
+// counts of each task to the file as it terminates.
+
+class uPerfGroup;					// forward declaration
+
+class uPerfCounters : public uPerfCountersEvents {	// Counter enumeration, NoOfCounters
+    friend _Coroutine UPP::uProcessorKernel;		// access: dispatch, undispatch
+    friend class UPP::uMachContext;			// access: finishTask
+    friend _Task uProcessorTask;			// access: deregisterProcessor
+    friend class UPP::uKernelBoot;			// access: startup, finishup
+
+    static uSpinLock lock;				// protects start/stop and log writes
+    static volatile bool active;
+    static volatile int logFd;				// -1 => no log, set under lock
+    static const char *names[NoOfCounters];
+
+    static uPerfGroup *open();
+    static void read( uPerfGroup &group, unsigned long long int values[] );
+    static void begin( uProcessor &processor );
+    static void end( uProcessor &processor, uBaseTask &task );
+    static void deregisterProcessor( uProcessor &processor );
+    static void log( uBaseTask &task );
+    static void startup();
+    static void finishup();
+
+    static void dispatch( uProcessor &processor ) {
+	if ( __builtin_expect( active, 0 ) ) begin( processor );
+    } // uPerfCounters::dispatch
+
+    static void undispatch( uProcessor &processor, uBaseTask &task ) {
+	if ( __builtin_expect( processor.perfGroup != NULL, 0 ) ) end( processor, task );
+    } // uPerfCounters::undispatch
+
+    static void finishTask( uBaseTask &task ) {
+	if ( __builtin_expect( logFd != -1, 0 ) ) log( task ); // rechecked under lock
+    } // uPerfCounters::finishTask
+  public:
+    static bool start( const char *file = NULL );	// log terminating tasks to file, true => failure
+    static bool stop();					// true => failure
+    static bool counting() { return active; }
+    static bool available( Counter counter );		// event opened on some processor
+    static const char *name( Counter counter ) { return names[counter]; }
+    static void get( uBaseTask &task, unsigned long long int counts[NoOfCounters] ); // includes current run if calling task
+}; // uPerfCounters
+
+
+#endif // __U_PERFCOUNTERS_H__
+
+
+// Local Variables: //
+// compile-command: "make install" //
+// End: //
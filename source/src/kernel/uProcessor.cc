@@ -34,6 +34,11 @@
 #include <uProfiler.h>
 #endif // __U_PROFILER__
 #include <uProcessor.h>
+#include <uHeapLmmm.h>
+#include <uCPUProfiler.h>
+#include <uTracer.h>
+#include <uHistogram.h>
+#include <uPerfCounters.h>
 
 #include <uDebug.h>					// access: uDebugWrite
 #undef __U_DEBUG_H__					// turn off debug prints
@@ -54,7 +59,11 @@
 using namespace UPP;
 
 
+// Time a task runs is wall time from dispatch to return to the kernel, read with a clock that needs no system call, so
+// it includes time the kernel thread is descheduled by the operating system.
+
 uEventList *uProcessor::events = NULL;
+unsigned int uProcessor::ordinals = 0;
 
 #if ! defined( __U_MULTI__ )
 uEventNode *uProcessor::contextEvent = NULL;
@@ -97,6 +106,13 @@ void uProcessorTask::main() {
 
     processor.setContextSwitchEvent( processor.getPreemption() );
 
+    // Each kernel thread has its own CPU-time profiling timer; in uniprocessor mode all processors share one thread.
+#if defined( __U_MULTI__ )
+    uCPUProfiler::registerProcessor( processor );
+#else
+    if ( &processor == uKernelModule::systemProcessor ) uCPUProfiler::registerProcessor( processor );
+#endif // __U_MULTI__
+
 #if __U_LOCALDEBUGGER_H__
     if ( uLocalDebugger::uLocalDebuggerActive ) {
 	uLocalDebugger::uLocalDebuggerInstance->checkPoint();
@@ -163,6 +179,14 @@ void uProcessorTask::main() {
 	} // _Accept
     } // for
 
+#if defined( __U_MULTI__ )
+    uCPUProfiler::deregisterProcessor( processor );
+#else
+    if ( &processor == uKernelModule::systemProcessor ) uCPUProfiler::deregisterProcessor( processor );
+#endif // __U_MULTI__
+    uTracer::deregisterProcessor( processor );
+    uPerfCounters::deregisterProcessor( processor );
+
 #if defined( __U_MULTI__ )
     processor.setContextSwitchEvent( 0 );		// clear the alarm on this processor
     assert( ! processor.contextEvent->listed() );
@@ -403,6 +427,7 @@ void uProcessorKernel::scheduleInternal( uBaseSpinLock *lock, uBaseTask *task )
 
 
 #define SCHEDULE_BODY(parm...) \
+    uTracer::event( uTracer::Block, &uThisTask() ); \
     THREAD_GETMEM( This )->disableInterrupts(); \
     activeProcessorKernel->scheduleInternal( parm ); \
     THREAD_GETMEM( This )->enableInterrupts();
@@ -495,15 +520,7 @@ void uProcessorKernel::setTimer( uTime time ) {
 
     // The time parameter is always in real-time (not virtual time)
 
-#if defined( REALTIME_POSIX )
-    timespec curr;
-    if ( clocktype < 0 ) type = CLOCK_REALTIME;
-    clock_gettime( type, &curr );
-#else
-    timeval curr;
-    GETTIMEOFDAY( &curr );
-#endif
-    uTime currtime( curr.tv_sec, curr.tv_usec * 1000 );	// convert to nanoseconds
+    uTime currtime = uClock::now();
 
     uDuration dur = time - currtime;
   if ( dur <= 0 ) return;				// if duration is zero or negative, it has already past
@@ -575,6 +592,11 @@ void uProcessorKernel::main() {
 
 
     uBaseTask *readyTask;
+    uCluster *runCluster;				// cluster readyTask runs on
+    unsigned long long int ran;				// nanoseconds readyTask ran
+#if defined( __U_MULTI__ )
+    unsigned int dispatches = 0;			// tasks executed since last I/O poll
+#endif // __U_MULTI__
 
     for ( unsigned int spin = 0;; ) {
 #if ! defined( __U_MULTI__ )
@@ -631,11 +653,28 @@ void uProcessorKernel::main() {
 #   endif
 #endif // __U_MULTI__ && __U_SWAPCONTEXT__
 
+	    runCluster = processor->currCluster;
+	    processor->dispatchTime = uClock::monotonic();
 #ifdef __U_STATISTICS__
 	    uFetchAdd( UPP::Statistics::user_context_switches, 1 );
+	    if ( readyTask->readyTime != 0 ) {		// boot task is never made ready
+		processor->schedHistograms[uCluster::ReadyWait].record( processor->dispatchTime > readyTask->readyTime ?
+									processor->dispatchTime - readyTask->readyTime : 0 );
+	    } // if
 #endif // __U_STATISTICS__
 
+	    uPerfCounters::dispatch( *processor );
+	    uTracer::event( uTracer::Run, readyTask, NULL, 0, readyTask->getName() );
 	    uSwitch( context, readyTask->currCoroutine->context );
+	    uTracer::event( uTracer::Stop, readyTask );
+	    ran = uClock::monotonic() - processor->dispatchTime;
+	    if ( (long long int)ran < 0 ) ran = 0;	// see uClock::monotonic
+	    uPerfCounters::undispatch( *processor, *readyTask );
+	    readyTask->cpuTime += ran;			// task cannot be deleted until onBehalfOfUser
+	    processor->cpuTime += ran;			// summed by uCluster::getCPUTime, no shared counter
+#ifdef __U_STATISTICS__
+	    processor->schedHistograms[uCluster::RunLength].record( ran );
+#endif // __U_STATISTICS__
 
 	    THREAD_GETMEM( This )->enableInterrupts();
 	    assert( THREAD_GETMEM( disableInt ) && THREAD_GETMEM( disableIntCnt ) > 0 );
@@ -720,17 +759,38 @@ void uProcessorKernel::main() {
 #   endif
 #endif // __U_MULTI__ && __U_SWAPCONTEXT__
 
+	    runCluster = processor->currCluster;
+	    processor->dispatchTime = uClock::monotonic();
 #ifdef __U_STATISTICS__
 	    uFetchAdd( UPP::Statistics::user_context_switches, 1 );
+	    if ( readyTask->readyTime != 0 ) {		// boot task is never made ready
+		processor->schedHistograms[uCluster::ReadyWait].record( processor->dispatchTime > readyTask->readyTime ?
+									processor->dispatchTime - readyTask->readyTime : 0 );
+	    } // if
 #endif // __U_STATISTICS__
 
+	    uPerfCounters::dispatch( *processor );
+	    uTracer::event( uTracer::Run, readyTask, NULL, 0, readyTask->getName() );
 	    uSwitch( context, readyTask->currCoroutine->context );
+	    ran = uClock::monotonic() - processor->dispatchTime; // before processor is reset
+	    if ( (long long int)ran < 0 ) ran = 0;	// see uClock::monotonic
+	    uPerfCounters::undispatch( *processor, *readyTask );
+	    if ( processor->currCluster == runCluster ) {	// summed by uCluster::getCPUTime, no shared counter
+		processor->cpuTime += ran;
+	    } else {					// processor changed cluster during run
+		__atomic_fetch_add( &runCluster->cpuTime, ran, __ATOMIC_RELAXED );
+	    } // if
 
 	    assert( THREAD_GETMEM( disableInt ) && THREAD_GETMEM( disableIntCnt ) > 0 );
 	    // activeTask is set to the uProcessorTask and MUST stay set until another task is selected to ensure that
 	    // errno works correctly should a SIGALRM occurs while in the kernel.
 	    processor = &uThisProcessor();		// processor may have migrated
 	    THREAD_SETMEM( activeTask, processor->procTask );
+	    uTracer::event( uTracer::Stop, readyTask );
+	    readyTask->cpuTime += ran;			// task cannot be deleted until onBehalfOfUser
+#ifdef __U_STATISTICS__
+	    processor->schedHistograms[uCluster::RunLength].record( ran );
+#endif // __U_STATISTICS__
 	    assert( limit <= stackPointer() && stackPointer() <= base ); // checks uProcessorKernel
 
 #ifdef __U_DEBUG_H__
@@ -749,6 +809,19 @@ void uProcessorKernel::main() {
 
 #ifdef __U_MULTI__
 	    spin = 0;					// set number of spins back to zero
+
+	    // A busy processor never empties its ready queue, so poll periodically on behalf of tasks waiting for I/O
+	    // to prevent them from starving.
+
+	    dispatches += 1;
+	    if ( dispatches >= UPP::uNBIO::PollInterval ) {
+		dispatches = 0;
+		if ( processor->currCluster->NBIO->poll( false ) >= 0 ) {
+#ifdef __U_STATISTICS__
+		    uFetchAdd( UPP::Statistics::iopoller_busy, 1 );
+#endif // __U_STATISTICS__
+		} // if
+	    } // if
 #else
 	    // Poller task does not count as an executed task, if its last execution found no I/O and this processor's
 	    // ready queue is empty. Check before calling onBehalfOfUser, because IOPoller may put itself back on the
@@ -766,6 +839,28 @@ void uProcessorKernel::main() {
 	    uKernelModule::rollForward( true );
 	} // if
 
+	if ( readyTask == NULL ) {			// ready queues empty ?
+	    UPP::uHeapSampler::dumpPending();		// heap-profile dump requested by signal ? => wake dump task
+	    UPP::uHeapManager::trimIdle();		// return freed storage to the OS ?
+
+	    // Poll on behalf of tasks waiting for I/O; woken tasks are put on the cluster ready queue and executed by
+	    // this processor on the next iteration. While spinning, poll with exponential backoff (spins 1, 2, 4, ...)
+	    // rather than a pselect per spin. Once the spin expires, block in pselect instead of pausing; if the
+	    // blocking pselect returns without work (EINTR, wakeup for a migrated task), the spin stays expired so the
+	    // next idle pass blocks again instead of restarting the polling spin.
+
+	    bool expired = spin > processor->getSpin();
+	    if ( expired || ( spin & (spin - 1) ) == 0 ) { // spin expired or backoff point ?
+		int woken = processor->currCluster->NBIO->poll( expired );
+		if ( woken > 0 ) {			// work found ?
+		    dispatches = 0;
+		    spin = 0;				// set number of spins back to zero
+		    continue;
+		} // if
+	      if ( woken == 0 && expired ) continue;	// blocked for I/O ?
+	    } // if
+	} // if
+
 	if ( uThisCluster().numProcessors > 1 ) {	// only perform if there is processor competition
 	    for ( volatile unsigned int d = 0; d <	// delay so not pounding on ready-queue lock 
 #if defined( __i386__ ) || defined( __x86_64__ )
@@ -808,6 +903,8 @@ void uProcessorKernel::main() {
 #endif // __U_DEBUG_H__
 
 	if ( cycleStart == currProc && spin != 0 ) {
+	    UPP::uHeapSampler::dumpPending();		// heap-profile dump requested by signal ? => wake dump task
+	    UPP::uHeapManager::trimIdle();		// return freed storage to the OS ?
 #if __U_LOCALDEBUGGER_H__
 #ifdef __U_DEBUG_H__
 	    uDebugPrt( "(uProcessorKernel &)%p.main, uLocalDebuggerInstance:%p, IOPoller: %.256s (%p), dispatcher:%p, debugger_blocked_tasks:%d, uPendingIO.head:%p, uPendingIO.tail:%p\n",
@@ -928,6 +1025,7 @@ void uProcessor::createProcessor( uCluster &cluster, bool detached, int ms, int
     uProcessor::detached = detached;
     preemption = ms;
     uProcessor::spin = spin;
+    ordinal = uFetchAdd( ordinals, 1 );
 
 #ifdef __U_MULTI__
     contextSwitchHandler = new uCxtSwtchHndlr( *this );
@@ -939,6 +1037,13 @@ void uProcessor::createProcessor( uCluster &cluster, bool detached, int ms, int
 #endif // __U_MULTI__
 
     terminated = false;
+    traceRing = NULL;
+    dispatchTime = 0;
+    cpuTime = 0;
+    perfGroup = NULL;
+#ifdef __U_STATISTICS__
+    schedHistograms = new uHistogram[uCluster::NoOfSchedHistograms];
+#endif // __U_STATISTICS__
     currCluster->processorAdd( *this );
 
     uKernelModule::globalProcessorLock->acquire();	// add processor to global processor list.
@@ -1057,6 +1162,9 @@ uProcessor::~uProcessor() {
     uKernelModule::globalProcessorLock->release();
 
     currCluster->processorRemove( *this );
+#ifdef __U_STATISTICS__
+    delete [] schedHistograms;
+#endif // __U_STATISTICS__
 #ifdef __U_MULTI__
     delete contextEvent;
     delete contextSwitchHandler;
@@ -101,6 +101,33 @@ namespace UPP {
     } // uSigHandlerModule::signalContextPC
 
 
+    // Frame pointer at the point of interrupt, NULL => architecture does not keep a frame chain.
+
+    void *uSigHandlerModule::signalContextFP( __U_SIGCXT__ cxt ) {
+#if defined( __i386__ )
+#if defined( __linux__ )
+	return (void *)(cxt->uc_mcontext.gregs[REG_EBP]);
+#elif defined( __freebsd__ )
+	return (void *)(cxt->uc_mcontext.mc_ebp);
+#else
+	#error uC++ : internal error, unsupported architecture
+#endif // OS
+
+#elif defined( __x86_64__ )
+#if defined( __linux__ )
+	return (void *)(cxt->uc_mcontext.gregs[REG_RBP]);
+#elif defined( __freebsd__ )
+	return (void *)(cxt->uc_mcontext.mc_rbp);
+#else
+	#error uC++ : internal error, unsupported architecture
+#endif // OS
+
+#else
+	return NULL;
+#endif // architecture
+    } // uSigHandlerModule::signalContextFP
+
+
     void uSigHandlerModule::sigTermHandler( __U_SIGTYPE__ ) {
 	// This routine handles a SIGHUP, SIGINT, or a SIGTERM signal.  The signal is delivered to the root process as
 	// the result of some action on the part of the user attempting to terminate the application.  It must be caught
@@ -0,0 +1,210 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// uStackProfiler.cc -- stack high-water marks by task and coroutine type
+//
+// Author           : agent
+// Created On       : Mon Oct 19 02:08:40 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 02:44:10 2026
+// Update Count     : 2
+//
+// This  library is free  software; you  can redistribute  it and/or  modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software  Foundation; either  version 2.1 of  the License, or  (at your
+// option) any later version.
+//
+// This library is distributed in the  hope that it will be useful, but WITHOUT
+// ANY  WARRANTY;  without even  the  implied  warranty  of MERCHANTABILITY  or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+//
+// You should  have received a  copy of the  GNU Lesser General  Public License
+// along  with this library.
+//
+
+#define __U_KERNEL__
+#include <uC++.h>
+#include <uStackProfiler.h>
+#include <uHistogram.h>
+#include "uInstrument.h"
+//#include <uDebug.h>
+
+#include <climits>					// PATH_MAX
+#include <cstdio>					// snprintf
+#include <cstdlib>					// qsort
+#include <cstring>
+
+
+using namespace UPP;
+
+static const unsigned long long int Pattern = 0x5ac4e3b1d07f9a26ULL; // unlikely to be a stack value
+enum { Empty, Filling, Ready };				// Entry states
+
+struct uStackProfiler::Entry {
+    volatile int state;					// Empty, Filling, Ready
+    const char *type;
+    volatile unsigned int stackSize;			// largest stack allocated for the type
+    uHistogram used;					// high-water marks in bytes
+}; // uStackProfiler::Entry
+
+uSpinLock uStackProfiler::lock;
+uStackProfiler::Entry *uStackProfiler::entries = NULL;
+const char *uStackProfiler::fileName = NULL;
+volatile bool uStackProfiler::active = false;
+unsigned long long int uStackProfiler::dropped = 0;
+
+
+// Called by createContext, before the stack is used.
+
+void uStackProfiler::fill( void *limit, void *base ) {
+    for ( unsigned long long int *p = (unsigned long long int *)limit; p < (unsigned long long int *)base; p += 1 ) {
+	*p = Pattern;
+    } // for
+} // uStackProfiler::fill
+
+
+ptrdiff_t uStackProfiler::highWater( const uBaseCoroutine &coroutine ) {
+  if ( ! coroutine.stackFilled ) return -1;
+    unsigned long long int *p = (unsigned long long int *)coroutine.limit, *base = (unsigned long long int *)coroutine.base;
+    for ( ; p < base && *p == Pattern; p += 1 );	// stack grows down, so first change is deepest use
+    return (char *)base - (char *)p;
+} // uStackProfiler::highWater
+
+
+// Types are keyed by name, not address, as the same name can be in several shared objects. An entry is claimed with
+// compare-and-swap and filled before it is marked ready, so no lock is needed.
+
+uStackProfiler::Entry *uStackProfiler::lookup( const char *type ) {
+    size_t hash = 5381;
+    for ( const char *c = type; *c != '\0'; c += 1 ) hash = hash * 33 + (unsigned char)*c;
+
+    for ( size_t i = hash & (TableSize - 1), probe = 0; probe < TableSize; probe += 1, i = (i + 1) & (TableSize - 1) ) {
+	Entry &e = entries[i];
+	if ( e.state == Empty && uCompareAssign( e.state, (int)Empty, (int)Filling ) ) { // new entry ?
+	    e.type = type;				// histogram zero filled => empty
+	    __sync_synchronize();			// entry visible before ready
+	    e.state = Ready;
+	    return &e;
+	} // if
+	while ( e.state == Filling ) {}			// another task is creating this entry
+	if ( e.type == type || strcmp( e.type, type ) == 0 ) return &e;
+    } // for
+    uFetchAdd( dropped, 1 );				// table full
+    return NULL;
+} // uStackProfiler::lookup
+
+
+// Called as a coroutine or task is deleted, while its stack still exists.
+
+void uStackProfiler::sample( uBaseCoroutine &coroutine ) {
+  if ( ! active ) return;				// stopped since the stack was filled
+    Entry *e = lookup( coroutine.typeName != NULL ? coroutine.typeName : "*unknown*" );
+  if ( e == NULL ) return;
+    e->used.record( highWater( coroutine ) );
+    for ( unsigned int size = e->stackSize; coroutine.size > size; size = e->stackSize ) {
+      if ( uCompareAssign( e->stackSize, size, coroutine.size ) ) break;
+    } // for
+} // uStackProfiler::sample
+
+
+int uStackProfiler::byMax( const void *e1, const void *e2 ) { // descending maximum
+    unsigned long long int m1 = (*(Entry **)e1)->used.maximum(), m2 = (*(Entry **)e2)->used.maximum();
+    return m1 < m2 ? 1 : m1 > m2 ? -1 : 0;
+} // uStackProfiler::byMax
+
+
+int uStackProfiler::report( int fd ) {
+  if ( entries == NULL ) return -1;
+    enum { BufferSize = 512, PageSize = 4096 };
+    char buffer[BufferSize];
+    int rc = 0;
+
+    Entry **sorted = new Entry *[TableSize];
+    unsigned int n = 0;
+    for ( unsigned int i = 0; i < TableSize; i += 1 ) {
+	if ( entries[i].state == Ready ) sorted[n++] = &entries[i];
+    } // for
+    qsort( sorted, n, sizeof(Entry *), byMax );
+
+    int len = snprintf( buffer, BufferSize, "Stack high-water marks in bytes, %llu types dropped\n"
+			"%10s %10s %10s %10s %10s %10s  %s\n", dropped,
+			"count", "p50", "p99", "max", "allocated", "suggested", "type" );
+    rc |= uInstrument::writeAll( fd, buffer, len );
+    for ( unsigned int i = 0; i < n && rc == 0; i += 1 ) {
+	Entry &e = *sorted[i];
+	unsigned long long int max = e.used.maximum();
+	unsigned long long int suggested = ( max + max / 4 + PageSize - 1 ) / PageSize * PageSize;
+	len = snprintf( buffer, BufferSize, "%10llu %10llu %10llu %10llu %10u %10llu  %.256s\n",
+			e.used.count(), e.used.percentile( 50.0 ), e.used.percentile( 99.0 ), max,
+			e.stackSize, suggested, e.type );
+	rc |= uInstrument::writeAll( fd, buffer, len );
+    } // for
+    delete [] sorted;
+    return rc;
+} // uStackProfiler::report
+
+
+bool uStackProfiler::start( const char *file ) {
+  if ( file == NULL ) return true;
+
+    lock.acquire();
+    if ( active ) {					// already profiling ?
+	lock.release();
+	return true;
+    } // if
+    if ( entries == NULL ) {				// first start ?
+	// stacks are recorded during deletion, which may be in the heap
+	entries = (Entry *)uInstrument::table( TableSize * sizeof(Entry) );
+	if ( entries == NULL ) {
+	    lock.release();
+	    return true;
+	} // if
+    } else {
+	memset( (void *)entries, 0, TableSize * sizeof(Entry) ); // discard previous profile
+    } // if
+    fileName = strdup( file );
+    dropped = 0;
+    active = true;
+    lock.release();
+    return false;
+} // uStackProfiler::start
+
+
+bool uStackProfiler::stop() {
+    lock.acquire();
+    if ( ! active ) {
+	lock.release();
+	return true;
+    } // if
+    active = false;
+    lock.release();
+
+    int rc = uInstrument::writeFile( fileName, report );
+    free( (void *)fileName );
+    fileName = NULL;
+    return rc != 0;
+} // uStackProfiler::stop
+
+
+// USTACKPROFILE=file profiles the program from boot to shutdown.
+
+void uStackProfiler::startup() {
+    char file[PATH_MAX];
+    const char *value = uInstrument::option( "USTACKPROFILE", file, sizeof(file), NULL );
+  if ( value == NULL ) return;
+    if ( start( file ) ) {
+	uAbort( "USTACKPROFILE=%s : cannot allocate profile table.", value );
+    } // if
+} // uStackProfiler::startup
+
+
+void uStackProfiler::finishup() {
+    if ( active ) stop();				// write report not stopped by program
+} // uStackProfiler::finishup
+
+
+// Local Variables: //
+// compile-command: "make install" //
+// End: //
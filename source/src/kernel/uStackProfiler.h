@@ -0,0 +1,83 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// uStackProfiler.h -- stack high-water marks by task and coroutine type
+//
+// Author           : agent
+// Created On       : Mon Oct 19 02:08:40 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 02:08:40 2026
+// Update Count     : 1
+//
+// This  library is free  software; you  can redistribute  it and/or  modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software  Foundation; either  version 2.1 of  the License, or  (at your
+// option) any later version.
+//
+// This library is distributed in the  hope that it will be useful, but WITHOUT
+// ANY  WARRANTY;  without even  the  implied  warranty  of MERCHANTABILITY  or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+//
+// You should  have received a  copy of the  GNU Lesser General  Public License
+// along  with this library.
+//
+
+
+#ifndef __U_STACKPROFILER_H__
+#define __U_STACKPROFILER_H__
+
+
+// While profiling, the stack of each coroutine and task created is filled with a pattern. When the coroutine or task is
+// deleted, its stack is scanned from the limit towards the base for the first word changed, giving the most stack it
+// used, which is recorded by type (the _Coroutine or _Task name). Filling writes the whole stack, so every stack is
+// resident for its lifetime: profile in a test run, not in production.
+//
+// The report, written when profiling stops, gives the distribution of high-water marks for each type, and a suggested
+// stack size, the maximum plus a quarter, rounded up to a page. Only coroutines and tasks deleted while profiling are
+// included. Setting the environment variable USTACKPROFILE=file profiles the whole program.
+
+class uStackProfiler {
+    friend class UPP::uMachContext;			// access: fill
+    friend class UPP::uCoroutineDestructor;		// access: record
+    friend class UPP::uTaskDestructor;			// access: record
+    friend class UPP::uKernelBoot;			// access: startup, finishup
+
+    enum { TableSize = 512 };				// power of 2, types
+
+    struct Entry;					// forward declaration
+
+    static uSpinLock lock;				// protects start/stop
+    static Entry *entries;
+    static const char *fileName;
+    static volatile bool active;
+    static unsigned long long int dropped;
+
+    static void fill( void *limit, void *base );
+    static void sample( uBaseCoroutine &coroutine );
+    static Entry *lookup( const char *type );
+    static int byMax( const void *e1, const void *e2 );
+    static void startup();
+    static void finishup();
+
+    static bool filling() { return active; }
+
+    static void record( uBaseCoroutine &coroutine ) {
+	if ( __builtin_expect( coroutine.stackFilled, 0 ) ) sample( coroutine );
+    } // uStackProfiler::record
+  public:
+    static bool start( const char *file );		// true => failure
+    static bool stop();					// write report, true => failure
+    static bool profiling() { return active; }
+    static int report( int fd );			// -1 => failure
+    static ptrdiff_t highWater( const uBaseCoroutine &coroutine ); // bytes of stack used so far, -1 => stack not filled
+}; // uStackProfiler
+
+
+#endif // __U_STACKPROFILER_H__
+
+
+// Local Variables: //
+// compile-command: "make install" //
+// End: //
@@ -0,0 +1,221 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// uTracer.cc -- per-processor event tracer
+//
+// Author           : agent
+// Created On       : Mon Oct 19 01:52:47 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 02:44:10 2026
+// Update Count     : 2
+//
+// This  library is free  software; you  can redistribute  it and/or  modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software  Foundation; either  version 2.1 of  the License, or  (at your
+// option) any later version.
+//
+// This library is distributed in the  hope that it will be useful, but WITHOUT
+// ANY  WARRANTY;  without even  the  implied  warranty  of MERCHANTABILITY  or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+//
+// You should  have received a  copy of the  GNU Lesser General  Public License
+// along  with this library.
+//
+
+#define __U_KERNEL__
+#include <uC++.h>
+#include <uTracer.h>
+#include "uInstrument.h"
+//#include <uDebug.h>
+
+#include <climits>					// PATH_MAX
+#include <cstdio>					// snprintf
+#include <cstring>
+
+
+using namespace UPP;
+
+uSpinLock uTracer::lock;
+uTraceRing *volatile uTracer::rings = NULL;
+unsigned int uTracer::ringSize = 0;
+unsigned int uTracer::nextId = 0;
+const char *uTracer::fileName = NULL;
+unsigned long long int uTracer::startTicks = 0;
+unsigned long long int uTracer::startNsecs = 0;
+unsigned long long int uTracer::stopTicks = 0;
+unsigned long long int uTracer::stopNsecs = 0;
+volatile bool uTracer::active = false;
+
+
+// Time stamps are cycle counts, converted to time using the counts and clock readings at start and stop of tracing,
+// which assumes a constant-rate counter synchronized across CPUs (invariant TSC).
+
+static inline unsigned long long int ticks() {
+#if defined( __i386__ ) || defined( __x86_64__ )
+    return uRdtsc();
+#else
+    return uClock::monotonic();				// wall-clock steps do not reorder events
+#endif // __i386__ || __x86_64__
+} // ticks
+
+
+// A processor takes a free ring, left by a deleted processor, or adds a new one, so there are only as many rings as
+// processors existing at the same time. The ring is taken by the first event on the processor, so programs that never
+// trace pay nothing. Rings come from uInstrument::table, as an event may be recorded inside the memory allocator.
+
+uTraceRing &uTracer::ring( uProcessor &processor ) {
+    uTraceRing *r;
+    for ( r = rings; r != NULL; r = r->link ) {		// reuse free ring ?
+	if ( r->owner == NULL && uCompareAssign( r->owner, (uProcessor *)NULL, &processor ) ) break;
+    } // for
+    if ( r == NULL ) {					// add ring
+	unsigned long long int size = ringSize;
+	r = (uTraceRing *)uInstrument::table( sizeof(uTraceRing) + size * sizeof(Record) ); // zero filled
+	if ( r == NULL ) {
+	    uAbort( "(uTracer &)%p.ring : internal error, mmap failure, error(%d) %s.", &processor, errno, strerror( errno ) );
+	} // if
+	r->owner = &processor;
+	r->mask = size - 1;
+	r->records = (Record *)(r + 1);
+	r->id = uFetchAdd( nextId, 1 );
+	uTraceRing *head;
+	do {						// push on list of all rings
+	    head = rings;
+	    r->link = head;
+	} while ( ! uCompareAssign( rings, head, r ) );
+    } // if
+    snprintf( r->name, sizeof(r->name), "processor %u (%.32s)", r->id, processor.getCluster().getName() );
+
+    if ( ! uCompareAssign( processor.traceRing, (uTraceRing *)NULL, r ) ) { // processor already has a ring ?
+	r->owner = NULL;
+	r = processor.traceRing;
+    } // if
+    return *r;
+} // uTracer::ring
+
+
+void uTracer::record( Event event, const void *task, const void *object, unsigned int arg, const char *name ) {
+    uProcessor &processor = uThisProcessor();
+    uTraceRing &r = processor.traceRing != NULL ? *processor.traceRing : ring( processor );
+    unsigned long long int time = ticks();
+    Record &rec = r.records[uFetchAdd( r.tail, 1 ) & r.mask];
+    rec.time = time;
+    rec.task = (uintptr_t)task;
+    rec.object = (uintptr_t)object;
+    rec.event = event;
+    rec.arg = arg;
+    uInstrument::copyName( rec.name, name, NameSize );
+} // uTracer::record
+
+
+// Called by each processor as it terminates. Its ring is kept, with its events, for the next processor.
+
+void uTracer::deregisterProcessor( uProcessor &processor ) {
+    uTraceRing *r = processor.traceRing;
+  if ( r == NULL ) return;
+    processor.traceRing = NULL;
+    r->owner = NULL;
+} // uTracer::deregisterProcessor
+
+
+bool uTracer::start( const char *file, unsigned int records ) {
+  if ( file == NULL || records < 2 ) return true;
+
+    lock.acquire();
+    if ( active ) {					// already tracing ?
+	lock.release();
+	return true;
+    } // if
+    if ( rings == NULL ) {				// size fixed by the first start
+	for ( ringSize = 2; ringSize < records; ringSize <<= 1 ); // round up to power of 2
+    } // if
+    for ( uTraceRing *r = rings; r != NULL; r = r->link ) {
+	r->tail = 0;					// discard previous trace
+    } // for
+    fileName = strdup( file );
+    startNsecs = uClock::now().nanoseconds();
+    startTicks = ticks();
+    active = true;
+    lock.release();
+    return false;
+} // uTracer::start
+
+
+// Records reserved just before tracing stops may still be in the process of being written, so the last event on a
+// processor can be torn.
+
+int uTracer::write( int fd ) {
+    Header header;
+    memset( &header, 0, sizeof(header) );
+    strcpy( header.magic, "uTRACE1" );
+    header.version = 1;
+    header.startTicks = startTicks;
+    header.startNsecs = startNsecs;
+    header.stopTicks = stopTicks;
+    header.stopNsecs = stopNsecs;
+    for ( uTraceRing *r = rings; r != NULL; r = r->link ) {
+	if ( r->tail != 0 ) header.rings += 1;
+    } // for
+
+    int rc = uInstrument::writeAll( fd, (char *)&header, sizeof(header) );
+    for ( uTraceRing *r = rings; r != NULL && rc == 0; r = r->link ) {
+	unsigned long long int tail = r->tail, size = r->mask + 1;
+      if ( tail == 0 ) continue;
+	unsigned long long int count = tail < size ? tail : size, first = ( tail - count ) & r->mask;
+	RingHeader rheader;
+	memset( &rheader, 0, sizeof(rheader) );
+	rheader.id = r->id;
+	rheader.count = count;
+	memcpy( rheader.name, r->name, sizeof(rheader.name) );
+	rc |= uInstrument::writeAll( fd, (char *)&rheader, sizeof(rheader) );
+	// oldest records run from first to the end of the ring, then wrap to the start
+	unsigned long long int part = size - first < count ? size - first : count;
+	rc |= uInstrument::writeAll( fd, (char *)&r->records[first], part * sizeof(Record) );
+	rc |= uInstrument::writeAll( fd, (char *)&r->records[0], ( count - part ) * sizeof(Record) );
+    } // for
+    return rc;
+} // uTracer::write
+
+
+bool uTracer::stop() {
+    lock.acquire();
+    if ( ! active ) {
+	lock.release();
+	return true;
+    } // if
+    active = false;
+    stopTicks = ticks();
+    stopNsecs = uClock::now().nanoseconds();
+    lock.release();
+
+    int rc = uInstrument::writeFile( fileName, write );
+    free( (void *)fileName );
+    fileName = NULL;
+    return rc != 0;
+} // uTracer::stop
+
+
+// UTRACE=file[,records] traces the program from boot to shutdown.
+
+void uTracer::startup() {
+    char file[PATH_MAX];
+    unsigned int records = 16384;
+    const char *value = uInstrument::option( "UTRACE", file, sizeof(file), &records );
+  if ( value == NULL ) return;
+
+    if ( start( file, records ) ) {
+	uAbort( "UTRACE=%s : records per processor must be greater than 1.", value );
+    } // if
+} // uTracer::startup
+
+
+void uTracer::finishup() {
+    if ( active ) stop();				// write trace not stopped by program
+} // uTracer::finishup
+
+
+// Local Variables: //
+// compile-command: "make install" //
+// End: //
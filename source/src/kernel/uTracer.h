@@ -0,0 +1,122 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// uTracer.h -- per-processor event tracer
+//
+// Author           : agent
+// Created On       : Mon Oct 19 01:52:47 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 01:52:47 2026
+// Update Count     : 1
+//
+// This  library is free  software; you  can redistribute  it and/or  modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software  Foundation; either  version 2.1 of  the License, or  (at your
+// option) any later version.
+//
+// This library is distributed in the  hope that it will be useful, but WITHOUT
+// ANY  WARRANTY;  without even  the  implied  warranty  of MERCHANTABILITY  or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+//
+// You should  have received a  copy of the  GNU Lesser General  Public License
+// along  with this library.
+//
+
+
+#ifndef __U_TRACER_H__
+#define __U_TRACER_H__
+
+
+// The kernel records what each processor does: the task it runs, tasks blocking and being woken, monitor entry and
+// exit, waits for I/O, and idle pauses. An event is a fixed-size record, time-stamped with the cycle counter where
+// available, in a ring buffer belonging to the processor; a slot is reserved with a fetch-and-add, so recording takes no
+// lock and a task preempted and migrated part way through cannot corrupt the ring. A ring holds the most recent events,
+// older ones are overwritten. When tracing is off, each trace point costs a test of one flag.
+//
+// When tracing stops, the rings are written to a binary file, which u++-trace converts to the Chrome trace-event format
+// (chrome://tracing, Perfetto). Setting the environment variable UTRACE=file[,records] traces the whole program, with
+// "records" per processor ring.
+
+class uTraceRing;					// forward declaration
+
+class uTracer {
+    friend _Coroutine UPP::uProcessorKernel;		// access: event
+    friend class uCluster;				// access: event
+    friend class UPP::uSerialMember;			// access: event
+    friend class UPP::uNBIO;				// access: event
+    friend _Task uProcessorTask;			// access: deregisterProcessor
+    friend class UPP::uKernelBoot;			// access: startup, finishup
+  public:
+    enum Event { Run, Stop, Block, Wake, MonitorEnter, MonitorExit, IOWaitBegin, IOWaitEnd, IdleBegin, IdleEnd };
+    enum { NameSize = 32 };
+
+    // File layout, shared with u++-trace: Header, then for each ring a RingHeader followed by its records, oldest first.
+
+    struct Header {
+	char magic[8];					// "uTRACE1"
+	unsigned int version;
+	unsigned int rings;
+	unsigned long long int startTicks, startNsecs;	// time stamps and nanoseconds when tracing started and
+	unsigned long long int stopTicks, stopNsecs;	//   stopped, for converting time stamps
+    }; // Header
+
+    struct RingHeader {
+	unsigned int id;
+	unsigned int count;				// records following
+	char name[56];					// processor and cluster names
+    }; // RingHeader
+
+    struct Record {
+	unsigned long long int time;			// time stamp
+	unsigned long long int task;			// task performing or subject of the event, by address
+	unsigned long long int object;			// lock, mutex object or task, by address
+	unsigned int event;
+	unsigned int arg;				// file descriptor
+	char name[NameSize];				// task or mutex type
+    }; // Record
+  private:
+    static uSpinLock lock;				// protects start/stop
+    static uTraceRing *volatile rings;			// all rings, never freed
+    static unsigned int ringSize, nextId;
+    static const char *fileName;
+    static unsigned long long int startTicks, startNsecs, stopTicks, stopNsecs;
+    static volatile bool active;
+
+    static uTraceRing &ring( uProcessor &processor );
+    static void record( Event event, const void *task, const void *object, unsigned int arg, const char *name );
+    static void deregisterProcessor( uProcessor &processor );
+    static int write( int fd );			// -1 => failure
+    static void startup();
+    static void finishup();
+
+    static void event( Event event, const void *task, const void *object = NULL, unsigned int arg = 0, const char *name = NULL ) {
+	if ( __builtin_expect( active, 0 ) ) record( event, task, object, arg, name );
+    } // uTracer::event
+  public:
+    static bool start( const char *file, unsigned int records = 16384 ); // true => failure
+    static bool stop();					// write trace, true => failure
+    static bool tracing() { return active; }
+}; // uTracer
+
+
+class uTraceRing {
+    friend class uTracer;
+
+    uTraceRing *link;					// list of all rings
+    uProcessor *volatile owner;				// NULL => free
+    volatile unsigned long long int tail;		// records written
+    unsigned long long int mask;
+    unsigned int id;
+    char name[56];
+    uTracer::Record *records;
+}; // uTraceRing
+
+
+#endif // __U_TRACER_H__
+
+
+// Local Variables: //
+// compile-command: "make install" //
+// End: //
@@ -113,6 +113,123 @@ namespace std {
 
     typedef basic_acquire<std::ostream> osacquire;
     typedef basic_acquire<std::istream> isacquire;
+
+
+    // Format a statement's output into a buffer private to the executing task (on its stack, growing to the heap for
+    // long records), and hand the complete record to the stream when the statement ends. Like osacquire, a record is
+    // never interleaved with other output, but tasks hold the stream lock only to copy the record into the stream
+    // buffer, not while formatting, so many tasks writing to the same stream do not queue behind each other's
+    // formatting. The record starts with the stream's format state, but format changes (e.g., hex) apply only to the
+    // record. A flush (e.g., endl) or a unitbuf stream flushes the stream after the record is added.
+    //
+    //   osbuffer( cerr ) << "task " << id << " value " << v << endl;
+
+    template<typename streamtype>
+    class basic_osbuffer {
+	typedef typename streamtype::char_type char_type;
+	typedef typename streamtype::traits_type traits_type;
+
+	class recordbuf : public basic_streambuf<char_type, traits_type> {
+	    typedef typename traits_type::int_type int_type;
+	    enum { Inline = 256 };			// most records fit without allocation
+
+	    char_type inlinebuf[Inline];
+	    char_type *buf;
+	    streamsize size;
+	  public:
+	    bool flushed;
+
+	    recordbuf() : buf( inlinebuf ), size( Inline ), flushed( false ) {
+		this->setp( buf, buf + size );
+	    } // recordbuf::recordbuf
+
+	    ~recordbuf() {
+		if ( buf != inlinebuf ) delete [] buf;
+	    } // recordbuf::~recordbuf
+
+	    const char_type *data() const { return this->pbase(); }
+	    streamsize length() const { return this->pptr() - this->pbase(); }
+	  protected:
+	    int_type overflow( int_type c ) {		// double buffer
+		streamsize len = length();
+		char_type *nbuf = new char_type[size * 2];
+		traits_type::copy( nbuf, buf, len );
+		if ( buf != inlinebuf ) delete [] buf;
+		buf = nbuf;
+		size *= 2;
+		this->setp( buf, buf + size );
+		this->pbump( len );
+		if ( ! traits_type::eq_int_type( c, traits_type::eof() ) ) {
+		    *this->pptr() = traits_type::to_char_type( c );
+		    this->pbump( 1 );
+		} // if
+		return traits_type::not_eof( c );
+	    } // recordbuf::overflow
+
+	    int sync() {				// record is written when complete, so only remember flush
+		flushed = true;
+		return 0;
+	    } // recordbuf::sync
+	}; // recordbuf
+
+	streamtype &target;
+	recordbuf record;
+	streamtype os;					// private stream formatting into record
+
+	basic_osbuffer( const basic_osbuffer & );
+	basic_osbuffer &operator=( const basic_osbuffer & );
+      public:
+	basic_osbuffer( streamtype &ios ) : target( ios ), os( &record ) {
+#ifdef __U_DEBUG__
+	    if ( dynamic_cast<filebuf *>( ios.rdbuf() ) == NULL ) {
+		uAbort( "Attempt to buffer output for a non-concurrent stream." );
+	    } // if
+#endif // __U_DEBUG__
+	    os.flags( ios.flags() );
+	    os.precision( ios.precision() );
+	    os.fill( ios.fill() );
+	    os.width( ios.width() );
+	    ios.width( 0 );
+	} // basic_osbuffer
+
+	~basic_osbuffer() {
+	    // A destructor must not propagate the write failure, so report it through the stream state, as a failed
+	    // insertion does.
+	    try {
+		((filebuf *)target.rdbuf())->append( record.data(), record.length(), record.flushed || ( target.flags() & ios_base::unitbuf ) );
+	    } catch( uFile::FileAccess::WriteFailure ) {
+		try {
+		    target.setstate( ios_base::badbit );
+		} catch( ios_base::failure ) {		// exceptions enabled on stream, state is still set
+		} // try
+	    } // try
+	} // ~basic_osbuffer
+
+	template< typename datatype >
+	streamtype &operator<<( const datatype &data ) {
+	    return os << data;
+	} // operator<<
+
+	template< typename datatype >
+	streamtype &operator<<( datatype &data ) {
+	    return os << data;
+	} // operator<<
+
+	streamtype &operator<<( streamtype &(*__pf)(streamtype & ) ) {
+	    return os << __pf;
+	} // operator<<
+
+	streamtype &operator<<( basic_ios<char_type, traits_type> &(*__pf)(basic_ios<char_type, traits_type> & ) ) {
+	    return os << __pf;
+	} // operator<<
+
+	streamtype &operator<<( ios_base &(*__pf)(ios_base & ) ) {
+	    return os << __pf;
+	} // operator<<
+    }; // basic_osbuffer
+
+
+    typedef basic_osbuffer<std::ostream> osbuffer;
 } // namespace std
 
 
@@ -28,15 +28,20 @@
 #define __U_KERNEL__
 #include <uC++.h>
 #include <uFile.h>
+#include <uIOBuf.h>
 
 //#include <uDebug.h>
 
 #include <algorithm>
 using std::min;
 
-#include <cstring>					// strerror
+#include <cstring>					// strerror, memcpy
 #include <unistd.h>					// read, write, close, etc.
 #include <sys/uio.h>					// readv, writev
+#include <sys/mman.h>					// mmap, madvise, msync
+#if defined( __linux__ )
+#include <poll.h>					// poll
+#endif // __linux__
 
 
 //######################### uFileIO #########################
@@ -196,35 +201,158 @@ int uFileIO::write( const char *buf, int len, uDuration *timeout ) {
 
 
 int uFileIO::writev( const struct iovec *iov, int iovcnt, uDuration *timeout ) {
-    int wlen;
+    enum { LocalIOV = 64 };
+    int wlen, count = 0;
+    struct iovec local[LocalIOV], *copy = NULL;		// adjustable copy of caller's vector after a partial write
 
     struct Writev : public uIOClosure {
 	const struct iovec *iov;
 	int iovcnt;
 
-	int action() { return ::writev( access.fd, iov, iovcnt ); }
+	int action() {
+#ifdef __U_STATISTICS__
+	    uFetchAdd( UPP::Statistics::write_syscalls, 1 );
+#endif // __U_STATISTICS__
+	    return ::writev( access.fd, iov, iovcnt );
+	}
 	Writev( uIOaccess &access, int &wlen, const struct iovec *iov, int iovcnt ) : uIOClosure( access, wlen ), iov( iov ), iovcnt( iovcnt ) {}
     } writevClosure( access, wlen, iov, iovcnt );
 
-    writevClosure.wrapper();
-    if ( wlen == -1 && writevClosure.errno_ == U_EWOULDBLOCK ) {
-	if ( ! writevClosure.select( uCluster::WriteSelect, timeout ) ) {
-	    writeTimeout( (const char *)iov, iovcnt, timeout, "writev" );
+    for ( int i = 0; i < iovcnt; i += 1 ) count += iov[i].iov_len;
+
+    for ( ;; ) {					// ensure all data is written, like write
+	writevClosure.wrapper();
+	if ( wlen == -1 && writevClosure.errno_ == U_EWOULDBLOCK ) {
+#ifdef __U_STATISTICS__
+	    uFetchAdd( UPP::Statistics::write_eagain, 1 );
+#endif // __U_STATISTICS__
+	    if ( ! writevClosure.select( uCluster::WriteSelect, timeout ) ) {
+		if ( copy != local ) delete [] copy;
+		writeTimeout( (const char *)iov, iovcnt, timeout, "writev" );
+	    } // if
+	} // if
+	if ( wlen == -1 ) {
+	    // EIO means the write is to stdout but the shell has terminated (I think). Normally, people want this to
+	    // work as if stdout is magically redirected to /dev/null, instead of aborting the program.
+	  if ( writevClosure.errno_ == EIO ) break;
+#ifdef __U_STATISTICS__
+	    uFetchAdd( UPP::Statistics::write_errors, 1 );
+#endif // __U_STATISTICS__
+	    if ( copy != local ) delete [] copy;
+	    writeFailure( writevClosure.errno_, (const char *)iov, iovcnt, timeout, "writev" );
 	} // if
-    } // if
-    if ( wlen == -1 && writevClosure.errno_ != EIO ) {
-	// EIO means the write is to stdout but the shell has terminated (I think). Normally, people want this to work
-	// as if stdout is magically redirected to /dev/null, instead of aborting the program.
-	writeFailure( writevClosure.errno_, (const char *)iov, iovcnt, timeout, "writev" );
-    } // if
+
+	// A partial write leaves the descriptor ready for more, so skip the transferred vector entries, adjust the
+	// partially transferred entry, and write the remainder.
+	while ( writevClosure.iovcnt > 0 && (size_t)wlen >= writevClosure.iov[0].iov_len ) {
+	    wlen -= writevClosure.iov[0].iov_len;
+	    writevClosure.iov += 1;
+	    writevClosure.iovcnt -= 1;
+	} // while
+      if ( writevClosure.iovcnt == 0 ) break;		// transferred across all writes
+	if ( wlen > 0 ) {
+	    if ( copy == NULL ) {			// caller's vector is const
+		copy = writevClosure.iovcnt <= LocalIOV ? local : new struct iovec[writevClosure.iovcnt];
+		memcpy( copy, writevClosure.iov, writevClosure.iovcnt * sizeof(struct iovec) );
+		writevClosure.iov = copy;
+	    } // if
+	    struct iovec *first = (struct iovec *)writevClosure.iov; // points into copy
+	    first->iov_base = (char *)first->iov_base + wlen;
+	    first->iov_len -= wlen;
+	} // if
+    } // for
+    if ( copy != local ) delete [] copy;
 
 #ifdef __U_STATISTICS__
-    uFetchAdd( UPP::Statistics::write_bytes, wlen );
+    uFetchAdd( UPP::Statistics::write_bytes, count );
 #endif // __U_STATISTICS__
-    return wlen;
+    return count;					// always return the specified length
 } // uFileIO::writev
 
 
+int uFileIO::read( uIOBuf &chain, size_t len, uDuration *timeout ) {
+    struct iovec iov[uIOBuf::MaxIOV];
+
+    unsigned int cnt = chain.reserve( len, iov, uIOBuf::MaxIOV );
+    int rlen = readv( iov, cnt, timeout );		// raises on failure, chain unchanged
+    chain.commit( rlen );
+    return rlen;
+} // uFileIO::read
+
+
+int uFileIO::write( uIOBuf &chain, uDuration *timeout ) {
+    struct iovec iov[uIOBuf::MaxIOV];
+    int count = 0;
+
+    while ( ! chain.empty() ) {				// chain may have more segments than one writev accepts
+	unsigned int cnt = chain.iovecs( iov, uIOBuf::MaxIOV );
+	int wlen = writev( iov, cnt, timeout );
+	chain.trim( wlen );
+	count += wlen;
+    } // while
+    return count;
+} // uFileIO::write
+
+
+#if defined( __linux__ )
+// Move up to len bytes from in to out inside the kernel (splice), or duplicate them without consuming the input (tee),
+// so the data never passes through a user buffer. At least one descriptor must be a pipe (both for tee). Returns the
+// number of bytes moved, 0 at end of input, or -1 with errno_ set; timedout indicates a timeout and input whether the
+// timeout or error belongs to the input (true) or output (false) descriptor.
+
+int uFileIO::transfer( uFileIO &in, uFileIO &out, size_t len, unsigned int flags, bool dup, uDuration *timeout, int &errno_, bool &timedout, bool &input ) {
+    int ret;
+
+    struct Splice : public uIOClosure {
+	int in_fd, out_fd;
+	size_t len;
+	unsigned int flags;
+	bool dup;					// tee rather than splice
+	bool direct;					// do not perform splice in uNBIO
+
+	int action() {
+	  if ( ! direct ) return 0;
+	    return dup ? ::tee( in_fd, out_fd, len, flags ) : ::splice( in_fd, NULL, out_fd, NULL, len, flags );
+	} // action
+	Splice( uIOaccess &access, int &ret, int in_fd, int out_fd, size_t len, unsigned int flags, bool dup ) :
+	    uIOClosure( access, ret ), in_fd( in_fd ), out_fd( out_fd ), len( len ), flags( flags ), dup( dup ), direct( true ) {}
+    } inClosure( in.access, ret, in.access.fd, out.access.fd, len, flags | SPLICE_F_NONBLOCK | SPLICE_F_MOVE, dup ),
+      outClosure( out.access, ret, in.access.fd, out.access.fd, len, flags | SPLICE_F_NONBLOCK | SPLICE_F_MOVE, dup );
+
+    // EWOULDBLOCK is ambiguous for splice: the input may be empty or the output full. A zero-timeout poll of the input
+    // decides which descriptor to wait on. As for sendfile, the "direct" flag prevents uNBIO from performing the
+    // transfer when the descriptor becomes ready, since the other descriptor may still block; the splice is retried
+    // here instead.
+
+    timedout = false;
+    input = true;
+    for ( ;; ) {
+	inClosure.wrapper();
+      if ( ret != -1 || inClosure.errno_ != U_EWOULDBLOCK ) break;
+	struct pollfd pfd = { in.access.fd, POLLIN, 0 };
+	input = ::poll( &pfd, 1, 0 ) != 1;		// input not ready => wait for input, otherwise output is full
+	Splice &blocked = input ? inClosure : outClosure;
+	blocked.direct = false;
+	bool ready = blocked.select( input ? uCluster::ReadSelect : uCluster::WriteSelect, timeout );
+	blocked.direct = true;
+	if ( ! ready ) {
+	    timedout = true;
+	    errno_ = ETIMEDOUT;
+	    return -1;
+	} // if
+    } // for
+    if ( ret == -1 ) {
+	errno_ = inClosure.errno_;
+	// splice reports one errno for both descriptors, so attribute the error to the output when it is a broken pipe or
+	// the output descriptor itself is in error.
+	struct pollfd pfd = { out.access.fd, 0, 0 };
+	input = ! ( errno_ == EPIPE || ( ::poll( &pfd, 1, 0 ) == 1 && ( pfd.revents & (POLLERR | POLLNVAL) ) ) );
+    } // if
+    return ret;
+} // uFileIO::transfer
+#endif // __linux__
+
+
 //######################### FileAccess #########################
 
 
@@ -345,22 +473,23 @@ void uFile::FileAccess::createAccess( int flags, int mode ) {
 } // uFile::FileAccess::createAccess
 
 
-uFile::FileAccess::FileAccess() : uFileIO( access ), own( false ) {
+uFile::FileAccess::FileAccess() : uFileIO( access ), own( false ), group( NULL ) {
 } // uFile::FileAccess::FileAccess
 
 
-uFile::FileAccess::FileAccess( uFile &f, int flags, int mode ) : uFileIO( access ), file( &f ), own( false ) {
+uFile::FileAccess::FileAccess( uFile &f, int flags, int mode ) : uFileIO( access ), file( &f ), own( false ), group( NULL ) {
     createAccess( flags, mode );
 } // uFile::FileAccess::FileAccess
 
 
-uFile::FileAccess::FileAccess( const char *name, int flags, int mode ) : uFileIO( access ), own( true ) {
+uFile::FileAccess::FileAccess( const char *name, int flags, int mode ) : uFileIO( access ), own( true ), group( NULL ) {
     file = new uFile( name );
     createAccess( flags, mode );
 } // uFile::FileAccess::FileAccess
 
 
 uFile::FileAccess::~FileAccess() {
+    delete group;
     file->unaccess();
     if ( access.poll.getStatus() == uPoll::AlwaysPoll ) access.poll.clearPollFlag( access.fd );
     if ( access.fd >= 3 ) {				// don't close the standard file descriptors
@@ -412,6 +541,474 @@ int uFile::FileAccess::fsync() {
 } // uFile::FileAccess::fsync
 
 
+//######################### MappedAccess #########################
+
+
+// Page faults and synchronous msyncs block a kernel thread, so they are performed on a helper processor on its own
+// cluster, created when first needed and shared by all mappings. Asynchronous prefetches are queued to a pager task on
+// that cluster; a synchronous operation migrates the calling task there for its duration.
+
+_Task uFilePagerTask;					// forward declaration
+
+class uFilePager {
+    friend _Task uFilePagerTask;			// access: run
+
+    struct Request {
+	const void *owner;				// requesting mapping
+	char *addr;					// page aligned
+	size_t len;
+	UPP::uSemaphore *done;				// != NULL => marker, restart waiting task
+	Request *next;
+    }; // uFilePager::Request
+
+    uSpinLock lock;
+    Request *head, *tail;
+    UPP::uSemaphore work;				// number of queued requests
+    uFilePagerTask *task;
+
+    void enqueue( Request *r );
+    void run();
+  public:
+    uCluster cluster;
+    uProcessor processor;
+
+    uFilePager();
+    ~uFilePager();
+    void prefetch( const void *owner, char *addr, size_t len );
+    void cancel( const void *owner );
+    static void populate( char *addr, size_t len );
+}; // uFilePager
+
+
+_Task uFilePagerTask {
+    uFilePager &pager;
+
+    void main() {
+	pager.run();
+    } // uFilePagerTask::main
+  public:
+    uFilePagerTask( uFilePager &pager ) : uBaseTask( pager.cluster ), pager( pager ) {}
+}; // uFilePagerTask
+
+
+uFilePager::uFilePager() : head( NULL ), tail( NULL ), work( 0 ), cluster( "uFilePager" ), processor( cluster ) {
+    task = new uFilePagerTask( *this );
+} // uFilePager::uFilePager
+
+
+uFilePager::~uFilePager() {
+    Request *r = new Request;				// owner NULL and no marker => stop
+    r->owner = NULL;
+    r->done = NULL;
+    enqueue( r );
+    delete task;
+} // uFilePager::~uFilePager
+
+
+void uFilePager::enqueue( Request *r ) {
+    r->next = NULL;
+    lock.acquire();
+    if ( tail == NULL ) head = r;
+    else tail->next = r;
+    tail = r;
+    lock.release();
+    work.V();
+} // uFilePager::enqueue
+
+
+void uFilePager::run() {
+    for ( ;; ) {
+	work.P();
+	lock.acquire();
+	Request *r = head;
+	if ( r != NULL ) {
+	    head = r->next;
+	    if ( head == NULL ) tail = NULL;
+	} // if
+	lock.release();
+      if ( r == NULL ) continue;			// request cancelled
+	bool stop = r->owner == NULL && r->done == NULL;
+	if ( r->done != NULL ) {
+	    r->done->V();
+	} else if ( ! stop ) {
+	    populate( r->addr, r->len );
+	} // if
+	delete r;
+      if ( stop ) break;
+    } // for
+} // uFilePager::run
+
+
+void uFilePager::prefetch( const void *owner, char *addr, size_t len ) {
+    Request *r = new Request;
+    r->owner = owner;
+    r->addr = addr;
+    r->len = len;
+    r->done = NULL;
+    enqueue( r );
+} // uFilePager::prefetch
+
+
+// Remove the mapping's queued prefetches, then wait for a marker to pass through the queue, so a prefetch in progress
+// has finished before the mapping is removed.
+
+void uFilePager::cancel( const void *owner ) {
+    lock.acquire();
+    Request *prev = NULL;
+    for ( Request *r = head; r != NULL; ) {
+	Request *next = r->next;
+	if ( r->owner == owner && r->done == NULL ) {
+	    if ( prev == NULL ) head = next;
+	    else prev->next = next;
+	    if ( tail == r ) tail = prev;
+	    delete r;
+	} else {
+	    prev = r;
+	} // if
+	r = next;
+    } // for
+    lock.release();
+
+    UPP::uSemaphore done( 0 );
+    Request *marker = new Request;
+    marker->owner = owner;
+    marker->done = &done;
+    enqueue( marker );
+    done.P();
+} // uFilePager::cancel
+
+
+void uFilePager::populate( char *addr, size_t len ) {
+#if defined( MADV_POPULATE_READ )			// Linux >= 5.14, fault range in one system call
+  if ( ::madvise( addr, len, MADV_POPULATE_READ ) == 0 ) return;
+#endif // MADV_POPULATE_READ
+    size_t page = sysconf( _SC_PAGESIZE );
+    for ( size_t i = 0; i < len; i += page ) {		// touch each page
+	(void)((volatile char *)addr)[i];
+    } // for
+} // uFilePager::populate
+
+
+// Group commits' fdatasyncs also block a kernel thread, so they are performed on a second helper processor and cluster,
+// and a long commit and the pager's page faults and msyncs do not hold each other up.
+
+struct uFileSyncer {
+    uCluster cluster;
+    uProcessor processor;
+
+    uFileSyncer() : cluster( "uFileSyncer" ), processor( cluster ) {}
+}; // uFileSyncer
+
+
+static uSpinLock helperLock;
+static uFilePager *pager = NULL;
+static uFileSyncer *syncer = NULL;
+
+
+// The helpers are kept until the program ends (see uFile::finishup), so programs that repeatedly map files or commit to
+// new files do not create and destroy a kernel thread each time.
+
+template< typename Helper > static void HelperAcquire( Helper *&helper ) {
+    helperLock.acquire();
+    Helper *exists = helper;
+    helperLock.release();
+  if ( exists != NULL ) return;				// already created ?
+
+    Helper *h = new Helper;				// creating a processor blocks, so not under the spin lock
+    helperLock.acquire();
+    if ( helper == NULL ) {
+	helper = h;
+	h = NULL;
+    } // if
+    helperLock.release();
+    if ( h != NULL ) delete h;				// another task created the helper first
+} // HelperAcquire
+
+
+void uFile::finishup() {
+    delete pager;
+    pager = NULL;
+    delete syncer;
+    syncer = NULL;
+} // uFile::finishup
+
+
+uFile::MappedAccess::Failure::Failure( const MappedAccess &ma, int errno_, const char *const msg ) : uFile::Failure( *ma.file, errno_, msg ), ma( ma ) {
+} // uFile::MappedAccess::Failure::Failure
+
+void uFile::MappedAccess::Failure::defaultTerminate() const {
+    uAbort( "(MappedAccess &)%p( file:%p ), %.256s file \"%.256s\".",
+	    &mappedAccess(), &file(), message(), getName() );
+} // uFile::MappedAccess::Failure::defaultTerminate
+
+
+uFile::MappedAccess::MapFailure::MapFailure( const MappedAccess &ma, int errno_, int flags, size_t len, off_t offset, const char *const msg ) :
+	uFile::MappedAccess::Failure( ma, errno_, msg ), flags( flags ), len( len ), offset( offset ) {}
+
+void uFile::MappedAccess::MapFailure::defaultTerminate() const {
+    uAbort( "(MappedAccess &)%p.MappedAccess( file:%p, flags:0x%x, len:%zu, offset:%lld ), %.256s \"%.256s\".\nError(%d) : %s.",
+	    &mappedAccess(), &file(), flags, len, (long long int)offset, message(), getName(), errNo(), strerror( errNo() ) );
+} // uFile::MappedAccess::MapFailure::defaultTerminate
+
+
+uFile::MappedAccess::SyncFailure::SyncFailure( const MappedAccess &ma, int errno_, const char *const msg ) : uFile::MappedAccess::Failure( ma, errno_, msg ) {}
+
+void uFile::MappedAccess::SyncFailure::defaultTerminate() const {
+    uAbort( "(MappedAccess &)%p.msync(), %.256s \"%.256s\".\nError(%d) : %s.",
+	    &mappedAccess(), message(), getName(), errNo(), strerror( errNo() ) );
+} // uFile::MappedAccess::SyncFailure::defaultTerminate
+
+
+void uFile::MappedAccess::createMapping( int flags, size_t len, off_t offset ) {
+    int fd;
+
+    for ( ;; ) {
+	fd = ::open( file->name, flags & O_ACCMODE );
+      if ( fd != -1 || errno != EINTR ) break;		// timer interrupt ?
+    } // for
+    if ( fd == -1 ) {
+	_Throw uFile::MappedAccess::MapFailure( *this, errno, flags, len, offset, "unable to access file" );
+    } // if
+    if ( len == 0 ) {					// map to end of file
+	struct stat buf;
+	if ( ::fstat( fd, &buf ) == -1 ) {
+	    int errno_ = errno;
+	    ::close( fd );
+	    _Throw uFile::MappedAccess::MapFailure( *this, errno_, flags, len, offset, "unable to obtain size of file" );
+	} // if
+	len = buf.st_size > offset ? buf.st_size - offset : 0;
+    } // if
+
+    writable = ( flags & O_ACCMODE ) == O_RDWR;
+    if ( len != 0 ) {					// mmap rejects empty mappings
+	void *addr = ::mmap( NULL, len, PROT_READ | ( writable ? PROT_WRITE : 0 ), MAP_SHARED, fd, offset );
+	if ( addr == MAP_FAILED ) {
+	    int errno_ = errno;
+	    ::close( fd );
+	    _Throw uFile::MappedAccess::MapFailure( *this, errno_, flags, len, offset, "unable to map file" );
+	} // if
+	base = (char *)addr;
+    } // if
+    length = len;
+    ::close( fd );					// mapping remains after descriptor closed
+    file->access();
+} // uFile::MappedAccess::createMapping
+
+
+uFile::MappedAccess::MappedAccess( uFile &f, int flags, size_t len, off_t offset ) : file( &f ), own( false ), base( NULL ), length( 0 ), paging( false ) {
+    createMapping( flags, len, offset );
+} // uFile::MappedAccess::MappedAccess
+
+
+uFile::MappedAccess::MappedAccess( const char *name, int flags, size_t len, off_t offset ) : own( true ), base( NULL ), length( 0 ), paging( false ) {
+    file = new uFile( name );
+    try {
+	createMapping( flags, len, offset );
+    } catch( ... ) {					// destructor not run for partially constructed object
+	delete file;					// exception copied the file name
+	throw;
+    } // try
+} // uFile::MappedAccess::MappedAccess
+
+
+uFile::MappedAccess::~MappedAccess() {
+    if ( paging ) {					// no prefetch may touch the mapping after it is removed
+	pager->cancel( this );
+    } // if
+    if ( base != NULL ) ::munmap( base, length );
+    file->unaccess();
+    if ( own ) delete file;
+} // uFile::MappedAccess::~MappedAccess
+
+
+// Clip [off, off + len) to the mapping, then extend it down to a page boundary as required by madvise and msync.
+
+void uFile::MappedAccess::range( size_t &off, size_t &len ) const {
+    if ( off > length ) off = length;
+    if ( len == 0 || len > length - off ) len = length - off;
+    size_t page = sysconf( _SC_PAGESIZE );
+    size_t adjust = ( (unsigned long int)( base + off ) ) & ( page - 1 );
+    off -= adjust;
+    if ( len != 0 ) len += adjust;
+} // uFile::MappedAccess::range
+
+
+bool uFile::MappedAccess::advise( Advice advice, size_t off, size_t len ) {
+    static const int advices[] = { MADV_NORMAL, MADV_SEQUENTIAL, MADV_RANDOM, MADV_WILLNEED, MADV_DONTNEED,
+#if defined( MADV_HUGEPAGE )
+				   MADV_HUGEPAGE,
+#else
+				   -1,
+#endif // MADV_HUGEPAGE
+    };
+
+    range( off, len );
+  if ( len == 0 ) return true;				// empty mapping
+  if ( advices[advice] == -1 ) return false;
+    return ::madvise( base + off, len, advices[advice] ) == 0;
+} // uFile::MappedAccess::advise
+
+
+void uFile::MappedAccess::prefetch( size_t off, size_t len, bool wait ) {
+    range( off, len );
+  if ( len == 0 ) return;
+
+    ::madvise( base + off, len, MADV_WILLNEED );	// start kernel readahead now
+    if ( ! paging ) {
+	HelperAcquire( pager );
+	paging = true;
+    } // if
+    if ( wait ) {					// fault on helper processor, caller's processor continues
+	uCluster &prev = uBaseTask::migrate( pager->cluster );
+	uFilePager::populate( base + off, len );
+	uBaseTask::migrate( prev );
+    } else {
+	pager->prefetch( this, base + off, len );
+    } // if
+} // uFile::MappedAccess::prefetch
+
+
+void uFile::MappedAccess::msync( size_t off, size_t len, bool wait ) {
+    range( off, len );
+  if ( len == 0 || ! writable ) return;
+
+    int retcode, errno_;
+    if ( wait ) {					// write back on helper processor
+	if ( ! paging ) {
+	    HelperAcquire( pager );
+	    paging = true;
+	} // if
+	uCluster &prev = uBaseTask::migrate( pager->cluster );
+	retcode = ::msync( base + off, len, MS_SYNC );
+	errno_ = errno;
+	uBaseTask::migrate( prev );
+    } else {
+	retcode = ::msync( base + off, len, MS_ASYNC );
+	errno_ = errno;
+    } // if
+    if ( retcode == -1 ) {
+	_Throw uFile::MappedAccess::SyncFailure( *this, errno_, "could not msync mapping" );
+    } // if
+} // uFile::MappedAccess::msync
+
+
+//######################### FileAccess group commit #########################
+
+
+struct uFile::FileAccess::GroupCommit {
+    struct Waiter {					// task waiting for a batch
+	unsigned long int ticket;			// commit number
+	bool lead;					// woken to become leader of the next batch
+	int error;					// errno of batch, 0 => durable
+	UPP::uSemaphore wake;
+	Waiter *next;
+	Waiter( unsigned long int ticket ) : ticket( ticket ), lead( false ), error( 0 ), wake( 0 ), next( NULL ) {}
+    }; // Waiter
+
+    uSpinLock lock;
+    unsigned long int requested;			// commits requested
+    bool syncing;					// leader active
+    Waiter *waiters;
+    uDuration window;
+
+    GroupCommit() : requested( 0 ), syncing( false ), waiters( NULL ), window( 0, 0 ) {
+	HelperAcquire( syncer );
+    } // GroupCommit::GroupCommit
+}; // uFile::FileAccess::GroupCommit
+
+
+uFile::FileAccess::GroupCommit &uFile::FileAccess::groupCommit() {
+    if ( group == NULL ) {				// first use ?
+	GroupCommit *g = new GroupCommit;
+	if ( ! uCompareAssign( group, (GroupCommit *)NULL, g ) ) delete g; // another task created it first
+    } // if
+    return *group;
+} // uFile::FileAccess::groupCommit
+
+
+void uFile::FileAccess::commitWindow( uDuration window ) {
+    groupCommit().window = window;
+} // uFile::FileAccess::commitWindow
+
+
+// The first committing task becomes the leader: it takes a snapshot of the commits requested, performs one fdatasync on
+// the commit helper processor, and wakes every task whose commit is covered. Tasks arriving during the fdatasync wait
+// for the next batch, and one of them is woken as its leader.
+
+void uFile::FileAccess::commit() {
+    GroupCommit &gc = groupCommit();
+
+    gc.lock.acquire();
+    gc.requested += 1;
+    if ( gc.syncing ) {					// leader active => wait for a batch
+	GroupCommit::Waiter w( gc.requested );
+	w.next = gc.waiters;
+	gc.waiters = &w;
+	gc.lock.release();
+	w.wake.P();
+	if ( ! w.lead ) {				// commit covered by a batch
+	    if ( w.error != 0 ) {
+		_Throw uFile::FileAccess::SyncFailure( *this, w.error, "could not commit file" );
+	    } // if
+	    return;
+	} // if
+    } else {
+	gc.syncing = true;
+	gc.lock.release();
+    } // if
+
+    if ( gc.window > uDuration( 0, 0 ) ) {		// let more commits join
+	_Timeout( gc.window );
+    } // if
+    gc.lock.acquire();
+    unsigned long int target = gc.requested;		// commits covered by this fdatasync
+    gc.lock.release();
+
+    uCluster &prev = uBaseTask::migrate( syncer->cluster );
+    int retcode, errno_ = 0;
+    for ( ;; ) {
+	retcode = ::fdatasync( access.fd );
+      if ( retcode != -1 || errno != EINTR ) break;	// timer interrupt ?
+    } // for
+    if ( retcode == -1 ) errno_ = errno;
+    uBaseTask::migrate( prev );
+
+    GroupCommit::Waiter *done = NULL, *leader = NULL;
+    gc.lock.acquire();
+    for ( GroupCommit::Waiter **wp = &gc.waiters; *wp != NULL; ) { // remove covered waiters
+	GroupCommit::Waiter *w = *wp;
+	if ( w->ticket <= target ) {
+	    *wp = w->next;
+	    w->next = done;
+	    done = w;
+	} else {
+	    wp = &w->next;
+	} // if
+    } // for
+    if ( gc.waiters != NULL ) {				// commits after snapshot => hand off leadership
+	leader = gc.waiters;
+	gc.waiters = leader->next;
+    } else {
+	gc.syncing = false;
+    } // if
+    gc.lock.release();
+
+    while ( done != NULL ) {
+	GroupCommit::Waiter *next = done->next;		// waiter's storage disappears once restarted
+	done->error = errno_;
+	done->wake.V();
+	done = next;
+    } // while
+    if ( leader != NULL ) {
+	leader->lead = true;
+	leader->wake.V();
+    } // if
+    if ( errno_ != 0 ) {
+	_Throw uFile::FileAccess::SyncFailure( *this, errno_, "could not commit file" );
+    } // if
+} // uFile::FileAccess::commit
+
+
 //######################### uFile #########################
 
 
@@ -548,6 +1145,25 @@ void uPipe::End::writeTimeout( const char *buf, const int len, const uDuration *
 } // uPipe::End::writeTimeout
 
 
+#if defined( __linux__ )
+int uPipe::End::tee( End &out, size_t len, uDuration *timeout ) {
+    int terrno;
+    bool timedout, input;
+
+    int ret = transfer( *this, out, len, 0, true, timeout, terrno, timedout, input );
+    if ( ret == -1 ) {
+	if ( timedout ) {
+	    if ( input ) readTimeout( NULL, len, timeout, "tee" );
+	    else writeTimeout( NULL, len, timeout, "tee" );
+	} // if
+	if ( input ) readFailure( terrno, NULL, len, timeout, "tee" );
+	else writeFailure( terrno, NULL, len, timeout, "tee" );
+    } // if
+    return ret;
+} // uPipe::End::tee
+#endif // __linux__
+
+
 //######################### uPipe #########################
 
 
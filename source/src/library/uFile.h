@@ -42,6 +42,9 @@
 //######################### uFileIO #########################
 
 
+class uIOBuf;						// forward declaration
+
+
 class uFileIO {						// monitor
   protected:
     uIOaccess &access;
@@ -53,6 +56,10 @@ class uFileIO {						// monitor
     virtual void writeFailure( int errno_, const char *buf, const int len, const uDuration *timeout, const char *const op ) = 0;
     virtual void writeTimeout( const char *buf, const int len, const uDuration *timeout, const char *const op ) = 0;
 
+#if defined( __linux__ )
+    static int transfer( uFileIO &in, uFileIO &out, size_t len, unsigned int flags, bool dup, uDuration *timeout, int &errno_, bool &timedout, bool &input );
+#endif // __linux__
+
     uFileIO( uIOaccess &acc ) : access( acc ) {
     } // uFileIO::uFileIO
 
@@ -63,6 +70,8 @@ class uFileIO {						// monitor
     int readv( const struct iovec *iov, int iovcnt, uDuration *timeout = NULL );
     _Mutex int write( const char *buf, int len, uDuration *timeout = NULL );
     int writev( const struct iovec *iov, int iovcnt, uDuration *timeout = NULL );
+    int read( uIOBuf &chain, size_t len, uDuration *timeout = NULL ); // append up to len bytes to chain
+    _Mutex int write( uIOBuf &chain, uDuration *timeout = NULL ); // write and consume entire chain
 
     int fd() {
 	return access.fd;
@@ -76,10 +85,14 @@ class uFileIO {						// monitor
 class uFile {
     friend class uFileWrapper;
     friend class FileAccess;
+    friend class MappedAccess;
+    friend class UPP::uKernelBoot;			// access: finishup
 
     char *name;
     int accessCnt;
 
+    static void finishup();				// remove helper processors
+
     void access() {
 	uFetchAdd( accessCnt, 1 );
     } // uFile::access
@@ -117,13 +130,17 @@ class uFile {
 	template< typename char_t, typename traits > friend class std::basic_filebuf; // access: constructor
 	friend class uSocketIO;				// access: access
 
+	struct GroupCommit;				// state of commits in progress, created on first commit
+
 	uFile *file;
 	const bool own;
 	uIOaccess access;
+	GroupCommit *group;
 
 	void createAccess( int flags, int mode );
+	GroupCommit &groupCommit();
 
-	FileAccess( int fd, uFile &f ) : uFileIO( access ), file( &f ), own( false ) {
+	FileAccess( int fd, uFile &f ) : uFileIO( access ), file( &f ), own( false ), group( NULL ) {
 	    access.fd = fd;
 	    access.poll.setStatus( uPoll::PollOnDemand );
 	    file->access();
@@ -216,12 +233,90 @@ class uFile {
 	off_t lseek( off_t offset, int whence );
 	int fsync();
 
+	// Group commit: make previous writes durable with fdatasync, sharing one fdatasync among all tasks committing
+	// concurrently, and waking them together when it completes. The fdatasync runs on a helper processor, so the
+	// committing tasks' processors are not blocked. The first task of a batch waits for the commit window (default 0)
+	// before the fdatasync, letting more tasks join the batch.
+	void commit();
+	void commitWindow( uDuration window );
+
 	void status( struct stat &buf ) {
 	    file->status( buf );
 	} // FileAccess::status
     }; // FileAccess
 
 
+    // A mapping of a file into memory, so the file contents are accessed in place without a system call and a copy for
+    // each access. A page fault blocks the faulting processor like a blocking read, so ranges about to be used should be
+    // prefetched: prefetch faults the pages in on a helper processor shared by all mappings, either asynchronously
+    // (the call returns immediately) or synchronously (the calling task moves to the helper processor while the pages
+    // are faulted), so other tasks on the caller's processor are not stalled. A synchronous msync also runs on the
+    // helper processor.
+
+    class MappedAccess {
+	uFile *file;
+	const bool own;
+	char *base;					// mapping, NULL => empty
+	size_t length;
+	bool writable;
+	bool paging;					// helper processor acquired
+
+	void createMapping( int flags, size_t len, off_t offset );
+	void range( size_t &off, size_t &len ) const;
+      public:
+	enum Advice { Normal, Sequential, Random, WillNeed, DontNeed, HugePage };
+
+	_Event Failure : public uFile::Failure {
+	    const MappedAccess &ma;
+	  protected:
+	    Failure( const MappedAccess &ma, int errno_, const char *const msg );
+	  public:
+	    const MappedAccess &mappedAccess() const { return ma; }
+	    virtual void defaultTerminate() const;
+	}; // MappedAccess::Failure
+
+	friend _Event Failure;
+
+	_Event MapFailure : public Failure {
+	    const int flags;
+	    const size_t len;
+	    const off_t offset;
+	  public:
+	    MapFailure( const MappedAccess &ma, int errno_, int flags, size_t len, off_t offset, const char *const msg );
+	    virtual void defaultTerminate() const;
+	}; // MappedAccess::MapFailure
+
+	_Event SyncFailure : public Failure {
+	  public:
+	    SyncFailure( const MappedAccess &ma, int errno_, const char *const msg );
+	    virtual void defaultTerminate() const;
+	}; // MappedAccess::SyncFailure
+
+
+	// flags is O_RDONLY or O_RDWR, len 0 => from offset to end of file, offset must be a multiple of the page size
+	MappedAccess( uFile &f, int flags = O_RDONLY, size_t len = 0, off_t offset = 0 );
+	MappedAccess( const char *name, int flags = O_RDONLY, size_t len = 0, off_t offset = 0 );
+	~MappedAccess();
+
+	char *data() const {
+	    return base;
+	} // MappedAccess::data
+
+	size_t size() const {
+	    return length;
+	} // MappedAccess::size
+
+	// For the following, a range is [off, off + len) of the mapping, len 0 => to end of mapping.
+	bool advise( Advice advice, size_t off = 0, size_t len = 0 ); // false => hint not supported for this mapping
+	void prefetch( size_t off = 0, size_t len = 0, bool wait = false ); // fault range in on helper processor
+	void msync( size_t off = 0, size_t len = 0, bool wait = true ); // write modified pages, wait => until written
+
+	void status( struct stat &buf ) {
+	    file->status( buf );
+	} // MappedAccess::status
+    }; // MappedAccess
+
+
     uFile() {
 	name = NULL;
 	accessCnt = 0;
@@ -281,6 +376,10 @@ class uPipe {
 	End() : uFileIO( access ) {}
 	_Mutex virtual ~End() {}
       public:
+#if defined( __linux__ )
+	int tee( End &out, size_t len, uDuration *timeout = NULL ); // duplicate pipe data into out without consuming it
+#endif // __linux__
+
 	_Event Failure : public uPipe::Failure {
 	    const End &end;
 	    int fd;
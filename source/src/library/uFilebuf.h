@@ -43,6 +43,7 @@ namespace std {
     template< typename char_t, typename traits >
     class basic_filebuf : public basic_streambuf<char_t, traits> {
 	template<typename streamtype> friend class basic_acquire;
+	template<typename streamtype> friend class basic_osbuffer;
 	template<typename Ch, typename Tr> friend basic_ios<Ch,Tr> &acquire( basic_ios<Ch,Tr> &os );
 	template<typename Ch, typename Tr> friend basic_ios<Ch,Tr> &release( basic_ios<Ch,Tr> &os );
 	template<typename Ch, typename Tr> friend uBaseTask *owner( basic_ios<Ch,Tr> &os );
@@ -85,6 +86,7 @@ namespace std {
 	int sync();
 	int pbackfail( int_type c = EOF );
 	void imbue( const locale & );
+	void append( const char_type *s, streamsize n, bool flush );
       public:
 	basic_filebuf();
 	basic_filebuf( int fd, int bufsize = __U_BUFFER_SIZE__ );
@@ -382,6 +384,36 @@ namespace std {
     } // basic_filebuf<char_t, traits>::sync
 
 
+// non-standard
+    // Add a complete record to the output buffer atomically with respect to other records and locked output. The lock
+    // is held only to copy the record, or to write when the record does not fit, instead of for the formatting.
+
+    template< typename char_t, typename traits >
+    void basic_filebuf<char_t, traits>::append( const char_type *s, streamsize n, bool flush ) {
+	if ( ! is_open() ) return;			// file open ?
+
+	ownerlock.acquire();
+	try {
+	    if ( n > epptr() - pptr() ) {		// record does not fit ?
+		sync();					// write buffered output first, preserving order
+		if ( n >= bufsize - 1 ) {		// too large to buffer => write directly
+		    ufileacc->write( (const char *)s, n * sizeof(char_type) );
+		    n = 0;
+		} // if
+	    } // if
+	    if ( n > 0 ) {
+		traits::copy( pptr(), s, n );
+		this->pbump( n );
+	    } // if
+	    if ( flush ) sync();
+	} catch( ... ) {
+	    ownerlock.release();
+	    throw;
+	} // try
+	ownerlock.release();
+    } // basic_filebuf<char_t, traits>::append
+
+
 /*
   Members mentioned in 27.8.1.4 but not overridden here:
 
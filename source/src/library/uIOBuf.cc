@@ -0,0 +1,435 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// uIOBuf.cc --
+//
+// Author           : agent
+// Created On       : Mon Oct 19 01:30:06 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 02:36:43 2026
+// Update Count     : 2
+//
+// This  library is free  software; you  can redistribute  it and/or  modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software  Foundation; either  version 2.1 of  the License, or  (at your
+// option) any later version.
+//
+// This library is distributed in the  hope that it will be useful, but WITHOUT
+// ANY  WARRANTY;  without even  the  implied  warranty  of MERCHANTABILITY  or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+//
+// You should  have received a  copy of the  GNU Lesser General  Public License
+// along  with this library.
+//
+
+
+#define __U_KERNEL__
+#include <uC++.h>
+#include <uIOBuf.h>
+//#include <uDebug.h>
+
+#include <cstdlib>					// malloc, free
+#include <cstring>					// memcpy
+
+
+//######################### uIOBuf::Block #########################
+
+
+// Free blocks of the default size, shared by all chains. A block and its storage are one allocation, so a pooled block
+// is reused without touching the allocator.
+
+static uSpinLock poolLock;
+static uIOBuf::Block *poolBlocks = NULL;
+static unsigned int poolCnt = 0, poolMax = 256;
+
+
+uIOBuf::Block *uIOBuf::Block::alloc( size_t size ) {
+    Block *b = NULL;
+
+    if ( size == BlockSize && poolBlocks != NULL ) {	// optimistic check
+	poolLock.acquire();
+	b = poolBlocks;
+	if ( b != NULL ) {
+	    poolBlocks = b->next;
+	    poolCnt -= 1;
+	} // if
+	poolLock.release();
+    } // if
+    if ( b == NULL ) {
+	b = (Block *)malloc( sizeof(Block) + size );
+	if ( b == NULL ) uAbort( "uIOBuf::Block::alloc : unable to allocate block of %zu bytes", size );
+	b->capacity = size;
+	b->base = (char *)( b + 1 );
+	b->userStorage = false;
+	b->release = NULL;
+	b->arg = NULL;
+    } // if
+    b->refs = 1;
+    b->next = NULL;
+    return b;
+} // uIOBuf::Block::alloc
+
+
+uIOBuf::Block *uIOBuf::Block::external( char *data, size_t len, void (*release)( void * ), void *arg ) {
+    Block *b = (Block *)malloc( sizeof(Block) );
+    if ( b == NULL ) uAbort( "uIOBuf::Block::external : unable to allocate block" );
+    b->refs = 1;
+    b->capacity = len;
+    b->base = data;
+    b->userStorage = true;
+    b->release = release;
+    b->arg = arg;
+    b->next = NULL;
+    return b;
+} // uIOBuf::Block::external
+
+
+void uIOBuf::Block::acquire() {
+    uFetchAdd( refs, 1 );
+} // uIOBuf::Block::acquire
+
+
+void uIOBuf::Block::unacquire() {
+  if ( uFetchAdd( refs, -1 ) != 1 ) return;		// other segments still refer to block ?
+
+    // The capacity of user storage can equal BlockSize, so only the userStorage flag keeps a user buffer out of the
+    // pool.
+    if ( userStorage ) {				// user storage, only the block header is freed
+	if ( release != NULL ) release( arg );
+    } else if ( capacity == BlockSize && poolCnt < poolMax ) {
+	poolLock.acquire();
+	if ( poolCnt < poolMax ) {
+	    next = poolBlocks;
+	    poolBlocks = this;
+	    poolCnt += 1;
+	    poolLock.release();
+	    return;
+	} // if
+	poolLock.release();
+    } // if
+    free( this );
+} // uIOBuf::Block::unacquire
+
+
+//######################### uIOBuf #########################
+
+
+uIOBuf::Segment *uIOBuf::segment( Block *block, char *data, size_t len ) {
+    Segment *s = new Segment;
+    s->block = block;
+    s->data = data;
+    s->len = len;
+    s->next = NULL;
+    return s;
+} // uIOBuf::segment
+
+
+void uIOBuf::release( Segment *s ) {
+    s->block->unacquire();
+    delete s;
+} // uIOBuf::release
+
+
+size_t uIOBuf::room() const {
+  if ( tail == NULL || tail->block->refs != 1 || tail->block->userStorage ) return 0; // read only
+    return tail->block->base + tail->block->capacity - ( tail->data + tail->len );
+} // uIOBuf::room
+
+
+void uIOBuf::link( Segment *s ) {
+    s->next = NULL;
+    if ( tail == NULL ) head = s;
+    else tail->next = s;
+    tail = s;
+    length += s->len;
+    nsegs += 1;
+} // uIOBuf::link
+
+
+uIOBuf::Segment *uIOBuf::unlink() {
+    Segment *s = head;
+    head = s->next;
+    if ( head == NULL ) tail = NULL;
+    length -= s->len;
+    nsegs -= 1;
+    s->next = NULL;
+    return s;
+} // uIOBuf::unlink
+
+
+void uIOBuf::copy( const uIOBuf &other ) {
+    for ( Segment *s = other.head; s != NULL; s = s->next ) {
+	s->block->acquire();
+	link( segment( s->block, s->data, s->len ) );
+    } // for
+} // uIOBuf::copy
+
+
+uIOBuf::uIOBuf() : head( NULL ), tail( NULL ), length( 0 ), nsegs( 0 ), spare( NULL ), rsvRoom( false ) {
+} // uIOBuf::uIOBuf
+
+
+uIOBuf::uIOBuf( const uIOBuf &other ) : head( NULL ), tail( NULL ), length( 0 ), nsegs( 0 ), spare( NULL ), rsvRoom( false ) {
+    copy( other );
+} // uIOBuf::uIOBuf
+
+
+uIOBuf &uIOBuf::operator=( const uIOBuf &other ) {
+    if ( this != &other ) {
+	clear();
+	copy( other );
+    } // if
+    return *this;
+} // uIOBuf::operator=
+
+
+uIOBuf::~uIOBuf() {
+    clear();
+    while ( spare != NULL ) {
+	Segment *s = spare;
+	spare = s->next;
+	release( s );
+    } // while
+} // uIOBuf::~uIOBuf
+
+
+void uIOBuf::append( const char *data, size_t len ) {
+    while ( len > 0 ) {
+	size_t avail = room();
+	if ( avail == 0 ) {
+	    Block *b = Block::alloc( len > BlockSize ? len : (size_t)BlockSize );
+	    link( segment( b, b->base, 0 ) );
+	    avail = b->capacity;
+	} // if
+	size_t n = len < avail ? len : avail;
+	memcpy( tail->data + tail->len, data, n );
+	tail->len += n;
+	length += n;
+	data += n;
+	len -= n;
+    } // while
+} // uIOBuf::append
+
+
+void uIOBuf::append( uIOBuf &chain ) {
+  if ( &chain == this || chain.head == NULL ) return;
+    if ( tail == NULL ) head = chain.head;
+    else tail->next = chain.head;
+    tail = chain.tail;
+    length += chain.length;
+    nsegs += chain.nsegs;
+    chain.head = chain.tail = NULL;
+    chain.length = 0;
+    chain.nsegs = 0;
+} // uIOBuf::append
+
+
+void uIOBuf::attach( char *data, size_t len, void (*release)( void * ), void *arg ) {
+    Block *b = Block::external( data, len, release, arg );
+    link( segment( b, data, len ) );
+} // uIOBuf::attach
+
+
+void uIOBuf::prepend( const char *data, size_t len ) {
+  if ( len == 0 ) return;
+    if ( head != NULL && head->block->refs == 1 && ! head->block->userStorage && // user storage is read only
+	 (size_t)( head->data - head->block->base ) >= len ) {
+	head->data -= len;				// room before first segment
+	memcpy( head->data, data, len );
+	head->len += len;
+	length += len;
+	return;
+    } // if
+
+    // Place the data at the end of a new block so a later prepend (e.g., an outer protocol header) fits before it.
+    Block *b = Block::alloc( len > BlockSize ? len : (size_t)BlockSize );
+    Segment *s = segment( b, b->base + b->capacity - len, len );
+    memcpy( s->data, data, len );
+    s->next = head;
+    head = s;
+    if ( tail == NULL ) tail = s;
+    length += len;
+    nsegs += 1;
+} // uIOBuf::prepend
+
+
+void uIOBuf::prepend( uIOBuf &chain ) {
+  if ( &chain == this || chain.head == NULL ) return;
+    chain.tail->next = head;
+    head = chain.head;
+    if ( tail == NULL ) tail = chain.tail;
+    length += chain.length;
+    nsegs += chain.nsegs;
+    chain.head = chain.tail = NULL;
+    chain.length = 0;
+    chain.nsegs = 0;
+} // uIOBuf::prepend
+
+
+void uIOBuf::split( size_t n, uIOBuf &front ) {
+    if ( &front == this ) uAbort( "uIOBuf::split : cannot split chain into itself" );
+    while ( n > 0 && head != NULL ) {
+	if ( head->len <= n ) {				// whole segment moves
+	    n -= head->len;
+	    front.link( unlink() );
+	} else {					// segment straddles split point, share its block
+	    head->block->acquire();
+	    front.link( segment( head->block, head->data, n ) );
+	    head->data += n;
+	    head->len -= n;
+	    length -= n;
+	    n = 0;
+	} // if
+    } // while
+} // uIOBuf::split
+
+
+void uIOBuf::trim( size_t n ) {
+    while ( n > 0 && head != NULL ) {
+	if ( head->len <= n ) {
+	    n -= head->len;
+	    release( unlink() );
+	} else {
+	    head->data += n;
+	    head->len -= n;
+	    length -= n;
+	    n = 0;
+	} // if
+    } // while
+} // uIOBuf::trim
+
+
+void uIOBuf::clear() {
+    while ( head != NULL ) {
+	release( unlink() );
+    } // while
+} // uIOBuf::clear
+
+
+const char *uIOBuf::coalesce() {
+  if ( nsegs <= 1 ) return head != NULL ? head->data : NULL;
+
+    Block *b = Block::alloc( length > BlockSize ? length : (size_t)BlockSize );
+    size_t len = copyout( b->base, length );
+    clear();
+    link( segment( b, b->base, len ) );
+    return b->base;
+} // uIOBuf::coalesce
+
+
+size_t uIOBuf::copyout( char *buf, size_t len, size_t off ) const {
+    size_t count = 0;
+
+    for ( Segment *s = head; s != NULL && count < len; s = s->next ) {
+	if ( off >= s->len ) {				// skip segments before offset
+	    off -= s->len;
+	    continue;
+	} // if
+	size_t n = s->len - off;
+	if ( n > len - count ) n = len - count;
+	memcpy( buf + count, s->data + off, n );
+	count += n;
+	off = 0;
+    } // for
+    return count;
+} // uIOBuf::copyout
+
+
+unsigned int uIOBuf::iovecs( struct iovec *iov, unsigned int max, size_t off ) const {
+    unsigned int cnt = 0;
+
+    for ( Segment *s = head; s != NULL && cnt < max; s = s->next ) {
+	if ( off >= s->len ) {
+	    off -= s->len;
+	    continue;
+	} // if
+	iov[cnt].iov_base = s->data + off;
+	iov[cnt].iov_len = s->len - off;
+	cnt += 1;
+	off = 0;
+    } // for
+    return cnt;
+} // uIOBuf::iovecs
+
+
+// Room is described in order: spare room in the tail block (if unshared), then blocks held on the spare list, which are
+// only linked into the chain when commit finds data in them. Hence, an operation that fails between reserve and commit
+// leaves the chain unchanged, and unused blocks are kept for the next reservation.
+
+unsigned int uIOBuf::reserve( size_t len, struct iovec *iov, unsigned int max ) {
+    unsigned int cnt = 0;
+    size_t count = 0;
+
+  if ( max == 0 ) return 0;
+    size_t avail = room();
+    rsvRoom = avail != 0 && len != 0;
+    if ( rsvRoom ) {
+	iov[cnt].iov_base = tail->data + tail->len;
+	iov[cnt].iov_len = avail < len ? avail : len;
+	count += iov[cnt].iov_len;
+	cnt += 1;
+    } // if
+
+    Segment **next = &spare;
+    for ( ; count < len && cnt < max; cnt += 1 ) {
+	if ( *next == NULL ) {				// extend spare list
+	    Block *b = Block::alloc( BlockSize );
+	    *next = segment( b, b->base, 0 );
+	} // if
+	Segment *s = *next;
+	iov[cnt].iov_base = s->data;
+	iov[cnt].iov_len = len - count < s->block->capacity ? len - count : s->block->capacity;
+	count += iov[cnt].iov_len;
+	next = &s->next;
+    } // for
+    return cnt;
+} // uIOBuf::reserve
+
+
+void uIOBuf::commit( size_t len ) {
+    if ( rsvRoom && len > 0 ) {				// fill tail room first
+	size_t n = room();
+	if ( n > len ) n = len;
+	tail->len += n;
+	length += n;
+	len -= n;
+    } // if
+    rsvRoom = false;
+    while ( len > 0 && spare != NULL ) {		// move filled spare blocks into chain
+	Segment *s = spare;
+	spare = s->next;
+	s->len = len < s->block->capacity ? len : s->block->capacity;
+	len -= s->len;
+	link( s );
+    } // while
+    if ( len != 0 ) uAbort( "uIOBuf::commit : committing %zu bytes more than reserved", len );
+} // uIOBuf::commit
+
+
+void uIOBuf::pool( unsigned int max ) {
+    Block *list = NULL;
+
+    poolLock.acquire();
+    poolMax = max;
+    while ( poolCnt > poolMax ) {			// trim excess free blocks
+	Block *b = poolBlocks;
+	poolBlocks = b->next;
+	poolCnt -= 1;
+	b->next = list;
+	list = b;
+    } // while
+    poolLock.release();
+
+    while ( list != NULL ) {				// free outside the lock
+	Block *b = list;
+	list = b->next;
+	free( b );
+    } // while
+} // uIOBuf::pool
+
+
+// Local Variables: //
+// compile-command: "make install" //
+// End: //
@@ -0,0 +1,130 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// uIOBuf.h -- Reference-counted buffer chains for scatter-gather I/O.
+//
+// Author           : agent
+// Created On       : Mon Oct 19 01:30:06 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 02:36:43 2026
+// Update Count     : 2
+//
+// This  library is free  software; you  can redistribute  it and/or  modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software  Foundation; either  version 2.1 of  the License, or  (at your
+// option) any later version.
+//
+// This library is distributed in the  hope that it will be useful, but WITHOUT
+// ANY  WARRANTY;  without even  the  implied  warranty  of MERCHANTABILITY  or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+//
+// You should  have received a  copy of the  GNU Lesser General  Public License
+// along  with this library.
+//
+
+
+#ifndef __U_IOBUF_H__
+#define __U_IOBUF_H__
+
+
+#pragma __U_NOT_USER_CODE__
+
+
+#include <cstddef>					// size_t
+#include <sys/uio.h>					// iovec
+
+
+// A uIOBuf is a chain of segments, each referring to a range of a reference-counted block. Copying a chain, splitting
+// it, or appending one chain to another shares blocks rather than copying data, so a protocol message can be built
+// from a header and a payload without memcpy, and sent with one writev (see uFileIO::write and uSocketIO::send). Data
+// is only copied when appended from a plain buffer or when coalesced into one contiguous segment. Blocks of the
+// default size are recycled through a pool, so receiving into a chain does not call the allocator in the steady state.
+//
+// A block is modified in place (append/prepend into spare room) only when one segment refers to it and it is not
+// attached user storage, which is read only. A chain is not a monitor: a chain is used by one task at a time, but
+// blocks may be shared among chains of different tasks.
+
+class uIOBuf {
+  public:
+    enum { BlockSize = 16 * 1024 - 64 };		// default block size, pooled
+    enum { MaxIOV = 64 };				// segments per readv/writev system call
+
+    class Block {					// reference-counted storage
+	friend class uIOBuf;
+
+	volatile int refs;
+	size_t capacity;
+	char *base;					// storage
+	bool userStorage;				// user storage attached without copying, never pooled
+	void (*release)( void * );			// user storage release, NULL => caller keeps ownership
+	void *arg;
+	Block *next;					// pool link
+
+	static Block *alloc( size_t size );
+	static Block *external( char *data, size_t len, void (*release)( void * ), void *arg );
+	void acquire();
+	void unacquire();
+    }; // uIOBuf::Block
+  private:
+    struct Segment {
+	Block *block;
+	char *data;					// start of data in block
+	size_t len;					// length of data
+	Segment *next;
+    }; // uIOBuf::Segment
+
+    Segment *head, *tail;
+    size_t length;					// total bytes in chain
+    unsigned int nsegs;
+    Segment *spare;					// reserved blocks not yet holding data
+    bool rsvRoom;					// reservation starts with spare room in tail block
+
+    static Segment *segment( Block *block, char *data, size_t len );
+    static void release( Segment *s );
+    size_t room() const;				// spare room after tail segment
+    void link( Segment *s );			// add segment at end
+    Segment *unlink();					// remove first segment
+    void copy( const uIOBuf &other );
+  public:
+    uIOBuf();
+    uIOBuf( const uIOBuf &other );			// shares blocks with other
+    uIOBuf &operator=( const uIOBuf &other );
+    ~uIOBuf();
+
+    size_t size() const { return length; }
+    unsigned int segments() const { return nsegs; }
+    bool empty() const { return length == 0; }
+
+    void append( const char *data, size_t len );	// copy into spare room of last block, or new blocks
+    void append( uIOBuf &chain );			// move chain's segments to end, chain becomes empty
+    void attach( char *data, size_t len, void (*release)( void * ) = NULL, void *arg = NULL ); // append user storage without copying
+    void prepend( const char *data, size_t len );	// copy into room before first segment, or new block
+    void prepend( uIOBuf &chain );			// move chain's segments to front, chain becomes empty
+
+    void split( size_t n, uIOBuf &front );		// move first n bytes to end of front, sharing a straddling block
+    void trim( size_t n );				// discard first n bytes
+    void clear();
+    const char *coalesce();				// make contiguous (copying if multiple segments), return data
+
+    size_t copyout( char *buf, size_t len, size_t off = 0 ) const; // copy bytes [off, off + len) to buf
+    unsigned int iovecs( struct iovec *iov, unsigned int max, size_t off = 0 ) const; // describe data from off
+
+    // Receive support: describe up to len bytes of writable room at the end of the chain (limited by max vector entries,
+    // using pooled blocks as needed), then commit the bytes actually transferred.
+    unsigned int reserve( size_t len, struct iovec *iov, unsigned int max );
+    void commit( size_t len );
+
+    static void pool( unsigned int max );		// maximum number of free blocks retained, 0 => no pooling
+}; // uIOBuf
+
+
+#pragma __U_USER_CODE__
+
+#endif // __U_IOBUF_H__
+
+
+// Local Variables: //
+// compile-command: "make install" //
+// End: //
@@ -0,0 +1,580 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// uIOuring.cc --
+//
+// Author           : agent
+// Created On       : Mon Oct 19 01:26:00 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 02:36:31 2026
+// Update Count     : 2
+//
+// This  library is free  software; you  can redistribute  it and/or  modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software  Foundation; either  version 2.1 of  the License, or  (at your
+// option) any later version.
+//
+// This library is distributed in the  hope that it will be useful, but WITHOUT
+// ANY  WARRANTY;  without even  the  implied  warranty  of MERCHANTABILITY  or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+//
+// You should  have received a  copy of the  GNU Lesser General  Public License
+// along  with this library.
+//
+
+
+#define __U_KERNEL__
+#include <uC++.h>
+#include <uIOcntl.h>
+#include <uIOuring.h>
+//#include <uDebug.h>
+
+#include <cerrno>
+#include <cstdlib>					// calloc, free
+#include <cstring>					// memset
+#include <endian.h>					// __BYTE_ORDER
+#include <poll.h>					// POLLIN
+#include <stdint.h>					// uint64_t
+#include <unistd.h>					// read, write, close, syscall
+#include <sys/mman.h>					// mmap, munmap
+#include <sys/syscall.h>				// __NR_io_uring_*
+
+// The io_uring system calls are invoked directly so there is no dependence on liburing.
+
+#if defined( __linux__ ) && defined( __NR_io_uring_setup ) && defined( __has_include )
+#if __has_include( <linux/io_uring.h> )
+#include <linux/io_uring.h>
+#if defined( IO_URING_OP_SUPPORTED )			// opcode probing, kernel headers >= 5.6
+#define __U_IOURING__
+#include <sys/eventfd.h>
+#endif
+#endif
+#endif
+
+
+//######################### uIOuringReaper #########################
+
+
+// Drain the completion queue whenever the kernel signals the eventfd registered with the ring. The reaper blocks in
+// the uNBIO poller like any other task waiting for I/O, so completions are noticed without a dedicated kernel thread.
+
+_Task uIOuringReaper {
+    uIOuring &ring;
+
+    void main() {
+	uIOaccess access;
+	uint64_t cnt;
+	int rlen;
+
+	access.fd = ring.efd;
+	access.poll.setStatus( uPoll::AlwaysPoll );	// created non-blocking
+
+	struct Drain : public uIOClosure {
+	    uint64_t &cnt;
+
+	    int action() { return ::read( access.fd, &cnt, sizeof(cnt) ); }
+	    Drain( uIOaccess &access, int &rlen, uint64_t &cnt ) : uIOClosure( access, rlen ), cnt( cnt ) {}
+	} drainClosure( access, rlen, cnt );
+
+	for ( ;; ) {
+	    ring.reap();
+	  if ( ring.shutdown ) break;
+	    drainClosure.wrapper();			// reset notification count
+	    if ( rlen == -1 && drainClosure.errno_ == U_EWOULDBLOCK ) {
+		drainClosure.select( uCluster::ReadSelect, NULL ); // block until more completions are posted
+	    } // if
+	} // for
+    } // uIOuringReaper::main
+  public:
+    uIOuringReaper( uIOuring &ring ) : ring( ring ) {}
+}; // uIOuringReaper
+
+
+//######################### uIOuring #########################
+
+
+void uIOuring::Request::complete( int res, unsigned int ) {
+    Request::res = res;
+    done.V();						// restart waiting task
+} // uIOuring::Request::complete
+
+
+uIOuring::Listen::Listen( int fd ) : next( NULL ), fd( fd ), armed( false ), closing( false ), error( 0 ), head( 0 ), cnt( 0 ), size( 16 ),
+	waiting( 0 ), avail( 0 ), stopped( 0 ) {
+    ready = new int[size];
+} // uIOuring::Listen::Listen
+
+
+uIOuring::Listen::~Listen() {
+    for ( ; cnt > 0; cnt -= 1, head = ( head + 1 ) % size ) {
+	::close( ready[head] );				// accepted but never taken
+    } // for
+    delete [] ready;
+} // uIOuring::Listen::~Listen
+
+
+// Each accepted connection posts a completion; the multishot accept remains armed while the completion has
+// IORING_CQE_F_MORE set. When the kernel stops the multishot accept, every blocked acceptor is woken, and those finding
+// no descriptor rearm it (see accept); otherwise acceptors blocked before the stop would wait forever.
+
+void uIOuring::Listen::complete( int res, unsigned int flags ) {
+    int wake = 1;
+    bool terminated, stop;
+
+    lock.acquire();
+#ifdef IORING_CQE_F_MORE
+    terminated = ! ( flags & IORING_CQE_F_MORE );
+#else
+    terminated = true;
+#endif // IORING_CQE_F_MORE
+    if ( terminated ) armed = false;		// rearm on next accept
+    stop = terminated && closing;
+    if ( res >= 0 ) {
+	if ( cnt == size ) {				// full ? => double
+	    int *temp = new int[size * 2];
+	    for ( unsigned int i = 0; i < cnt; i += 1 ) temp[i] = ready[( head + i ) % size];
+	    delete [] ready;
+	    ready = temp;
+	    head = 0;
+	    size *= 2;
+	} // if
+	ready[( head + cnt ) % size] = res;
+	cnt += 1;
+    } else if ( res != -ECANCELED ) {			// cancellation by close is not reported
+	error = -res;
+    } else {
+	wake = 0;
+    } // if
+    if ( terminated && ! closing && (int)waiting > wake ) wake = waiting; // blocked acceptors must rearm
+    lock.release();
+    if ( wake > 0 ) avail.V( wake );
+    if ( stop ) stopped.V();				// restart closing task
+} // uIOuring::Listen::complete
+
+
+uIOuring::uIOuring( unsigned int entries ) : ringfd( -1 ), efd( -1 ), entries( 0 ), ready( false ), multishot( false ), fixedops( false ),
+	multishotAccepted( false ), shutdown( false ), sqRing( NULL ), cqRing( NULL ), sqes( NULL ), sqWaiting( 0 ), sqSpace( 0 ), cqWaiting( 0 ), cqSpace( 0 ),
+	listens( NULL ), fixed( NULL ), nfixed( 0 ), reaper( NULL ) {
+    ready = setup( entries );
+    if ( ready ) {
+	reaper = new uIOuringReaper( *this );
+    } else {
+	teardown();					// partial setup
+    } // if
+} // uIOuring::uIOuring
+
+
+uIOuring::~uIOuring() {
+    while ( listens != NULL ) close( listens->fd );	// requires reaper for cancellation
+    if ( reaper != NULL ) {
+	shutdown = true;
+	uint64_t one = 1;
+	if ( ::write( efd, &one, sizeof(one) ) == -1 ) {
+	    uAbort( "(uIOuring &)%p.~uIOuring : internal error, unable to wake reaper, error(%d) %s.", this, errno, strerror( errno ) );
+	} // if
+	delete reaper;					// wait for reaper to terminate
+    } // if
+    teardown();
+    delete [] fixed;
+} // uIOuring::~uIOuring
+
+
+#ifdef __U_IOURING__
+
+static bool supported( const io_uring_probe *probe, int op ) {
+    return op <= probe->last_op && ( probe->ops[op].flags & IO_URING_OP_SUPPORTED );
+} // supported
+
+#endif // __U_IOURING__
+
+
+bool uIOuring::setup( unsigned int entries ) {
+#ifdef __U_IOURING__
+    io_uring_params p;
+    memset( &p, 0, sizeof(p) );
+    ringfd = syscall( __NR_io_uring_setup, entries, &p );
+  if ( ringfd == -1 ) return false;			// ENOSYS, EPERM (seccomp, io_uring_disabled), ENOMEM
+
+    // Only operations needed by the socket layer are required; anything missing means an old kernel, so fall back.
+
+    size_t psize = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+    io_uring_probe *probe = (io_uring_probe *)calloc( 1, psize );
+    bool usable = syscall( __NR_io_uring_register, ringfd, IORING_REGISTER_PROBE, probe, 256 ) == 0 &&
+	supported( probe, IORING_OP_RECV ) && supported( probe, IORING_OP_SEND ) && supported( probe, IORING_OP_ACCEPT ) &&
+	supported( probe, IORING_OP_LINK_TIMEOUT ) && supported( probe, IORING_OP_ASYNC_CANCEL );
+    fixedops = usable && supported( probe, IORING_OP_READ_FIXED ) && supported( probe, IORING_OP_WRITE_FIXED ) &&
+	supported( probe, IORING_OP_POLL_ADD );
+    free( probe );
+  if ( ! usable ) return false;
+
+#ifdef IORING_ACCEPT_MULTISHOT
+    multishot = true;					// until the kernel rejects it (see accept)
+#endif // IORING_ACCEPT_MULTISHOT
+
+    uIOuring::entries = p.sq_entries;
+    sqRingSize = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+    cqRingSize = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    if ( p.features & IORING_FEAT_SINGLE_MMAP ) {	// one mapping for both rings
+	if ( cqRingSize > sqRingSize ) sqRingSize = cqRingSize;
+	cqRingSize = sqRingSize;
+    } // if
+
+    sqRing = mmap( NULL, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringfd, IORING_OFF_SQ_RING );
+  if ( sqRing == MAP_FAILED ) { sqRing = NULL; return false; }
+    if ( p.features & IORING_FEAT_SINGLE_MMAP ) {
+	cqRing = sqRing;
+    } else {
+	cqRing = mmap( NULL, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringfd, IORING_OFF_CQ_RING );
+      if ( cqRing == MAP_FAILED ) { cqRing = NULL; return false; }
+    } // if
+    sqesSize = p.sq_entries * sizeof(io_uring_sqe);
+    sqes = mmap( NULL, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringfd, IORING_OFF_SQES );
+  if ( sqes == MAP_FAILED ) { sqes = NULL; return false; }
+
+    sqHead = (unsigned int *)( (char *)sqRing + p.sq_off.head );
+    sqTail = (unsigned int *)( (char *)sqRing + p.sq_off.tail );
+    sqMask = (unsigned int *)( (char *)sqRing + p.sq_off.ring_mask );
+    sqArray = (unsigned int *)( (char *)sqRing + p.sq_off.array );
+    cqHead = (unsigned int *)( (char *)cqRing + p.cq_off.head );
+    cqTail = (unsigned int *)( (char *)cqRing + p.cq_off.tail );
+    cqMask = (unsigned int *)( (char *)cqRing + p.cq_off.ring_mask );
+    cqes = (char *)cqRing + p.cq_off.cqes;
+
+    efd = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+  if ( efd == -1 ) return false;
+  if ( syscall( __NR_io_uring_register, ringfd, IORING_REGISTER_EVENTFD, &efd, 1 ) == -1 ) return false;
+    return true;
+#else
+    return false;
+#endif // __U_IOURING__
+} // uIOuring::setup
+
+
+void uIOuring::teardown() {
+    if ( sqes != NULL ) munmap( sqes, sqesSize );
+    if ( cqRing != NULL && cqRing != sqRing ) munmap( cqRing, cqRingSize );
+    if ( sqRing != NULL ) munmap( sqRing, sqRingSize );
+    sqes = sqRing = cqRing = NULL;
+    if ( efd != -1 ) ::close( efd );
+    if ( ringfd != -1 ) ::close( ringfd );
+    efd = ringfd = -1;
+} // uIOuring::teardown
+
+
+// Place an operation, optionally preceded by a linked poll that delays it until the descriptor is ready and followed
+// by a linked timeout that cancels it, into the submission queue and submit it. Another task's io_uring_enter may
+// submit these entries, so the linked timespec resides in the request, which lives until completion, and this task
+// submits everything pending in case its entries are behind other tasks' entries.
+
+void uIOuring::queue( Request &req, int op, int fd, const void *addr, unsigned int len, unsigned long long off, int opflags, int ioprio, int bufIndex, uDuration *timeout, int pollFirst ) {
+#ifdef __U_IOURING__
+    unsigned int n = 1 + ( timeout != NULL ) + ( pollFirst != 0 ), tail;
+    int ret;
+
+    if ( timeout != NULL ) {
+	req.ts[0] = timeout->nanoseconds() / 1000000000LL; // layout of __kernel_timespec
+	req.ts[1] = timeout->nanoseconds() % 1000000000LL;
+    } // if
+
+    // The submission queue is full only while entries queued by other tasks await their io_uring_enter, and each of
+    // those tasks wakes the blocked producers after entering, when the kernel has consumed the entries.
+
+    for ( ;; ) {
+	sqLock.acquire();
+	tail = *sqTail;
+      if ( entries - ( tail - __atomic_load_n( sqHead, __ATOMIC_ACQUIRE ) ) >= n ) break;
+	sqWaiting += 1;
+	sqLock.release();
+	sqSpace.P();					// submission queue full, wait for other submitters to drain it
+    } // for
+
+    io_uring_sqe *sqe;
+    if ( pollFirst != 0 ) {				// operation runs when poll completes
+	sqe = &((io_uring_sqe *)sqes)[tail & *sqMask];
+	memset( sqe, 0, sizeof(*sqe) );
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = fd;
+#if __BYTE_ORDER == __BIG_ENDIAN			// poll32_events, halfwords swapped as for the 16-bit field
+	sqe->rw_flags = ( (unsigned int)pollFirst << 16 ) | ( (unsigned int)pollFirst >> 16 );
+#else
+	sqe->rw_flags = pollFirst;
+#endif // __BYTE_ORDER
+	sqe->flags |= IOSQE_IO_LINK;
+	sqe->user_data = 0;				// completion ignored
+	sqArray[tail & *sqMask] = tail & *sqMask;
+	tail += 1;
+    } // if
+    sqe = &((io_uring_sqe *)sqes)[tail & *sqMask];
+    memset( sqe, 0, sizeof(*sqe) );
+    sqe->opcode = op;
+    sqe->fd = fd;
+    sqe->addr = (unsigned long)addr;
+    sqe->len = len;
+    sqe->off = off;					// also addr2
+    sqe->rw_flags = opflags;				// also msg_flags, accept_flags
+    sqe->ioprio = ioprio;
+    sqe->buf_index = bufIndex;
+    sqe->user_data = (unsigned long)&req;
+    sqArray[tail & *sqMask] = tail & *sqMask;
+    if ( timeout != NULL ) {
+	sqe->flags |= IOSQE_IO_LINK;
+	tail += 1;
+	sqe = &((io_uring_sqe *)sqes)[tail & *sqMask];
+	memset( sqe, 0, sizeof(*sqe) );
+	sqe->opcode = IORING_OP_LINK_TIMEOUT;
+	sqe->fd = -1;
+	sqe->addr = (unsigned long)req.ts;
+	sqe->len = 1;
+	sqe->user_data = 0;				// completion ignored
+	sqArray[tail & *sqMask] = tail & *sqMask;
+    } // if
+    __atomic_store_n( sqTail, tail + 1, __ATOMIC_RELEASE );
+    sqLock.release();
+
+    for ( ;; ) {
+	ret = syscall( __NR_io_uring_enter, ringfd, entries, 0, 0, NULL, 0 );
+      if ( ret != -1 ) break;
+	if ( errno == EAGAIN || errno == EBUSY ) {	// kernel resources or completion queue full
+	    // Wait for the reaper to drain completions. A drain may precede the wait, and EAGAIN (kernel memory) is not
+	    // resolved by a drain, so the wait is bounded; a count left by a timed-out waiter only causes an early retry.
+	    cqLock.acquire();
+	    cqWaiting += 1;
+	    cqLock.release();
+	    cqSpace.P( uDuration( 0, 1000000 ) );	// 1 millisecond
+	} else if ( errno != EINTR ) {
+	    uAbort( "(uIOuring &)%p.queue : internal error, io_uring_enter failure, error(%d) %s.", this, errno, strerror( errno ) );
+	} // if
+    } // for
+
+    sqLock.acquire();					// entries consumed, restart blocked producers
+    unsigned int waiters = sqWaiting;
+    sqWaiting = 0;
+    sqLock.release();
+    if ( waiters > 0 ) sqSpace.V( waiters );
+#ifdef __U_STATISTICS__
+    uFetchAdd( UPP::Statistics::uring_submits, 1 );
+#endif // __U_STATISTICS__
+#endif // __U_IOURING__
+} // uIOuring::queue
+
+
+int uIOuring::perform( int op, int fd, const void *addr, unsigned int len, unsigned long long off, int opflags, int ioprio, int bufIndex, uDuration *timeout, int pollFirst ) {
+    Request req;
+
+    queue( req, op, fd, addr, len, off, opflags, ioprio, bufIndex, timeout, pollFirst );
+    req.done.P();					// wait for completion
+#ifdef __U_STATISTICS__
+    uFetchAdd( UPP::Statistics::uring_ops, 1 );
+#endif // __U_STATISTICS__
+    if ( timeout != NULL && req.res == -ECANCELED ) return -ETIME; // cancelled by linked timeout
+    return req.res;
+} // uIOuring::perform
+
+
+void uIOuring::reap() {
+#ifdef __U_IOURING__
+    unsigned int head = *cqHead, tail = __atomic_load_n( cqTail, __ATOMIC_ACQUIRE );
+
+    for ( ; head != tail; head += 1 ) {
+	io_uring_cqe *cqe = &((io_uring_cqe *)cqes)[head & *cqMask];
+	Request *req = (Request *)(unsigned long)cqe->user_data;
+	if ( req != NULL ) req->complete( cqe->res, cqe->flags );
+    } // for
+    __atomic_store_n( cqHead, head, __ATOMIC_RELEASE );
+
+    cqLock.acquire();					// completion queue drained, restart blocked submitters
+    unsigned int waiters = cqWaiting;
+    cqWaiting = 0;
+    cqLock.release();
+    if ( waiters > 0 ) cqSpace.V( waiters );
+#endif // __U_IOURING__
+} // uIOuring::reap
+
+
+bool uIOuring::registerBuffers( const struct iovec *iov, unsigned int n ) {
+#ifdef __U_IOURING__
+  if ( ! ready || ! fixedops ) return false;
+    if ( nfixed != 0 ) {				// only one registration at a time
+	syscall( __NR_io_uring_register, ringfd, IORING_UNREGISTER_BUFFERS, NULL, 0 );
+	delete [] fixed;
+	fixed = NULL;
+	nfixed = 0;
+    } // if
+  if ( syscall( __NR_io_uring_register, ringfd, IORING_REGISTER_BUFFERS, iov, n ) == -1 ) return false;
+    fixed = new struct iovec[n];
+    memcpy( fixed, iov, n * sizeof(struct iovec) );
+    nfixed = n;
+    return true;
+#else
+    return false;
+#endif // __U_IOURING__
+} // uIOuring::registerBuffers
+
+
+int uIOuring::fixedIndex( const void *buf, size_t len ) const {
+    for ( unsigned int i = 0; i < nfixed; i += 1 ) {
+	if ( (char *)buf >= (char *)fixed[i].iov_base && (char *)buf + len <= (char *)fixed[i].iov_base + fixed[i].iov_len ) return i;
+    } // for
+    return -1;
+} // uIOuring::fixedIndex
+
+
+int uIOuring::recv( int fd, void *buf, size_t len, int flags, uDuration *timeout ) {
+#ifdef __U_IOURING__
+    // A read on a non-blocking descriptor returns EWOULDBLOCK rather than waiting, so the read is linked behind a poll
+    // for input and runs once the socket is readable. A linked timeout covers only the read and not the poll, so a
+    // timed receive uses recv. If the poll fails (read cancelled) or another task takes the data first, fall back to
+    // recv, which waits in the kernel.
+    if ( flags == 0 && nfixed != 0 && timeout == NULL ) {
+	int i = fixedIndex( buf, len );
+	if ( i != -1 ) {
+	    int res = perform( IORING_OP_READ_FIXED, fd, buf, len, 0, 0, 0, i, NULL, POLLIN );
+	    if ( res != -EAGAIN && res != -ECANCELED ) return res;
+	} // if
+    } // if
+    return perform( IORING_OP_RECV, fd, buf, len, 0, flags, 0, 0, timeout );
+#else
+    return -EAGAIN;
+#endif // __U_IOURING__
+} // uIOuring::recv
+
+
+int uIOuring::send( int fd, const void *buf, size_t len, int flags, uDuration *timeout ) {
+#ifdef __U_IOURING__
+    if ( flags == 0 && nfixed != 0 ) {
+	int i = fixedIndex( buf, len );
+	if ( i != -1 ) {
+	    // A socket's send buffer is seldom full, so the write rarely returns EWOULDBLOCK; when it does, resubmit as
+	    // send, which waits in the kernel.
+	    int res = perform( IORING_OP_WRITE_FIXED, fd, buf, len, 0, 0, 0, i, timeout );
+	    if ( res != -EAGAIN ) return res;
+	} // if
+    } // if
+    return perform( IORING_OP_SEND, fd, buf, len, 0, flags | MSG_NOSIGNAL, 0, 0, timeout );
+#else
+    return -EAGAIN;
+#endif // __U_IOURING__
+} // uIOuring::send
+
+
+uIOuring::Listen *uIOuring::listen( int fd ) {
+    Listen *l;
+
+    listenLock.acquire();
+    for ( l = listens; l != NULL && l->fd != fd; l = l->next );
+    if ( l == NULL ) {
+	l = new Listen( fd );
+	l->next = listens;
+	listens = l;
+    } // if
+    listenLock.release();
+    return l;
+} // uIOuring::listen
+
+
+// Accepted descriptors are created non-blocking and, as with accept, not close-on-exec. With multishot accept, one
+// submission keeps accepting connections into a per-socket queue from which acceptors take descriptors without a system
+// call. A wakeup with neither a descriptor nor an error means the multishot accept stopped, so the acceptor rearms it
+// and waits again.
+// A kernel without multishot accept rejects the flag with EINVAL, but so does a socket that is not listening. Hence,
+// after an EINVAL before any multishot accept has succeeded, the accept is retried single shot, and multishot is
+// abandoned only if the single shot is not rejected too.
+
+int uIOuring::accept( int fd, struct sockaddr *adr, socklen_t *len, uDuration *timeout ) {
+#ifdef __U_IOURING__
+#ifdef IORING_ACCEPT_MULTISHOT
+    uTime deadline;
+    bool probing = false;				// multishot rejected, is it supported ?
+    if ( timeout != NULL ) deadline = uClock::now() + *timeout;
+    while ( multishot ) {
+	Listen *l = listen( fd );
+	int nfd;
+
+	l->lock.acquire();
+	bool arm = ! l->armed;
+	l->armed = true;
+	l->waiting += 1;
+	l->lock.release();
+	if ( arm ) queue( *l, IORING_OP_ACCEPT, fd, NULL, 0, 0, SOCK_NONBLOCK, IORING_ACCEPT_MULTISHOT, 0, NULL );
+
+	bool woken = true;
+	if ( timeout == NULL ) {
+	    l->avail.P();
+	} else {
+	    woken = l->avail.P( deadline );
+	} // if
+
+	l->lock.acquire();
+	l->waiting -= 1;
+	if ( ! woken ) {
+	    l->lock.release();
+	    return -ETIME;
+	} // if
+	if ( l->cnt > 0 ) {
+	    nfd = l->ready[l->head];
+	    l->head = ( l->head + 1 ) % l->size;
+	    l->cnt -= 1;
+	} else if ( l->error != 0 ) {
+	    nfd = -l->error;
+	    l->error = 0;
+	} else {
+	    l->lock.release();
+	    continue;					// multishot accept stopped => rearm
+	} // if
+	l->lock.release();
+
+	if ( nfd >= 0 ) multishotAccepted = true;
+	if ( nfd != -EINVAL || multishotAccepted ) {
+	    if ( nfd >= 0 && adr != NULL ) ::getpeername( nfd, adr, len ); // multishot does not return addresses
+	    return nfd;
+	} // if
+	probing = true;
+	break;
+    } // while
+    uDuration remaining;
+    if ( timeout != NULL ) {				// remaining time for single shot
+	remaining = deadline - uClock::now();
+      if ( remaining <= 0 ) return -ETIME;
+	timeout = &remaining;
+    } // if
+    int nfd = perform( IORING_OP_ACCEPT, fd, adr, 0, (unsigned long)len, SOCK_NONBLOCK, 0, 0, timeout );
+    if ( probing && nfd != -EINVAL ) multishot = false; // only the multishot flag was rejected
+    return nfd;
+#else
+    return perform( IORING_OP_ACCEPT, fd, adr, 0, (unsigned long)len, SOCK_NONBLOCK, 0, 0, timeout );
+#endif // IORING_ACCEPT_MULTISHOT
+#else
+    return -EAGAIN;
+#endif // __U_IOURING__
+} // uIOuring::accept
+
+
+void uIOuring::close( int fd ) {
+    Listen **prev, *l;
+
+    listenLock.acquire();
+    for ( prev = &listens, l = listens; l != NULL && l->fd != fd; prev = &l->next, l = l->next );
+    if ( l != NULL ) *prev = l->next;
+    listenLock.release();
+
+    if ( l != NULL ) {
+#ifdef __U_IOURING__
+	l->lock.acquire();
+	l->closing = true;				// terminating completion restarts this task
+	bool armed = l->armed;
+	l->lock.release();
+	if ( armed ) {					// stop multishot accept, which holds a reference to the socket
+	    perform( IORING_OP_ASYNC_CANCEL, -1, (Request *)l, 0, 0, 0, 0, 0, NULL ); // address is user_data of accept
+	    l->stopped.P();				// wait for terminating completion
+	} // if
+#endif // __U_IOURING__
+	delete l;
+    } // if
+} // uIOuring::close
+
+
+// Local Variables: //
+// compile-command: "make install" //
+// End: //
@@ -0,0 +1,131 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// uIOuring.h -- Completion-based socket I/O using the Linux io_uring interface.
+//
+// Author           : agent
+// Created On       : Mon Oct 19 01:26:00 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 02:36:31 2026
+// Update Count     : 2
+//
+// This  library is free  software; you  can redistribute  it and/or  modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software  Foundation; either  version 2.1 of  the License, or  (at your
+// option) any later version.
+//
+// This library is distributed in the  hope that it will be useful, but WITHOUT
+// ANY  WARRANTY;  without even  the  implied  warranty  of MERCHANTABILITY  or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+//
+// You should  have received a  copy of the  GNU Lesser General  Public License
+// along  with this library.
+//
+
+
+#ifndef __U_IOURING_H__
+#define __U_IOURING_H__
+
+
+#pragma __U_NOT_USER_CODE__
+
+
+#include <sys/socket.h>
+#include <sys/uio.h>					// iovec
+
+
+// An io_uring instance shared by the sockets attached to it (see uSocketIO::uring). A task issuing an operation
+// submits it to the kernel and blocks; a reaper task, woken through an eventfd by the uNBIO poller, drains the
+// completion queue and unblocks the tasks whose operations completed. Each operation costs one submission system call
+// and no EWOULDBLOCK/select/retry round trip. When the kernel does not provide io_uring (old kernel, seccomp, or
+// io_uring_disabled), available() is false and attached sockets use the normal non-blocking path.
+
+_Task uIOuringReaper;					// forward declaration
+
+class uIOuring {
+    friend _Task uIOuringReaper;			// access: reap, shutdown, efd
+
+    struct Request {					// one outstanding operation
+	int res;					// completion result, -errno on failure
+	long long int ts[2];				// linked timeout, layout of __kernel_timespec
+	UPP::uSemaphore done;				// waiting task blocks here until completion
+	Request() : done( 0 ) {}
+	virtual ~Request() {}
+	virtual void complete( int res, unsigned int flags );
+    }; // uIOuring::Request
+
+    struct Listen : public Request {			// multishot accept on a listening socket
+	Listen *next;
+	int fd;						// listening socket
+	bool armed;					// multishot accept outstanding in kernel
+	bool closing;					// close waits for the terminating completion
+	int error;					// terminating error, 0 => none
+	int *ready;					// accepted descriptors not yet taken
+	unsigned int head, cnt, size;
+	unsigned int waiting;				// acceptors blocked on avail
+	uSpinLock lock;
+	UPP::uSemaphore avail;				// descriptors in ready, or multishot stopped => rearm
+	UPP::uSemaphore stopped;			// closing task waits for the terminating completion
+	Listen( int fd );
+	~Listen();
+	void complete( int res, unsigned int flags );
+    }; // uIOuring::Listen
+
+    int ringfd, efd;					// ring and completion-notification eventfd
+    unsigned int entries;				// submission queue size
+    bool ready, multishot, fixedops;			// ring usable, multishot accept, fixed-buffer read/write
+    bool multishotAccepted;				// multishot accept has succeeded => EINVAL is not the flag
+    volatile bool shutdown;				// reaper must terminate
+    unsigned int *sqHead, *sqTail, *sqMask, *sqArray, *cqHead, *cqTail, *cqMask;
+    void *sqRing, *cqRing, *sqes, *cqes;
+    size_t sqRingSize, cqRingSize, sqesSize;
+    uSpinLock sqLock;					// serialize submission queue producers
+    unsigned int sqWaiting;				// producers blocked on a full submission queue, protected by sqLock
+    UPP::uSemaphore sqSpace;				// submission queue entries consumed by the kernel
+    uSpinLock cqLock;
+    unsigned int cqWaiting;				// submitters blocked on a full completion queue, protected by cqLock
+    UPP::uSemaphore cqSpace;				// completion queue drained by the reaper
+    uSpinLock listenLock;
+    Listen *listens;					// multishot accept state per listening socket
+    struct iovec *fixed;				// registered buffers
+    unsigned int nfixed;
+    uIOuringReaper *reaper;
+
+    bool setup( unsigned int entries );
+    void teardown();
+    void queue( Request &req, int op, int fd, const void *addr, unsigned int len, unsigned long long off, int opflags, int ioprio, int bufIndex, uDuration *timeout, int pollFirst = 0 );
+    int perform( int op, int fd, const void *addr, unsigned int len, unsigned long long off, int opflags, int ioprio, int bufIndex, uDuration *timeout, int pollFirst = 0 );
+    int fixedIndex( const void *buf, size_t len ) const;
+    Listen *listen( int fd );
+    void reap();
+  public:
+    uIOuring( unsigned int entries = 256 );
+    ~uIOuring();
+
+    bool available() const {				// false => kernel has no usable io_uring, callers fall back
+	return ready;
+    } // uIOuring::available
+
+    // Register buffers with the kernel so transfers into/out of them avoid pinning pages on each operation. send, and
+    // recv without a timeout, use a registered buffer automatically when the transfer lies entirely inside one.
+    bool registerBuffers( const struct iovec *iov, unsigned int n );
+
+    // Operations return the system-call result, or -errno on failure; -ETIME indicates timeout. -EAGAIN indicates the
+    // kernel returned the operation unperformed, and the caller should retry through the non-blocking path.
+    int recv( int fd, void *buf, size_t len, int flags, uDuration *timeout = NULL );
+    int send( int fd, const void *buf, size_t len, int flags, uDuration *timeout = NULL );
+    int accept( int fd, struct sockaddr *adr, socklen_t *len, uDuration *timeout = NULL );
+    void close( int fd );				// listening socket closing, discard multishot accept state
+}; // uIOuring
+
+
+#pragma __U_USER_CODE__
+
+#endif // __U_IOURING_H__
+
+
+// Local Variables: //
+// compile-command: "make install" //
+// End: //
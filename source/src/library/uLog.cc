@@ -0,0 +1,320 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// uLog.cc --
+//
+// Author           : agent
+// Created On       : Mon Oct 19 01:35:05 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 02:44:10 2026
+// Update Count     : 3
+//
+// This  library is free  software; you  can redistribute  it and/or  modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software  Foundation; either  version 2.1 of  the License, or  (at your
+// option) any later version.
+//
+// This library is distributed in the  hope that it will be useful, but WITHOUT
+// ANY  WARRANTY;  without even  the  implied  warranty  of MERCHANTABILITY  or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+//
+// You should  have received a  copy of the  GNU Lesser General  Public License
+// along  with this library.
+//
+
+
+#define __U_KERNEL__
+#include <uC++.h>
+#include <uLog.h>
+//#include <uDebug.h>
+
+#include <cstdio>					// snprintf
+#include <cstring>					// strchr, memcpy
+#include <fcntl.h>					// O_WRONLY, O_CREAT, O_APPEND
+
+
+//######################### uLogWriter #########################
+
+
+_Task uLogWriter {
+    uLog &log;
+
+    void main() {
+	for ( ;; ) {
+	    log.wakeup.P( log.period );			// woken by full ring, flush or shutdown, or period expires
+	    bool last = log.shutdown;			// records logged before shutdown are drained below
+	    log.flushLock.acquire();
+	    uLog::Flush *waiting = log.flushes;
+	    log.flushes = NULL;
+	    log.flushLock.release();
+
+	    log.drain();
+
+	    while ( waiting != NULL ) {			// restart flushing tasks
+		uLog::Flush *next = waiting->next;
+		waiting->done.V();
+		waiting = next;
+	    } // while
+	  if ( last ) break;
+	} // for
+    } // uLogWriter::main
+  public:
+    uLogWriter( uLog &log, uCluster &cluster ) : uBaseTask( cluster ), log( log ) {}
+}; // uLogWriter
+
+
+//######################### uLog #########################
+
+
+void uLog::init( unsigned int nrings, unsigned int ringSize ) {
+    if ( nrings == 0 ) nrings = 1;
+    unsigned long int size;
+    for ( size = 2; size < ringSize; size <<= 1 );	// round up to power of 2
+
+    uLog::nrings = nrings;
+    rings = new Ring[nrings];
+    for ( unsigned int i = 0; i < nrings; i += 1 ) {
+	Ring &r = rings[i];
+	r.slots = new Slot[size];
+	for ( unsigned long int s = 0; s < size; s += 1 ) {
+	    r.slots[s].seq = s;				// free for position s
+	} // for
+	r.mask = size - 1;
+	r.tail = r.head = 0;
+	r.signalled = false;
+    } // for
+    text = new char[TextSize];
+    textLen = 0;
+    writer = new uLogWriter( *this, cluster );
+} // uLog::init
+
+
+uLog::uLog( uFile &f, unsigned int ringSize, unsigned int nrings, uDuration period ) :
+	file( f, O_WRONLY | O_CREAT | O_APPEND ), period( period ), wakeup( 0 ), flushes( NULL ),
+	spaceWaiting( 0 ), space( 0 ), shutdown( false ), records( 0 ), stalls( 0 ), errors( 0 ),
+	cluster( "uLog" ), processor( cluster ) {
+    init( nrings, ringSize );
+} // uLog::uLog
+
+
+uLog::uLog( const char *name, unsigned int ringSize, unsigned int nrings, uDuration period ) :
+	file( name, O_WRONLY | O_CREAT | O_APPEND ), period( period ), wakeup( 0 ), flushes( NULL ),
+	spaceWaiting( 0 ), space( 0 ), shutdown( false ), records( 0 ), stalls( 0 ), errors( 0 ),
+	cluster( "uLog" ), processor( cluster ) {
+    init( nrings, ringSize );
+} // uLog::uLog
+
+
+uLog::~uLog() {
+    shutdown = true;
+    wakeup.V();
+    delete writer;					// writer drains remaining records before terminating
+
+    for ( unsigned int i = 0; i < nrings; i += 1 ) {
+	delete [] rings[i].slots;
+    } // for
+    delete [] rings;
+    delete [] text;
+} // uLog::~uLog
+
+
+uLog::Ring &uLog::ring() {				// processor's ring, a task may move between rings
+    return rings[uThisProcessor().getOrdinal() % nrings];
+} // uLog::ring
+
+
+void uLog::log( const char *fmt, Arg a0, Arg a1, Arg a2, Arg a3, Arg a4, Arg a5 ) {
+    long long int time = uClock::now().nanoseconds();
+
+    Ring &r = ring();
+    unsigned long int pos = r.tail;
+    Slot *s;
+    for ( ;; ) {					// reserve slot
+	s = &r.slots[pos & r.mask];
+	long int diff = (long int)( s->seq - pos );
+	if ( diff == 0 ) {				// slot free ?
+	  if ( uCompareAssign( r.tail, pos, pos + 1 ) ) break;
+	} else if ( diff < 0 ) {			// ring full, writer behind
+	    uFetchAdd( stalls, 1 );
+	    spaceLock.acquire();			// counted before waking the writer, so its next drain restarts this task
+	    spaceWaiting += 1;
+	    spaceLock.release();
+	    if ( ! r.signalled ) {
+		r.signalled = true;
+		wakeup.V();
+	    } // if
+	    space.P();					// wait for drain
+	} // if
+	pos = r.tail;					// another producer took the slot, or retry after drain
+    } // for
+
+    Record &rec = s->rec;
+    rec.time = time;
+    rec.fmt = fmt;
+    rec.args[0] = a0;
+    rec.args[1] = a1;
+    rec.args[2] = a2;
+    rec.args[3] = a3;
+    rec.args[4] = a4;
+    rec.args[5] = a5;
+    __sync_synchronize();				// record visible before publication
+    s->seq = pos + 1;
+
+    unsigned long int head = __atomic_load_n( &r.head, __ATOMIC_RELAXED );
+    if ( pos - head >= ( r.mask + 1 ) / 2 && ! r.signalled ) { // wake writer before the ring fills
+	r.signalled = true;
+	wakeup.V();
+    } // if
+} // uLog::log
+
+
+void uLog::flush() {
+    Flush f;
+
+    flushLock.acquire();
+    f.next = flushes;
+    flushes = &f;
+    flushLock.release();
+    wakeup.V();
+    f.done.P();
+} // uLog::flush
+
+
+// Format a record as one line. Each conversion is formatted separately with snprintf, using the flags, width and
+// precision from the format string and a length modifier matching the captured argument, so a conversion never reads
+// an argument of the wrong size. A conversion without an argument is copied unchanged.
+
+size_t uLog::format( char *buf, size_t size, const Record &r ) {
+    size_t limit = size - 1;				// room for newline
+    size_t len = snprintf( buf, limit, "%lld.%09lld ", r.time / 1000000000LL, r.time % 1000000000LL );
+    unsigned int arg = 0;
+    char spec[32];
+    int n;
+
+    for ( const char *f = r.fmt; *f != '\0' && len < limit; f += 1 ) {
+	if ( *f != '%' ) {
+	    buf[len] = *f;
+	    len += 1;
+	    continue;
+	} // if
+	if ( f[1] == '%' ) {
+	    buf[len] = '%';
+	    len += 1;
+	    f += 1;
+	    continue;
+	} // if
+
+	unsigned int sl = 0;
+	spec[sl++] = '%';
+	for ( f += 1; *f != '\0' && strchr( "-+ #0123456789.", *f ) != NULL && sl < sizeof(spec) - 4; f += 1 ) {
+	    spec[sl++] = *f;
+	} // for
+	while ( *f != '\0' && strchr( "hlLqjzt", *f ) != NULL ) f += 1; // replaced by captured type
+      if ( *f == '\0' ) break;
+
+	char conv = *f;
+	const Arg *a = arg < MaxArgs && r.args[arg].type != Arg::None ? &r.args[arg] : NULL;
+	arg += 1;
+	if ( a == NULL ) {				// missing argument
+	    spec[sl++] = conv;
+	    n = sl < limit - len ? sl : limit - len;
+	    memcpy( buf + len, spec, n );
+	    len += n;
+	    continue;
+	} // if
+
+	switch ( conv ) {
+	  case 'd': case 'i':
+	    spec[sl++] = 'l'; spec[sl++] = 'l'; spec[sl++] = conv; spec[sl] = '\0';
+	    n = snprintf( buf + len, limit - len + 1, spec, a->type == Arg::Double ? (long long int)a->d : a->i );
+	    break;
+	  case 'u': case 'o': case 'x': case 'X':
+	    spec[sl++] = 'l'; spec[sl++] = 'l'; spec[sl++] = conv; spec[sl] = '\0';
+	    n = snprintf( buf + len, limit - len + 1, spec, a->type == Arg::Double ? (unsigned long long int)a->d : (unsigned long long int)a->i );
+	    break;
+	  case 'c':
+	    spec[sl++] = conv; spec[sl] = '\0';
+	    n = snprintf( buf + len, limit - len + 1, spec, (int)a->i );
+	    break;
+	  case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+	    spec[sl++] = conv; spec[sl] = '\0';
+	    n = snprintf( buf + len, limit - len + 1, spec, a->type == Arg::Double ? a->d :
+			  a->type == Arg::Unsigned ? (double)(unsigned long long int)a->i : (double)a->i );
+	    break;
+	  case 's':
+	    spec[sl++] = conv; spec[sl] = '\0';
+	    n = snprintf( buf + len, limit - len + 1, spec, a->type != Arg::String ? "?" : a->p == NULL ? "(null)" : (const char *)a->p );
+	    break;
+	  case 'p':
+	    spec[sl++] = conv; spec[sl] = '\0';
+	    n = snprintf( buf + len, limit - len + 1, spec, a->type == Arg::Pointer || a->type == Arg::String ? a->p : (const void *)a->i );
+	    break;
+	  default:					// unknown conversion, copy
+	    spec[sl++] = conv;
+	    n = sl < limit - len ? sl : limit - len;
+	    memcpy( buf + len, spec, n );
+	    break;
+	} // switch
+	if ( n < 0 ) n = 0;
+	len += (size_t)n < limit - len ? n : limit - len; // truncated
+    } // for
+
+    if ( len > limit ) len = limit;
+    buf[len] = '\n';
+    return len + 1;
+} // uLog::format
+
+
+void uLog::write() {
+  if ( textLen == 0 ) return;
+    try {
+	file.write( text, textLen );
+    } catch( uFile::FileAccess::WriteFailure ) {
+	errors += 1;					// logging must not terminate the writer
+    } // try
+    textLen = 0;
+} // uLog::write
+
+
+// Consume the published records of all the rings in timestamp order, each step taking the earliest record at the head
+// of a ring, formatting them into the text buffer, which is written when full and at the end. A slot is released only
+// after its record is formatted. Then restart appends blocked on a full ring.
+
+void uLog::drain() {
+    for ( unsigned int i = 0; i < nrings; i += 1 ) {
+	rings[i].signalled = false;
+    } // for
+    for ( ;; ) {
+	Ring *next = NULL;
+	Slot *first = NULL;
+	for ( unsigned int i = 0; i < nrings; i += 1 ) { // earliest published record
+	    Ring &r = rings[i];
+	    Slot &s = r.slots[r.head & r.mask];
+	    if ( s.seq == r.head + 1 && ( first == NULL || s.rec.time < first->rec.time ) ) {
+		next = &r;
+		first = &s;
+	    } // if
+	} // for
+      if ( next == NULL ) break;			// nothing published
+	if ( TextSize - textLen < MaxLine ) write();
+	textLen += format( text + textLen, MaxLine, first->rec );
+	__sync_synchronize();				// record read before slot reused
+	first->seq = next->head + next->mask + 1;	// free for position head + size
+	__atomic_store_n( &next->head, next->head + 1, __ATOMIC_RELAXED );
+	records += 1;
+    } // for
+    write();
+
+    spaceLock.acquire();
+    unsigned int waiters = spaceWaiting;
+    spaceWaiting = 0;
+    spaceLock.release();
+    if ( waiters > 0 ) space.V( waiters );
+} // uLog::drain
+
+
+// Local Variables: //
+// compile-command: "make install" //
+// End: //
@@ -0,0 +1,157 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// uLog.h -- Asynchronous logging with deferred formatting and a background writer task.
+//
+// Author           : agent
+// Created On       : Mon Oct 19 01:35:05 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 01:35:05 2026
+// Update Count     : 1
+//
+// This  library is free  software; you  can redistribute  it and/or  modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software  Foundation; either  version 2.1 of  the License, or  (at your
+// option) any later version.
+//
+// This library is distributed in the  hope that it will be useful, but WITHOUT
+// ANY  WARRANTY;  without even  the  implied  warranty  of MERCHANTABILITY  or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+//
+// You should  have received a  copy of the  GNU Lesser General  Public License
+// along  with this library.
+//
+
+
+#ifndef __U_LOG_H__
+#define __U_LOG_H__
+
+
+#pragma __U_NOT_USER_CODE__
+
+
+#include <uFile.h>
+
+
+// A uLog appends fixed-size binary records (timestamp, format string, and up to MaxArgs arguments) to one of several
+// ring buffers, selected by the executing processor so tasks on different processors do not contend. Appending is a
+// slot reservation with compare-and-swap plus a few stores: no lock, no system call, and no formatting. A writer task,
+// running on its own cluster and processor, periodically drains the rings, formats the records printf-style, and writes
+// them to the file. Because regular-file writes block the processor (NeverPoll), only the writer's processor ever
+// blocks on the disk. An append to a full ring blocks until the writer has drained it.
+//
+// Each drain merges the rings by timestamp, so records appear in time order except that a record still being appended
+// when a drain reaches it, or logged after the drain, is written by a later drain, after records with later timestamps.
+//
+// The format string and any string arguments are saved by address, not copied, so they must remain valid until the
+// record is written, e.g., string literals. Each record becomes one line of output, prefixed with its timestamp.
+//
+//   uFile file( "server.log" );
+//   uLog log( file );
+//   log.log( "request %d from %s took %.3f ms", id, "client", ms );
+
+_Task uLogWriter;					// forward declaration
+
+class uLog {
+    friend _Task uLogWriter;				// access: drain, shutdown, wakeup, flushes
+  public:
+    enum { MaxArgs = 6 };
+
+    class Arg {						// argument captured by value, type remembered for formatting
+	friend class uLog;
+	enum Type { None, Int, Unsigned, Double, Pointer, String };
+	Type type;
+	union {
+	    long long int i;
+	    double d;
+	    const void *p;
+	};
+      public:
+	Arg() : type( None ) {}
+	Arg( char v ) : type( Int ), i( v ) {}
+	Arg( int v ) : type( Int ), i( v ) {}
+	Arg( long int v ) : type( Int ), i( v ) {}
+	Arg( long long int v ) : type( Int ), i( v ) {}
+	Arg( unsigned int v ) : type( Unsigned ), i( v ) {}
+	Arg( unsigned long int v ) : type( Unsigned ), i( v ) {}
+	Arg( unsigned long long int v ) : type( Unsigned ), i( v ) {}
+	Arg( double v ) : type( Double ), d( v ) {}
+	Arg( const char *v ) : type( String ), p( v ) {}
+	Arg( const void *v ) : type( Pointer ), p( v ) {}
+    }; // uLog::Arg
+  private:
+    enum { TextSize = 64 * 1024, MaxLine = 1024 };
+
+    struct Record {
+	long long int time;				// nanoseconds since the epoch
+	const char *fmt;
+	Arg args[MaxArgs];
+    }; // uLog::Record
+
+    struct Slot {
+	volatile unsigned long int seq;			// == position + 1 => record published
+	Record rec;
+    }; // uLog::Slot
+
+    struct Ring {					// multiple producers, single consumer (writer)
+	Slot *slots;
+	unsigned long int mask;
+	volatile unsigned long int tail;		// next position to reserve
+	volatile unsigned long int head;		// next position to consume, set by writer
+	volatile bool signalled;			// writer woken since last drain
+	char pad[64];					// keep rings on separate cache lines
+    }; // uLog::Ring
+
+    struct Flush {					// task waiting for records to be written
+	UPP::uSemaphore done;
+	Flush *next;
+	Flush() : done( 0 ) {}
+    }; // uLog::Flush
+
+    uFile::FileAccess file;
+    Ring *rings;
+    unsigned int nrings;
+    uDuration period;					// maximum time records wait before writing
+    UPP::uSemaphore wakeup;
+    uSpinLock flushLock;
+    Flush *flushes;
+    uSpinLock spaceLock;
+    unsigned int spaceWaiting;				// appends blocked on a full ring, protected by spaceLock
+    UPP::uSemaphore space;				// rings drained
+    volatile bool shutdown;
+    unsigned long long int records, stalls, errors;
+    char *text;						// formatted records awaiting write
+    size_t textLen;
+    uCluster cluster;					// writer runs separately from logging tasks
+    uProcessor processor;
+    uLogWriter *writer;
+
+    void init( unsigned int nrings, unsigned int ringSize );
+    Ring &ring();
+    size_t format( char *buf, size_t size, const Record &r );
+    void write();
+    void drain();
+  public:
+    uLog( uFile &f, unsigned int ringSize = 4096, unsigned int nrings = 8, uDuration period = uDuration( 0, 10000000 ) );
+    uLog( const char *name, unsigned int ringSize = 4096, unsigned int nrings = 8, uDuration period = uDuration( 0, 10000000 ) );
+    ~uLog();						// write remaining records
+
+    void log( const char *fmt, Arg a0 = Arg(), Arg a1 = Arg(), Arg a2 = Arg(), Arg a3 = Arg(), Arg a4 = Arg(), Arg a5 = Arg() );
+    void flush();					// wait until records logged before the call are written
+
+    unsigned long long int written() const { return records; } // records written
+    unsigned long long int waits() const { return stalls; } // appends that waited for a full ring
+    unsigned long long int failures() const { return errors; } // failed writes, records lost
+}; // uLog
+
+
+#pragma __U_USER_CODE__
+
+#endif // __U_LOG_H__
+
+
+// Local Variables: //
+// compile-command: "make install" //
+// End: //
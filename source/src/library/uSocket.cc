@@ -28,6 +28,7 @@
 #define __U_KERNEL__
 #include <uC++.h>
 #include <uSocket.h>
+#include <uIOBuf.h>
 
 //#include <uDebug.h>
 
@@ -36,6 +37,13 @@
 #include <unistd.h>					// read, write, close, etc.
 #if defined( __solaris__ ) || defined( __linux__ )
 #include <sys/sendfile.h>
+#if defined( __linux__ )
+#include <linux/errqueue.h>				// sock_extended_err, SO_EE_ORIGIN_ZEROCOPY
+#include <sys/epoll.h>					// epoll_create1, epoll_ctl, epoll_wait
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif // ! SO_ZEROCOPY
+#endif // __linux__
 #endif // __solaris__ || __linux__
 
 #ifndef SUN_LEN
@@ -43,6 +51,13 @@
 #endif
 
 
+// accept4 returns the connection already non-blocking, saving the fcntl calls in setPollFlag. Like accept, it leaves
+// close-on-exec clear, so a connection is inherited across exec unless the program sets FD_CLOEXEC.
+#if defined( __linux__ ) && defined( SOCK_NONBLOCK )
+#define __U_ACCEPT4__
+#endif
+
+
 //######################### uSocket #########################
 
 
@@ -180,9 +195,26 @@ void uSocket::CloseFailure::defaultTerminate() const {
 //######################### uSocketIO #########################
 
 
+uSocketIO::~uSocketIO() {
+#if defined( __linux__ ) && defined( MSG_ZEROCOPY )
+    if ( zcEpoll != -1 ) ::close( zcEpoll );
+#endif // __linux__ && MSG_ZEROCOPY
+} // uSocketIO::~uSocketIO
+
+
 int uSocketIO::send( char *buf, int len, int flags, uDuration *timeout ) {
     int slen;
 
+    if ( ring != NULL ) {				// completion-based path
+	slen = ring->send( access.fd, buf, len, flags, timeout );
+      if ( slen >= 0 ) return slen;
+	if ( slen == -ETIME ) writeTimeout( buf, len, flags, NULL, 0, timeout, "send" );
+	if ( slen != -EAGAIN ) writeFailure( -slen, buf, len, flags, NULL, 0, timeout, "send" );
+#ifdef __U_STATISTICS__
+	uFetchAdd( UPP::Statistics::uring_fallbacks, 1 );
+#endif // __U_STATISTICS__
+    } // if
+
     struct Send : public uIOClosure {
 	char *buf;
 	int len;
@@ -235,9 +267,63 @@ int uSocketIO::sendto( char *buf, int len, struct sockaddr *to, socklen_t tolen,
 } // uSocketIO::sendto
 
 
+int uSocketIO::sendmsg( const struct msghdr *msg, int flags, uDuration *timeout ) {
+    int slen;
+
+    struct Sendmsg : public uIOClosure {
+	const struct msghdr *msg;
+	int flags;
+
+	int action() { return ::sendmsg( access.fd, msg, flags ); }
+	Sendmsg( uIOaccess &access, int &slen, const struct msghdr *msg, int flags ) : uIOClosure( access, slen ), msg( msg ), flags( flags ) {}
+    } sendmsgClosure( access, slen, msg, flags );
+
+    sendmsgClosure.wrapper();
+    if ( slen == -1 && sendmsgClosure.errno_ == U_EWOULDBLOCK ) {
+	if ( ! sendmsgClosure.select( uCluster::WriteSelect, timeout ) ) {
+	    writeTimeout( (const char *)msg, 0, flags, NULL, 0, timeout, "sendmsg" );
+	} // if
+    } // if
+    if ( slen == -1 ) {
+	writeFailure( sendmsgClosure.errno_, (const char *)msg, 0, flags, NULL, 0, timeout, "sendmsg" );
+    } // if
+
+    return slen;
+} // uSocketIO::sendmsg
+
+
+// Send the whole chain, gathering up to uIOBuf::MaxIOV segments per sendmsg, and consume the bytes sent.
+
+int uSocketIO::send( uIOBuf &chain, int flags, uDuration *timeout ) {
+    struct iovec iov[uIOBuf::MaxIOV];
+    struct msghdr msg;
+    int count = 0;
+
+    memset( &msg, 0, sizeof(msg) );
+    msg.msg_iov = iov;
+    while ( ! chain.empty() ) {
+	msg.msg_iovlen = chain.iovecs( iov, uIOBuf::MaxIOV );
+	int slen = sendmsg( &msg, flags, timeout );
+	chain.trim( slen );
+	count += slen;
+    } // while
+    return count;
+} // uSocketIO::send
+
+
 int uSocketIO::recv( char *buf, int len, int flags, uDuration *timeout ) {
     int rlen;
 
+    if ( ring != NULL ) {				// completion-based path
+	rlen = ring->recv( access.fd, buf, len, flags, timeout );
+      if ( rlen >= 0 ) return rlen;
+	if ( rlen == -ETIME ) readTimeout( buf, len, flags, NULL, NULL, timeout, "recv" );
+	if ( rlen != -EAGAIN ) readFailure( -rlen, buf, len, flags, NULL, NULL, timeout, "recv" );
+#ifdef __U_STATISTICS__
+	uFetchAdd( UPP::Statistics::uring_fallbacks, 1 );
+#endif // __U_STATISTICS__
+    } // if
+
     struct Recv : public uIOClosure {
 	char *buf;
 	int len;
@@ -319,6 +405,79 @@ int uSocketIO::recvmsg( struct msghdr *msg, int flags, uDuration *timeout ) {
 } // uSocketIO::recvmsg
 
 
+// Receive up to len bytes into room at the end of the chain; returns the number of bytes received, 0 => end of file.
+
+int uSocketIO::recv( uIOBuf &chain, size_t len, int flags, uDuration *timeout ) {
+    struct iovec iov[uIOBuf::MaxIOV];
+    struct msghdr msg;
+
+    memset( &msg, 0, sizeof(msg) );
+    msg.msg_iov = iov;
+    msg.msg_iovlen = chain.reserve( len, iov, uIOBuf::MaxIOV );
+    int rlen = recvmsg( &msg, flags, timeout );		// raises on failure, chain unchanged
+    chain.commit( rlen );
+    return rlen;
+} // uSocketIO::recv
+
+
+#if defined( __linux__ )
+int uSocketIO::sendmmsg( struct mmsghdr *msgvec, unsigned int vlen, int flags, uDuration *timeout ) {
+    int cnt;
+
+    struct Sendmmsg : public uIOClosure {
+	struct mmsghdr *msgvec;
+	unsigned int vlen;
+	int flags;
+
+	int action() { return ::sendmmsg( access.fd, msgvec, vlen, flags ); }
+	Sendmmsg( uIOaccess &access, int &cnt, struct mmsghdr *msgvec, unsigned int vlen, int flags ) :
+	    uIOClosure( access, cnt ), msgvec( msgvec ), vlen( vlen ), flags( flags ) {}
+    } sendmmsgClosure( access, cnt, msgvec, vlen, flags );
+
+    sendmmsgClosure.wrapper();
+    if ( cnt == -1 && sendmmsgClosure.errno_ == U_EWOULDBLOCK ) {
+	if ( ! sendmmsgClosure.select( uCluster::WriteSelect, timeout ) ) {
+	    writeTimeout( (const char *)msgvec, vlen, flags, NULL, 0, timeout, "sendmmsg" );
+	} // if
+    } // if
+    if ( cnt == -1 ) {
+	writeFailure( sendmmsgClosure.errno_, (const char *)msgvec, vlen, flags, NULL, 0, timeout, "sendmmsg" );
+    } // if
+
+    return cnt;
+} // uSocketIO::sendmmsg
+
+
+int uSocketIO::recvmmsg( struct mmsghdr *msgvec, unsigned int vlen, int flags, uDuration *timeout ) {
+    int cnt;
+
+    struct Recvmmsg : public uIOClosure {
+	struct mmsghdr *msgvec;
+	unsigned int vlen;
+	int flags;
+
+	// The socket is non-blocking, so the kernel returns whatever datagrams are queued (up to vlen) rather than waiting
+	// for vlen; an empty queue gives EWOULDBLOCK, which is handled by select below.
+	int action() { return ::recvmmsg( access.fd, msgvec, vlen, flags, NULL ); }
+	Recvmmsg( uIOaccess &access, int &cnt, struct mmsghdr *msgvec, unsigned int vlen, int flags ) :
+	    uIOClosure( access, cnt ), msgvec( msgvec ), vlen( vlen ), flags( flags ) {}
+    } recvmmsgClosure( access, cnt, msgvec, vlen, flags );
+
+    recvmmsgClosure.wrapper();
+    if ( cnt == -1 && recvmmsgClosure.errno_ == U_EWOULDBLOCK ) {
+	if ( ! recvmmsgClosure.select( uCluster::ReadSelect, timeout ) ) {
+	    readTimeout( (const char *)msgvec, vlen, flags, NULL, NULL, timeout, "recvmmsg" );
+	} // if
+    } // if
+    if ( cnt == -1 ) {
+	readFailure( recvmmsgClosure.errno_, (const char *)msgvec, vlen, flags, NULL, NULL, timeout, "recvmmsg" );
+    } // if
+
+    return cnt;
+} // uSocketIO::recvmmsg
+#endif // __linux__
+
+
 ssize_t uSocketIO::sendfile( uFile::FileAccess &file, off_t *off, size_t len, uDuration *timeout ) {
     int ret;
     off_t wlen;
@@ -401,6 +560,185 @@ ssize_t uSocketIO::sendfile( uFile::FileAccess &file, off_t *off, size_t len, uD
 } // uSocketIO::sendfile
 
 
+bool uSocketIO::uring( uIOuring &r ) {
+    ring = r.available() ? &r : NULL;			// unavailable => non-blocking path
+    return ring != NULL;
+} // uSocketIO::uring
+
+
+#if defined( __linux__ )
+int uSocketIO::spliceTo( uPipe::End &out, size_t len, unsigned int flags, uDuration *timeout ) {
+    int terrno;
+    bool timedout, input;
+
+    int ret = transfer( *this, out, len, flags, false, timeout, terrno, timedout, input );
+    if ( ret == -1 ) {
+	if ( timedout ) {
+	    if ( input ) readTimeout( NULL, len, flags, NULL, NULL, timeout, "splice" );
+	    else writeTimeout( NULL, len, flags, NULL, 0, timeout, "splice" );
+	} // if
+	if ( input ) readFailure( terrno, NULL, len, flags, NULL, NULL, timeout, "splice" );
+	else writeFailure( terrno, NULL, len, flags, NULL, 0, timeout, "splice" );
+    } // if
+    return ret;
+} // uSocketIO::spliceTo
+
+
+int uSocketIO::spliceFrom( uPipe::End &in, size_t len, unsigned int flags, uDuration *timeout ) {
+    int terrno;
+    bool timedout, input;
+
+    int ret = transfer( in, *this, len, flags, false, timeout, terrno, timedout, input );
+    if ( ret == -1 ) {
+	if ( timedout ) {
+	    if ( input ) readTimeout( NULL, len, flags, NULL, NULL, timeout, "splice" );
+	    else writeTimeout( NULL, len, flags, NULL, 0, timeout, "splice" );
+	} // if
+	if ( input ) readFailure( terrno, NULL, len, flags, NULL, NULL, timeout, "splice" );
+	else writeFailure( terrno, NULL, len, flags, NULL, 0, timeout, "splice" );
+    } // if
+    return ret;
+} // uSocketIO::spliceFrom
+#endif // __linux__
+
+
+#if defined( __linux__ ) && defined( MSG_ZEROCOPY )
+// A completion notification queued on the socket error queue raises EPOLLERR, which epoll always reports, so an
+// edge-triggered epoll instance registered for no events becomes readable exactly when a notification arrives, and the
+// poller can wait for notifications separately from ordinary input on the socket.
+
+bool uSocketIO::zerocopy() {
+  if ( zcEnabled ) return true;
+    const int enable = 1;				// 1 => enable option
+  if ( setsockopt( access.fd, SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable) ) == -1 ) return false;
+    zcEpoll = ::epoll_create1( 0 );
+  if ( zcEpoll == -1 ) return false;
+    struct epoll_event event;
+    event.events = EPOLLET;				// EPOLLERR only, once per notification
+    event.data.u64 = 0;
+    if ( ::epoll_ctl( zcEpoll, EPOLL_CTL_ADD, access.fd, &event ) == -1 ) {
+	::close( zcEpoll );
+	zcEpoll = -1;
+	return false;
+    } // if
+    zcEnabled = true;
+    return true;
+} // uSocketIO::zerocopy
+
+
+// Drain the completion notifications the kernel queues on the socket error queue. Each notification covers a range of
+// send ids [ee_info, ee_data], and indicates whether the kernel fell back to copying the data.
+
+void uSocketIO::zcreap() {
+    char control[128];
+
+    for ( ;; ) {
+	struct msghdr msg;
+	memset( &msg, 0, sizeof(msg) );
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(control);
+      if ( ::recvmsg( access.fd, &msg, MSG_ERRQUEUE ) == -1 ) break; // EWOULDBLOCK => no notifications
+	for ( struct cmsghdr *cm = CMSG_FIRSTHDR( &msg ); cm != NULL; cm = CMSG_NXTHDR( &msg, cm ) ) {
+	    struct sock_extended_err *serr = (struct sock_extended_err *)CMSG_DATA( cm );
+	    if ( serr->ee_errno == 0 && serr->ee_origin == SO_EE_ORIGIN_ZEROCOPY ) {
+		zcLock.acquire();			// tasks may reap concurrently
+		if ( serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED ) zcCopied += serr->ee_data - serr->ee_info + 1;
+		if ( (int)(serr->ee_data + 1 - zcDone) > 0 ) zcDone = serr->ee_data + 1; // modulo arithmetic
+		zcLock.release();
+	    } // if
+	} // for
+    } // for
+} // uSocketIO::zcreap
+
+
+int uSocketIO::sendzc( const char *buf, int len, unsigned int *id, int flags, uDuration *timeout ) {
+    if ( ! zcEnabled || len == 0 ) {			// copying send, kernel assigns no id
+	int slen = send( (char *)buf, len, flags, timeout ); // buffer reusable on return
+	if ( id != NULL ) *id = zcCompleted() - 1;	// an id already completed
+	return slen;
+    } // if
+
+    int slen;
+
+    struct Sendzc : public uIOClosure {
+	uSocketIO &socket;
+	const char *buf;
+	int len;
+	int flags;
+	unsigned int id;
+
+	int action() {
+	    socket.zcLock.acquire();			// kernel numbers successful sends in call order
+	    int slen = ::send( access.fd, buf, len, flags | MSG_ZEROCOPY );
+	    int terrno = errno;				// preserve errno across release
+	    if ( slen != -1 ) {
+		id = socket.zcSent;
+		socket.zcSent += 1;
+	    } // if
+	    socket.zcLock.release();
+	    errno = terrno;
+	    return slen;
+	} // action
+	Sendzc( uSocketIO &socket, int &slen, const char *buf, int len, int flags ) :
+	    uIOClosure( socket.access, slen ), socket( socket ), buf( buf ), len( len ), flags( flags ) {}
+    } sendClosure( *this, slen, buf, len, flags );
+
+    sendClosure.wrapper();
+    if ( slen == -1 && sendClosure.errno_ == U_EWOULDBLOCK ) {
+	if ( ! sendClosure.select( uCluster::WriteSelect, timeout ) ) {
+	    writeTimeout( buf, len, flags, NULL, 0, timeout, "sendzc" );
+	} // if
+    } // if
+    if ( slen == -1 ) {
+	writeFailure( sendClosure.errno_, buf, len, flags, NULL, 0, timeout, "sendzc" );
+    } // if
+
+    if ( id != NULL ) *id = sendClosure.id;
+    zcreap();						// harvest completions opportunistically
+    return slen;
+} // uSocketIO::sendzc
+
+
+void uSocketIO::zcwait( unsigned int id, uDuration *timeout ) {
+    int ret;
+    uIOaccess notify;					// error-queue readiness through the epoll instance
+    notify.fd = zcEpoll;
+    notify.poll.setStatus( uPoll::AlwaysPoll );
+
+    struct Completion : public uIOClosure {
+	int action() {					// consume the readiness edge, if any
+	    struct epoll_event event;
+	    int ret = ::epoll_wait( access.fd, &event, 1, 0 );
+	    if ( ret == 0 ) {
+		errno = U_EWOULDBLOCK;
+		return -1;
+	    } // if
+	    return ret;
+	} // action
+	Completion( uIOaccess &access, int &ret ) : uIOClosure( access, ret ) {}
+    } completionClosure( notify, ret );
+
+    uTime deadline;
+    if ( timeout != NULL ) deadline = uClock::now() + *timeout;
+    for ( ;; ) {
+	zcreap();
+      if ( (int)(zcCompleted() - id) > 0 ) break;	// send completed ? (modulo arithmetic)
+	completionClosure.wrapper();
+	if ( ret == -1 && completionClosure.errno_ == U_EWOULDBLOCK ) { // no notification since last reap ?
+	    uDuration remaining;
+	    if ( timeout != NULL ) {
+		remaining = deadline - uClock::now();
+		if ( remaining <= 0 ) writeTimeout( NULL, 0, 0, NULL, 0, timeout, "zcwait" );
+	    } // if
+	    if ( ! completionClosure.select( uCluster::ReadSelect, timeout != NULL ? &remaining : NULL ) ) {
+		writeTimeout( NULL, 0, 0, NULL, 0, timeout, "zcwait" );
+	    } // if
+	} // if
+    } // for
+} // uSocketIO::zcwait
+#endif // __linux__ && MSG_ZEROCOPY
+
+
 //######################### uSocketServer #########################
 
 
@@ -439,6 +777,9 @@ void uSocketServer::createSocketServer1( const char *name, int type, int protoco
     } // if
 
     acceptorCnt = 0;
+    listeners = NULL;
+    nlisteners = 1;
+    nextListener = 0;
 
 #ifdef __U_DEBUG_H__
     uDebugPrt( "(uSocketServer &)%p.createSocketServer1 binding to name:%s\n", this, name );
@@ -474,6 +815,9 @@ void uSocketServer::createSocketServer2( unsigned short port, int type, int prot
     } // if
 
     acceptorCnt = 0;
+    listeners = NULL;
+    nlisteners = 1;
+    nextListener = 0;
 
 #ifdef __U_DEBUG_H__
     uDebugPrt( "(uSocketServer &)%p.createSocketServer2 binding to port:%d, ip:0x%08x\n", this, port, ((inetAddr *)saddr)->sin_addr.s_addr );
@@ -492,6 +836,77 @@ void uSocketServer::createSocketServer3( unsigned short *port, int type, int pro
 } // uSocketServer::createSocketServer3
 
 
+void uSocketServer::reusePort( int type, int protocol, int backlog ) {
+    // Must be set before the bind so subsequent listeners can bind to the same address.
+#ifdef SO_REUSEPORT
+    const int enable = 1;				// 1 => enable option
+    if ( setsockopt( socket.access.fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable) ) == -1 ) {
+	openFailure( errno, "", ntohs( ((inetAddr *)saddr)->sin_port ), ((inetAddr *)saddr)->sin_addr, AF_INET, type, protocol, backlog, "unable to set socket-option SO_REUSEPORT" );
+    } // if
+#endif // SO_REUSEPORT
+} // uSocketServer::reusePort
+
+
+void uSocketServer::createListeners( unsigned int n, int type, int protocol, int backlog ) {
+#ifdef SO_REUSEPORT
+    if ( n == 0 ) n = uThisCluster().getProcessors();	// default => one listener per processor
+  if ( n <= 1 || type == SOCK_DGRAM ) return;		// datagram sockets have no accept to distribute
+
+    const int enable = 1;				// 1 => enable option
+    const char *msg = NULL;
+    int retcode;
+
+    listeners = new uSocket *[n - 1];
+    for ( unsigned int i = 0; i < n - 1; i += 1 ) {
+	listeners[i] = new uSocket( AF_INET, type, protocol ); // already SO_REUSEADDR and non-blocking
+	nlisteners += 1;
+	int fd = listeners[i]->access.fd;
+
+	if ( setsockopt( fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable) ) == -1 ) {
+	    msg = "unable to set socket-option SO_REUSEPORT";
+	    break;
+	} // if
+	for ( ;; ) {
+	    retcode = ::bind( fd, saddr, saddrlen );	// saddr holds the port selected by the first bind
+	  if ( retcode != -1 || errno != EINTR ) break;	// timer interrupt ?
+	} // for
+	if ( retcode == -1 ) {
+	    msg = "unable to bind name to socket";
+	    break;
+	} // if
+	for ( ;; ) {
+	    retcode = ::listen( fd, backlog );
+	  if ( retcode != -1 || errno != EINTR ) break;	// timer interrupt ?
+	} // for
+	if ( retcode == -1 ) {
+	    msg = "unable to listen on socket";
+	    break;
+	} // if
+    } // for
+
+    if ( msg != NULL ) {
+	int terrno = errno;				// deleting listeners may change errno
+	deleteListeners();
+	openFailure( terrno, "", ntohs( ((inetAddr *)saddr)->sin_port ), ((inetAddr *)saddr)->sin_addr, AF_INET, type, protocol, backlog, msg );
+    } // if
+
+#ifdef __U_DEBUG_H__
+    uDebugPrt( "(uSocketServer &)%p.createListeners %d listeners on port:%d\n", this, nlisteners, ntohs( ((inetAddr *)saddr)->sin_port ) );
+#endif // __U_DEBUG_H__
+#endif // SO_REUSEPORT
+} // uSocketServer::createListeners
+
+
+void uSocketServer::deleteListeners() {
+    for ( unsigned int i = 0; i < nlisteners - 1; i += 1 ) {
+	delete listeners[i];
+    } // for
+    delete [] listeners;
+    listeners = NULL;
+    nlisteners = 1;
+} // uSocketServer::deleteListeners
+
+
 void uSocketServer::readFailure( int errno_, const char *buf, const int len, const uDuration *timeout, const char *const op ) {
     char msg[32];
     strcpy( msg, "socket " ); strcat( msg, op ); strcat( msg, " fails" );
@@ -577,12 +992,20 @@ void uSocketAccept::createSocketAcceptor( uDuration *timeout, struct sockaddr *a
 	    uFetchAdd( UPP::Statistics::accept_syscalls, 1 );
 #endif // __U_STATISTICS__
 	    if ( len != NULL ) tmp = *len;		// save *len, as it may be set to 0 after each attempt
+#ifdef __U_ACCEPT4__
+	    fd = ::accept4( access.fd, adr, len, SOCK_NONBLOCK );
+#else
 	    fd = ::accept( access.fd, adr, len );
+#endif // __U_ACCEPT4__
 	    if ( len != NULL && *len == 0 ) *len = tmp;	// reset *len after each attempt
+#ifdef __U_STATISTICS__
+	    if ( fd == -1 && errno == U_EWOULDBLOCK ) uFetchAdd( UPP::Statistics::accept_eagain, 1 );
+#endif // __U_STATISTICS__
 	    return fd;
 	} // action
 	Accept( uIOaccess &access, int &fd, struct sockaddr *adr, socklen_t *len ) : uIOClosure( access, fd ), adr( adr ), len( len ) {}
-    } acceptClosure( socketserver.access, access.fd, adr, len );
+    };
+    Accept acceptClosure( socketserver.socket.access, access.fd, adr, len );
 
     baddrlen = saddrlen = socketserver.saddrlen;
 
@@ -590,28 +1013,99 @@ void uSocketAccept::createSocketAcceptor( uDuration *timeout, struct sockaddr *a
     uDebugPrt( "(uSocketAccept &)%p.uSocketAccept before accept\n", this );
 #endif // __U_DEBUG_H__
 
-    acceptClosure.wrapper();
-    if ( access.fd == -1 && acceptClosure.errno_ == U_EWOULDBLOCK ) {
-	if ( ! acceptClosure.select( uCluster::ReadSelect, timeout ) ) {
+    access.fd = -1;
+    unsigned int nlisteners = socketserver.nlisteners;
+    if ( nlisteners > 1 ) {				// SO_REUSEPORT listeners
+	// The kernel spreads incoming connections across all the listeners, so an accept must take a connection from
+	// whichever listener has one; waiting on a single listener strands connections queued on the others when there
+	// are fewer acceptors than listeners. Each scan starts at a different listener to spread the acceptors. A
+	// multishot accept is per listener, so this path does not use the ring, but the accepted connection does.
+	uTime deadline;
+	if ( timeout != NULL ) deadline = uClock::now() + *timeout;
+	int errno_;
+	for ( ;; ) {
+	    unsigned int start = uFetchAdd( socketserver.nextListener, 1 );
+	    errno_ = U_EWOULDBLOCK;
+	    for ( unsigned int i = 0; i < nlisteners && access.fd == -1 && errno_ == U_EWOULDBLOCK; i += 1 ) {
+		Accept listenClosure( socketserver.listener( ( start + i ) % nlisteners ), access.fd, adr, len );
+		listenClosure.wrapper();
+		if ( access.fd == -1 ) errno_ = listenClosure.errno_;
+	    } // for
+	  if ( access.fd != -1 || errno_ != U_EWOULDBLOCK ) break; // connection or error ?
+
+	    fd_set rfds;				// wait until any listener has a connection
+	    FD_ZERO( &rfds );
+	    int maxfd = 0;
+	    for ( unsigned int i = 0; i < nlisteners; i += 1 ) {
+		int fd = socketserver.listener( i ).fd;
+		FD_SET( fd, &rfds );
+		if ( fd > maxfd ) maxfd = fd;
+	    } // for
+	    if ( timeout == NULL ) {
+		uThisCluster().select( maxfd + 1, &rfds, NULL, NULL );
+	    } else {
+		uDuration remaining = deadline - uClock::now();
+		if ( remaining <= 0 ) openTimeout( timeout, adr, len );
+		timeval t = remaining;
+		if ( uThisCluster().select( maxfd + 1, &rfds, NULL, NULL, &t ) == 0 ) openTimeout( timeout, adr, len );
+	    } // if
+	} // for
+	if ( access.fd == -1 ) {
+#ifdef __U_STATISTICS__
+	    uFetchAdd( UPP::Statistics::accept_errors, 1 );
+#endif // __U_STATISTICS__
+	    openFailure( errno_, timeout, adr, len );
+	} // if
+	if ( socketserver.ring != NULL ) ring = socketserver.ring; // accepted connection uses completion-based I/O
+    } else if ( socketserver.ring != NULL ) {		// completion-based path
+	int fd = socketserver.ring->accept( socketserver.socket.access.fd, adr, len, timeout );
+	if ( fd >= 0 ) {
+	    access.fd = fd;
+	    ring = socketserver.ring;			// accepted connection also uses completion-based I/O
+	} else if ( fd == -ETIME ) {
 	    openTimeout( timeout, adr, len );
+	} else if ( fd != -EAGAIN ) {
+#ifdef __U_STATISTICS__
+	    uFetchAdd( UPP::Statistics::accept_errors, 1 );
+#endif // __U_STATISTICS__
+	    openFailure( -fd, timeout, adr, len );
+#ifdef __U_STATISTICS__
+	} else {
+	    uFetchAdd( UPP::Statistics::uring_fallbacks, 1 );
+#endif // __U_STATISTICS__
 	} // if
     } // if
-    if ( access.fd == -1 ) {
+
+    if ( access.fd == -1 ) {				// non-blocking path
+	acceptClosure.wrapper();
+	if ( access.fd == -1 && acceptClosure.errno_ == U_EWOULDBLOCK ) {
+	    if ( ! acceptClosure.select( uCluster::ReadSelect, timeout ) ) {
+		openTimeout( timeout, adr, len );
+	    } // if
+	} // if
+	if ( access.fd == -1 ) {
 #ifdef __U_STATISTICS__
-	uFetchAdd( UPP::Statistics::accept_errors, 1 );
+	    uFetchAdd( UPP::Statistics::accept_errors, 1 );
 #endif // __U_STATISTICS__
-	openFailure( acceptClosure.errno_, timeout, adr, len );
+	    openFailure( acceptClosure.errno_, timeout, adr, len );
+	} // if
     } // if
 
 #ifdef __U_DEBUG_H__
     uDebugPrt( "(uSocketAccept &)%p.uSocketAccept after accept fd:%d\n", this, access.fd );
 #endif // __U_DEBUG_H__
 
+#ifdef __U_STATISTICS__
+    uFetchAdd( UPP::Statistics::accept_connections, 1 );
+#endif // __U_STATISTICS__
+
+    access.poll.setStatus( uPoll::AlwaysPoll );
+#ifndef __U_ACCEPT4__
     // On some UNIX systems the file descriptor created by accept inherits the non-blocking characteristic from the base
     // socket; on other system this does not seem to occur, so explicitly set the file descriptor to non-blocking.
 
-    access.poll.setStatus( uPoll::AlwaysPoll );
     access.poll.setPollFlag( access.fd );
+#endif // ! __U_ACCEPT4__
     openAccept = true;
 } // uSocketAccept::createSocketAcceptor
 
@@ -30,6 +30,7 @@
 
 
 #include <uFile.h>
+#include <uIOuring.h>
 //#include <uDebug.h>
 
 
@@ -139,6 +140,15 @@ class uSocketIO : public uFileIO {
     struct sockaddr *saddr;				// default send/receive address
     socklen_t saddrlen;					// size of send address
     socklen_t baddrlen;					// size of address buffer (UNIX/INET)
+    uIOuring *ring;					// completion-based I/O, NULL => non-blocking path
+#if defined( __linux__ ) && defined( MSG_ZEROCOPY )
+    bool zcEnabled;					// SO_ZEROCOPY set on socket
+    int zcEpoll;					// epoll instance reporting error-queue notifications, -1 => none
+    uSpinLock zcLock;					// protect counters and the kernel's send numbering
+    unsigned int zcSent, zcDone, zcCopied;		// zero-copy sends issued/completed/completed by copying
+
+    void zcreap();
+#endif // __linux__ && MSG_ZEROCOPY
 
     virtual void readFailure( int errno_, const char *buf, const int len, const int flags, const struct sockaddr *from, const socklen_t *fromlen, const uDuration *timeout, const char *const op ) = 0;
     virtual void readTimeout( const char *buf, const int len, const int flags, const struct sockaddr *from, const socklen_t *fromlen, const uDuration *timeout, const char *const op ) = 0;
@@ -147,8 +157,15 @@ class uSocketIO : public uFileIO {
     virtual void sendfileFailure( int errno_, const int in_fd, const off_t *off, const size_t len, const uDuration *timeout ) = 0;
     virtual void sendfileTimeout( const int in_fd, const off_t *off, const size_t len, const uDuration *timeout ) = 0;
 
-    uSocketIO( uIOaccess &acc, struct sockaddr *saddr ) : uFileIO( acc ), saddr( saddr ) {
+    uSocketIO( uIOaccess &acc, struct sockaddr *saddr ) : uFileIO( acc ), saddr( saddr ), ring( NULL ) {
+#if defined( __linux__ ) && defined( MSG_ZEROCOPY )
+	zcEnabled = false;
+	zcEpoll = -1;
+	zcSent = zcDone = zcCopied = 0;
+#endif // __linux__ && MSG_ZEROCOPY
     } // uSocketIO::uSocketIO
+
+    virtual ~uSocketIO();
   public:
     _Mutex const struct sockaddr *getsockaddr() {	// must cast result to sockaddr_in or sockaddr_un
 	return saddr;
@@ -180,7 +197,50 @@ class uSocketIO : public uFileIO {
 
     int recvmsg( struct msghdr *msg, int flags = 0, uDuration *timeout = NULL );
 
+    // Buffer chains: send gathers the chain's segments (no copying) and sends all of it, consuming the chain; recv
+    // appends up to len bytes to the chain using pooled blocks.
+    int send( uIOBuf &chain, int flags = 0, uDuration *timeout = NULL );
+    int recv( uIOBuf &chain, size_t len, int flags = 0, uDuration *timeout = NULL );
+
+#if defined( __linux__ )
+    // Batched datagram I/O: transfer up to vlen messages in one system call, setting msg_len in each transferred
+    // element.  The call blocks (or times out) only until at least one message can be transferred, and returns the number
+    // of messages transferred.
+    int sendmmsg( struct mmsghdr *msgvec, unsigned int vlen, int flags = 0, uDuration *timeout = NULL );
+    int recvmmsg( struct mmsghdr *msgvec, unsigned int vlen, int flags = 0, uDuration *timeout = NULL );
+#endif // __linux__
+
     ssize_t sendfile( uFile::FileAccess &file, off_t *off, size_t len, uDuration *timeout = NULL );
+
+    // Perform send, recv, and (for a server) accept through io_uring. Connections accepted by a server inherit its ring.
+    // Returns false, leaving the socket on the non-blocking path, when the kernel does not support io_uring.
+    bool uring( uIOuring &r );
+
+#if defined( __linux__ )
+    // Move socket data to/from a pipe inside the kernel; data forwarded between sockets through a pipe is never copied
+    // to user space.
+    int spliceTo( uPipe::End &out, size_t len, unsigned int flags = 0, uDuration *timeout = NULL );   // socket => pipe
+    int spliceFrom( uPipe::End &in, size_t len, unsigned int flags = 0, uDuration *timeout = NULL );  // pipe => socket
+#endif // __linux__
+
+#if defined( __linux__ ) && defined( MSG_ZEROCOPY )
+    // Zero-copy send: the kernel transmits directly from buf, which must not be changed until the send completes.
+    // sendzc returns the id of the send in *id and zcwait blocks the calling task until that send completes. Ids follow
+    // the kernel's numbering of the socket's zero-copy sends, so any number of tasks may send. Zero-copy sends bypass
+    // io_uring. Without a prior successful zerocopy(), or for an empty buffer, sendzc is an ordinary (copying) send
+    // whose id is already complete.
+    bool zerocopy();					// enable zero-copy sends, false => not supported
+    int sendzc( const char *buf, int len, unsigned int *id = NULL, int flags = 0, uDuration *timeout = NULL );
+    void zcwait( unsigned int id, uDuration *timeout = NULL );
+
+    unsigned int zcCompleted() const {			// number of zero-copy sends completed
+	return __atomic_load_n( &zcDone, __ATOMIC_RELAXED );
+    } // uSocketIO::zcCompleted
+
+    unsigned int zcCopies() const {			// number of zero-copy sends the kernel completed by copying
+	return __atomic_load_n( &zcCopied, __ATOMIC_RELAXED );
+    } // uSocketIO::zcCopies
+#endif // __linux__ && MSG_ZEROCOPY
 }; // uSocketIO
 
 
@@ -192,6 +252,13 @@ _Monitor uSocketServer : public uSocketIO {
 
     int acceptorCnt;					// number of simultaneous acceptors using server
     uSocket socket;					// one-to-one correspondance between server and socket
+    uSocket **listeners;				// additional SO_REUSEPORT listeners, NULL => socket only
+    unsigned int nlisteners;				// number of listeners, including socket
+    unsigned int nextListener;				// round-robin start of the listener scan among acceptors
+
+    uIOaccess &listener( unsigned int i ) {		// i-th listening descriptor, 0 => socket
+	return i == 0 ? socket.access : listeners[i - 1]->access;
+    } // uSocketServer::listener
 
     void acceptor() {
 	uFetchAdd( acceptorCnt, 1 );
@@ -204,6 +271,9 @@ _Monitor uSocketServer : public uSocketIO {
     void createSocketServer1( const char *name, int type, int protocol, int backlog );
     void createSocketServer2( unsigned short port, int type, int protocol, int backlog );
     void createSocketServer3( unsigned short *port, int type, int protocol, int backlog );
+    void reusePort( int type, int protocol, int backlog );
+    void createListeners( unsigned int n, int type, int protocol, int backlog );
+    void deleteListeners();
   protected:
     void readFailure( int errno_, const char *buf, const int len, const uDuration *timeout, const char *const op ) __attribute__ ((noreturn));
     void readTimeout( const char *buf, const int len, const uDuration *timeout, const char *const op ) __attribute__ ((noreturn));
@@ -307,6 +377,14 @@ _Monitor uSocketServer : public uSocketIO {
 	virtual void defaultTerminate() const;
     }; // uSocketServer::SendfileTimeout
 
+    // Multi-listener mode: open several listening sockets bound to the same address with SO_REUSEPORT, so the kernel
+    // distributes incoming connections among them and acceptors do not contend on one socket.
+
+    struct ReusePort {
+	unsigned int listeners;				// 0 => one per processor on the cluster
+	explicit ReusePort( unsigned int listeners = 0 ) : listeners( listeners ) {}
+    }; // uSocketServer::ReusePort
+
 
     // AF_UNIX
     uSocketServer( const char *name, int type = SOCK_STREAM, int protocol = 0, int backlog = 10 ) :
@@ -335,13 +413,44 @@ _Monitor uSocketServer : public uSocketIO {
 	createSocketServer3( port, type, protocol, backlog );
     } // uSocketServer::uSocketServer
 
+    // AF_INET, multi-listener
+    uSocketServer( unsigned short port, ReusePort reuse, int type = SOCK_STREAM, int protocol = 0, int backlog = 10 ) :
+	    uSocketIO( socket.access, (sockaddr *)new inetAddr( port, uSocket::itoip( INADDR_ANY ) ) ), socket( AF_INET, type, protocol ) {
+	reusePort( type, protocol, backlog );
+	createSocketServer2( port, type, protocol, backlog );
+	createListeners( reuse.listeners, type, protocol, backlog );
+    } // uSocketServer::uSocketServer
+
+    uSocketServer( unsigned short port, in_addr ip, ReusePort reuse, int type = SOCK_STREAM, int protocol = 0, int backlog = 10 ) :
+	    uSocketIO( socket.access, (sockaddr *)new inetAddr( port, ip ) ), socket( AF_INET, type, protocol ) {
+	reusePort( type, protocol, backlog );
+	createSocketServer2( port, type, protocol, backlog );
+	createListeners( reuse.listeners, type, protocol, backlog );
+    } // uSocketServer::uSocketServer
+
+    uSocketServer( unsigned short *port, ReusePort reuse, int type = SOCK_STREAM, int protocol = 0, int backlog = 10 ) :
+	    uSocketIO( socket.access, (sockaddr *)new inetAddr( 0, uSocket::itoip( INADDR_ANY ) ) ), socket( AF_INET, type, protocol ) {
+	reusePort( type, protocol, backlog );
+	createSocketServer3( port, type, protocol, backlog );
+	createListeners( reuse.listeners, type, protocol, backlog );
+    } // uSocketServer::uSocketServer
+
     virtual ~uSocketServer() {
 	if ( acceptorCnt != 0 ) {
 	    if ( ! std::uncaught_exception() ) _Throw CloseFailure( *this, EINVAL, acceptorCnt, "closing socket server with outstanding acceptor(s)" );
 	} // if
+	if ( ring != NULL ) {				// cancel multishot accepts holding the listeners
+	    ring->close( socket.access.fd );
+	    for ( unsigned int i = 0; i < nlisteners - 1; i += 1 ) ring->close( listeners[i]->access.fd );
+	} // if
+	if ( listeners != NULL ) deleteListeners();
 	delete saddr;
     } // uSocketServer::~uSocketServer
 
+    unsigned int getListeners() const {
+	return nlisteners;
+    } // uSocketServer::getListeners
+
     void setClient( struct sockaddr *addr, socklen_t len ) {
 #ifdef __U_DEBUG__
 	if ( len > baddrlen ) {
@@ -0,0 +1,199 @@
+//                              -*- Mode: C++ -*-
+//
+// uC++ Version 6.1.0, Copyright (C) Peter A. Buhr 2026
+//
+// u++-trace.cc -- convert a uTracer event trace to the Chrome trace-event format (JSON)
+//
+// Author           : agent
+// Created On       : Mon Oct 19 01:52:47 2026
+// Last Modified By : agent
+// Last Modified On : Mon Oct 19 01:52:47 2026
+// Update Count     : 1
+//
+// This  library is free  software; you  can redistribute  it and/or  modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software  Foundation; either  version 2.1 of  the License, or  (at your
+// option) any later version.
+//
+// This library is distributed in the  hope that it will be useful, but WITHOUT
+// ANY  WARRANTY;  without even  the  implied  warranty  of MERCHANTABILITY  or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+// for more details.
+//
+// You should  have received a  copy of the  GNU Lesser General  Public License
+// along  with this library.
+//
+
+// Each processor becomes a thread in the timeline: the tasks it runs and its idle pauses are slices, tasks blocking and
+// being woken are instant events. Monitor entry to exit and waits for I/O are asynchronous slices of the task, as a task
+// may block and move to another processor part way through. Load the output in chrome://tracing or ui.perfetto.dev.
+//
+//   u++-trace trace-file [ json-file ]
+
+
+#include <cstdio>					// fopen, fread, fprintf
+#include <cstring>					// strcmp
+
+// Must match uTracer.h.
+
+enum Event { Run, Stop, Block, Wake, MonitorEnter, MonitorExit, IOWaitBegin, IOWaitEnd, IdleBegin, IdleEnd };
+
+struct Header {
+    char magic[8];
+    unsigned int version;
+    unsigned int rings;
+    unsigned long long int startTicks, startNsecs;
+    unsigned long long int stopTicks, stopNsecs;
+}; // Header
+
+struct RingHeader {
+    unsigned int id;
+    unsigned int count;
+    char name[56];
+}; // RingHeader
+
+struct Record {
+    unsigned long long int time;
+    unsigned long long int task;
+    unsigned long long int object;
+    unsigned int event;
+    unsigned int arg;
+    char name[32];
+}; // Record
+
+
+static FILE *out;
+static bool first = true;				// no comma before first event
+
+static void string( const char *s, unsigned int size ) { // JSON string, quoted
+    fputc( '"', out );
+    for ( unsigned int i = 0; i < size && s[i] != '\0'; i += 1 ) {
+	unsigned char c = s[i];
+	if ( c == '"' || c == '\\' ) {
+	    fprintf( out, "\\%c", c );
+	} else if ( c < ' ' ) {
+	    fprintf( out, "\\u%04x", c );
+	} else {
+	    fputc( c, out );
+	} // if
+    } // for
+    fputc( '"', out );
+} // string
+
+// Start an event; the caller adds the remaining fields and closes the object.
+
+static void event( const char *ph, unsigned int tid, double ts, const char *name, unsigned int size = 32 ) {
+    fprintf( out, "%s\n{\"ph\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"name\":", first ? "" : ",", ph, tid, ts );
+    first = false;
+    string( name, size );
+} // event
+
+
+int main( int argc, char *argv[] ) {
+    if ( argc < 2 || argc > 3 ) {
+	fprintf( stderr, "Usage: %s trace-file [ json-file ]\n", argv[0] );
+	return 1;
+    } // if
+    FILE *in = fopen( argv[1], "rb" );
+    if ( in == NULL ) {
+	perror( argv[1] );
+	return 1;
+    } // if
+    Header header;
+    if ( fread( &header, sizeof(header), 1, in ) != 1 || strcmp( header.magic, "uTRACE1" ) != 0 || header.version != 1 ) {
+	fprintf( stderr, "%s: %s is not a uC++ event trace\n", argv[0], argv[1] );
+	return 1;
+    } // if
+    out = argc == 3 ? fopen( argv[2], "w" ) : stdout;
+    if ( out == NULL ) {
+	perror( argv[2] );
+	return 1;
+    } // if
+
+    // time stamps to microseconds from the start of tracing
+    unsigned long long int ticks = header.stopTicks - header.startTicks;
+    double usecs = ticks == 0 ? 0.001 : (double)( header.stopNsecs - header.startNsecs ) / ticks / 1000.0;
+
+    fprintf( out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" );
+    event( "M", 0, 0.0, "process_name" );
+    fprintf( out, ",\"args\":{\"name\":\"uC++\"}}" );
+
+    RingHeader ring;
+    while ( fread( &ring, sizeof(ring), 1, in ) == 1 ) { // rings written after the header count are included
+	event( "M", ring.id, 0.0, "thread_name" );
+	fprintf( out, ",\"args\":{\"name\":" );
+	string( ring.name, sizeof(ring.name) );
+	fprintf( out, "}}" );
+
+	bool running = false, idle = false;		// open slices, events before the oldest record are lost
+	Record r;
+	for ( unsigned int i = 0; i < ring.count && fread( &r, sizeof(r), 1, in ) == 1; i += 1 ) {
+	    double ts = (long long int)( r.time - header.startTicks ) * usecs;
+	    switch ( r.event ) {
+	      case Run:
+		if ( running ) {
+		    event( "E", ring.id, ts, "" );
+		    fprintf( out, "}" );
+		} // if
+		event( "B", ring.id, ts, r.name[0] == '\0' ? "task" : r.name );
+		fprintf( out, ",\"args\":{\"task\":\"0x%llx\"}}", r.task );
+		running = true;
+		break;
+	      case Stop:
+		if ( running ) {
+		    event( "E", ring.id, ts, "" );
+		    fprintf( out, "}" );
+		} // if
+		running = false;
+		break;
+	      case Block:
+		event( "i", ring.id, ts, "block" );
+		fprintf( out, ",\"s\":\"t\",\"args\":{\"task\":\"0x%llx\"}}", r.task );
+		break;
+	      case Wake:
+		event( "i", ring.id, ts, r.name[0] == '\0' ? "wake" : r.name );
+		fprintf( out, ",\"s\":\"t\",\"cat\":\"wake\",\"args\":{\"task\":\"0x%llx\"}}", r.task );
+		break;
+	      case MonitorEnter:
+	      case MonitorExit:
+		event( r.event == MonitorEnter ? "b" : "e", ring.id, ts, r.name[0] == '\0' ? "mutex" : r.name );
+		fprintf( out, ",\"cat\":\"monitor\",\"id\":\"0x%llx\",\"args\":{\"object\":\"0x%llx\"}}", r.task, r.object );
+		break;
+	      case IOWaitBegin:
+		event( "b", ring.id, ts, "I/O wait" );
+		fprintf( out, ",\"cat\":\"io\",\"id\":\"0x%llx\",\"args\":{\"fd\":%u}}", r.task, r.arg );
+		break;
+	      case IOWaitEnd:
+		event( "e", ring.id, ts, "I/O wait" );
+		fprintf( out, ",\"cat\":\"io\",\"id\":\"0x%llx\"}", r.task );
+		break;
+	      case IdleBegin:
+		event( "B", ring.id, ts, "idle" );
+		fprintf( out, "}" );
+		idle = true;
+		break;
+	      case IdleEnd:
+		if ( idle ) {
+		    event( "E", ring.id, ts, "" );
+		    fprintf( out, "}" );
+		} // if
+		idle = false;
+		break;
+	      default:					// torn record
+		break;
+	    } // switch
+	} // for
+    } // while
+
+    fprintf( out, "\n]}\n" );
+    fclose( in );
+    if ( fclose( out ) == EOF ) {
+	perror( argc == 3 ? argv[2] : "stdout" );
+	return 1;
+    } // if
+    return 0;
+} // main
+
+// Local Variables: //
+// compile-command: "make install" //
+// End: //
@@ -496,6 +496,10 @@ int main( int argc, char *argv[] ) {
 	    libs[nlibs] = "-ldl";			// calls to dlsym/dlerror
 	    nlibs += 1;
 	} // if
+	if ( tos == "linux" ) {
+	    libs[nlibs] = "-lrt";			// calls to timer_create (CPU profiler)
+	    nlibs += 1;
+	} // if
 
 	if ( profile ) {
 	    args[nargs] = ( *new string( string("-L") + mvdlibdir ) ).c_str();